@@ -0,0 +1,598 @@
+// ======================================================================
+/*!
+ * \file
+ * \brief Throughput benchmarks for Tron
+ *
+ * Usage: TronBench [options]
+ *
+ *   --sizes 100,500,1000     Synthetic grid sizes (square grids)
+ *   --fields gauss,noise,... Synthetic fields to run
+ *   --grid file W H          Replay a raw float32 grid dumped from production
+ *   --filter substring       Run only benchmarks whose name contains the string
+ *   --mintime seconds        Minimum time to repeat each benchmark (default 0.5)
+ *   --threads 1,2,4,...      Thread counts for the scaling benchmarks
+ *
+ * Raw grids are W*H native endian float32 values with i running fastest.
+ * Both NaN and 32700 are treated as missing values.
+ *
+ * The output is CSV on stdout so that results from different commits
+ * can be compared with standard tools.
+ */
+// ======================================================================
+
+#include "FlatBuilder.h"
+#include "FmiBuilder.h"
+#include "WkbBuilder.h"
+#include "Edge.h"
+#include "Traits.h"
+
+#include <geos/geom/GeometryFactory.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//! Protection against conflicts with global functions
+namespace TronBench
+{
+typedef Tron::Traits<float, double, Tron::NanMissing> MyTraits;
+typedef Tron::Edge<MyTraits> MyEdge;
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief A path adapter which only stores the edges for builder benchmarks
+ */
+// ----------------------------------------------------------------------
+
+struct EdgeCollector
+{
+  std::vector<MyEdge> edges;
+};
+
+}  // namespace TronBench
+
+namespace Tron
+{
+namespace Builder
+{
+template <typename Traits, typename Edges>
+void fill(const Edges &theEdges, TronBench::EdgeCollector &theAdapter, Stats *theStats = nullptr)
+{
+  theAdapter.edges.assign(theEdges.begin(), theEdges.end());
+}
+
+template <typename Traits, typename Edges>
+void line(const Edges &theEdges, TronBench::EdgeCollector &theAdapter, Stats *theStats = nullptr)
+{
+  theAdapter.edges.assign(theEdges.begin(), theEdges.end());
+}
+}  // namespace Builder
+}  // namespace Tron
+
+#include "Tron.h"
+#include "BoxFilter2D.h"
+#include "Rasterizer.h"
+#include "SavitzkyGolay2D.h"
+
+namespace TronBench
+{
+// ----------------------------------------------------------------------
+/*
+ * A grid with unit spacing
+ */
+// ----------------------------------------------------------------------
+
+class Grid
+{
+ public:
+  typedef float value_type;
+  typedef int size_type;
+  typedef double coord_type;
+
+  Grid(size_type theWidth, size_type theHeight)
+      : itsWidth(theWidth), itsHeight(theHeight), itsData(theWidth * theHeight, 0)
+  {
+  }
+
+  size_type width() const { return itsWidth; }
+  size_type height() const { return itsHeight; }
+  const value_type &operator()(size_type i, size_type j) const { return itsData[i + itsWidth * j]; }
+  value_type &operator()(size_type i, size_type j) { return itsData[i + itsWidth * j]; }
+  coord_type x(size_type i, size_type j) const { return i; }
+  coord_type y(size_type i, size_type j) const { return j; }
+  bool valid(size_type i, size_type j) const { return true; }
+
+  value_type minimum() const;
+  value_type maximum() const;
+
+ private:
+  size_type itsWidth;
+  size_type itsHeight;
+  std::vector<value_type> itsData;
+};
+
+Grid::value_type Grid::minimum() const
+{
+  value_type ret = std::numeric_limits<value_type>::max();
+  for (auto value : itsData)
+    if (!std::isnan(value))
+      ret = std::min(ret, value);
+  return ret;
+}
+
+Grid::value_type Grid::maximum() const
+{
+  value_type ret = std::numeric_limits<value_type>::lowest();
+  for (auto value : itsData)
+    if (!std::isnan(value))
+      ret = std::max(ret, value);
+  return ret;
+}
+
+// ----------------------------------------------------------------------
+/*
+ * Synthetic fields. All values are positive so that logarithmic
+ * interpolation can be used too.
+ */
+// ----------------------------------------------------------------------
+
+Grid make_field(const std::string &theName, int theWidth, int theHeight)
+{
+  Grid grid(theWidth, theHeight);
+  unsigned int seed = 123456;
+
+  for (int j = 0; j < theHeight; j++)
+    for (int i = 0; i < theWidth; i++)
+    {
+      const double x = 1.0 * i / theWidth;
+      const double y = 1.0 * j / theHeight;
+      double value = 0;
+
+      if (theName == "gauss" || theName == "missing")
+      {
+        // A few smooth gaussian hills
+        value = 0.1 + 0.6 * std::exp(-((x - 0.3) * (x - 0.3) + (y - 0.4) * (y - 0.4)) / 0.05) +
+                0.3 * std::exp(-((x - 0.7) * (x - 0.7) + (y - 0.6) * (y - 0.6)) / 0.02);
+        if (theName == "missing" && std::sin(17 * x) * std::cos(13 * y) > 0.4)
+          value = NAN;
+      }
+      else if (theName == "noise")
+        value = 0.01 + 1.0 * rand_r(&seed) / RAND_MAX;
+      else if (theName == "saddle")
+        value = 0.5 + 0.49 * std::sin(0.7 * i) * std::sin(0.7 * j);
+      else
+        throw std::runtime_error("Unknown synthetic field '" + theName + "'");
+
+      grid(i, j) = value;
+    }
+  return grid;
+}
+
+// ----------------------------------------------------------------------
+/*
+ * Read a raw float32 grid
+ */
+// ----------------------------------------------------------------------
+
+Grid read_field(const std::string &theFile, int theWidth, int theHeight)
+{
+  std::ifstream in(theFile, std::ios::in | std::ios::binary);
+  if (!in)
+    throw std::runtime_error("Failed to open '" + theFile + "' for reading");
+
+  Grid grid(theWidth, theHeight);
+  std::vector<float> row(theWidth);
+  for (int j = 0; j < theHeight; j++)
+  {
+    if (!in.read(reinterpret_cast<char *>(row.data()), theWidth * sizeof(float)))
+      throw std::runtime_error("File '" + theFile + "' is too short for the given grid size");
+    for (int i = 0; i < theWidth; i++)
+      grid(i, j) = (row[i] == 32700 ? NAN : row[i]);
+  }
+  return grid;
+}
+
+// ----------------------------------------------------------------------
+/*
+ * Benchmark driver
+ */
+// ----------------------------------------------------------------------
+
+struct Options
+{
+  std::vector<int> sizes = {100, 500, 1000};
+  std::vector<std::string> fields = {"gauss", "noise", "saddle", "missing"};
+  std::string gridfile;
+  int gridwidth = 0;
+  int gridheight = 0;
+  std::string filter;
+  double mintime = 0.5;
+  std::vector<unsigned int> threads = {1, 2, 4, 8, 16, 32, 64};
+};
+
+Options options;
+
+// Prevent the optimizer from discarding results
+volatile std::size_t sink = 0;
+
+template <typename Function>
+void run(const std::string &theName, const std::string &theField, const Grid &theGrid, Function f)
+{
+  if (!options.filter.empty() && theName.find(options.filter) == std::string::npos)
+    return;
+
+  using clock = std::chrono::steady_clock;
+
+  f();  // warm up caches and allocators
+
+  std::size_t iterations = 0;
+  const auto start = clock::now();
+  double elapsed = 0;
+  do
+  {
+    f();
+    ++iterations;
+    elapsed = std::chrono::duration<double>(clock::now() - start).count();
+  } while (elapsed < options.mintime);
+
+  std::cout << theName << ',' << theField << ',' << theGrid.width() << ',' << theGrid.height()
+            << ',' << iterations << ',' << static_cast<long>(1e9 * elapsed / iterations) << '\n';
+}
+
+// Ten equally spaced bands covering the data
+std::vector<float> make_limits(const Grid &theGrid)
+{
+  const float lo = theGrid.minimum();
+  const float hi = theGrid.maximum();
+  std::vector<float> limits;
+  for (int i = 0; i <= 10; i++)
+    limits.push_back(lo + (hi - lo) * i / 10);
+  return limits;
+}
+
+template <template <typename> class Interpolation>
+void bench_fill(const std::string &theName, const std::string &theField, const Grid &theGrid)
+{
+  typedef Tron::Contourer<Grid, Tron::FmiBuilder, MyTraits, Interpolation> MyContourer;
+  const auto limits = make_limits(theGrid);
+  geos::geom::GeometryFactory::Ptr factory = geos::geom::GeometryFactory::create();
+
+  run(theName,
+      theField,
+      theGrid,
+      [&]()
+      {
+        for (std::size_t i = 0; i + 1 < limits.size(); i++)
+        {
+          Tron::FmiBuilder builder(*factory);
+          MyContourer::fill(builder, theGrid, limits[i], limits[i + 1]);
+          sink += builder.result()->getNumGeometries();
+        }
+      });
+}
+
+template <template <typename> class Interpolation>
+void bench_line(const std::string &theName, const std::string &theField, const Grid &theGrid)
+{
+  typedef Tron::Contourer<Grid, Tron::FmiBuilder, MyTraits, Interpolation> MyContourer;
+  const auto limits = make_limits(theGrid);
+  geos::geom::GeometryFactory::Ptr factory = geos::geom::GeometryFactory::create();
+
+  run(theName,
+      theField,
+      theGrid,
+      [&]()
+      {
+        for (std::size_t i = 1; i + 1 < limits.size(); i++)
+        {
+          Tron::FmiBuilder builder(*factory);
+          MyContourer::line(builder, theGrid, limits[i]);
+          sink += builder.result()->getNumGeometries();
+        }
+      });
+}
+
+void bench_hints(const std::string &theField, const Grid &theGrid)
+{
+  typedef Tron::Hints<Grid, MyTraits> MyHints;
+  typedef Tron::CoordinateHints<Grid, MyTraits> MyCoordinateHints;
+
+  run("hints-build", theField, theGrid, [&]() { sink += MyHints(theGrid).get_rectangles(0).size(); });
+
+  const auto limits = make_limits(theGrid);
+  MyHints hints(theGrid);
+  run("hints-query",
+      theField,
+      theGrid,
+      [&]()
+      {
+        for (std::size_t i = 0; i + 1 < limits.size(); i++)
+          sink += hints.get_rectangles(limits[i], limits[i + 1]).size();
+      });
+
+  run("coordinatehints-build",
+      theField,
+      theGrid,
+      [&]() { sink += MyCoordinateHints(theGrid).get_rectangles(0, 0, 1, 1).size(); });
+
+  MyCoordinateHints chints(theGrid);
+  const double w = theGrid.width();
+  const double h = theGrid.height();
+  run("coordinatehints-query",
+      theField,
+      theGrid,
+      [&]()
+      {
+        // A zoomed in tile and the full grid
+        sink += chints.get_rectangles(0.4 * w, 0.4 * h, 0.5 * w, 0.5 * h).size();
+        sink += chints.get_rectangles(0, 0, w, h).size();
+      });
+}
+
+void bench_flipset(const std::string &theField, const Grid &theGrid)
+{
+  // Collect the edges of a typical band, then measure flipping them
+  // into a new set twice (cancellation) and once (insertion).
+
+  typedef Tron::Contourer<Grid, EdgeCollector, MyTraits, Tron::LinearInterpolation> MyContourer;
+  const auto limits = make_limits(theGrid);
+  EdgeCollector collector;
+  MyContourer::fill(collector, theGrid, limits[3], limits[6]);
+  const auto &edges = collector.edges;
+
+  run("flipset",
+      theField,
+      theGrid,
+      [&]()
+      {
+        Tron::FlipSet<MyEdge> flipset;
+        for (const auto &edge : edges)
+        {
+          flipset.flip(edge);
+          flipset.flip(MyEdge(edge.x2(), edge.y2(), edge.x1(), edge.y1()));
+          flipset.flip(edge);
+        }
+        flipset.prepare();
+        sink += flipset.size();
+      });
+
+  geos::geom::GeometryFactory::Ptr factory = geos::geom::GeometryFactory::create();
+  run("fmibuilder-build",
+      theField,
+      theGrid,
+      [&]()
+      {
+        Tron::FmiBuilder builder(*factory);
+        builder.build<MyTraits>(edges, true);
+        sink += builder.result()->getNumGeometries();
+      });
+
+  run("wkbbuilder-build",
+      theField,
+      theGrid,
+      [&]()
+      {
+        Tron::WkbBuilder builder(Tron::WkbBuilder::Format::WKB);
+        builder.build<MyTraits>(edges, true);
+        sink += builder.result().size();
+      });
+
+  run("twkbbuilder-build",
+      theField,
+      theGrid,
+      [&]()
+      {
+        Tron::WkbBuilder builder(Tron::WkbBuilder::Format::TWKB, 3);
+        builder.build<MyTraits>(edges, true);
+        sink += builder.result().size();
+      });
+
+  run("flatbuilder-build",
+      theField,
+      theGrid,
+      [&]()
+      {
+        Tron::FlatBuilder builder;
+        builder.build<MyTraits>(edges, true);
+        sink += builder.coords().size();
+      });
+}
+
+void bench_rasterize(const std::string &theField, const Grid &theGrid)
+{
+  typedef Tron::Rasterizer<Grid, MyTraits> MyRasterizer;
+  const auto limits = make_limits(theGrid);
+
+  // A 1000x1000 image covering the grid
+  const std::size_t size = 1000;
+  Tron::AffineTransform transform(
+      0, (theGrid.width() - 1.0) / size, 0, 0, 0, (theGrid.height() - 1.0) / size);
+
+  for (unsigned int threads : {1U, 0U})
+  {
+    run(threads == 1 ? "rasterize-1" : "rasterize-all",
+        theField,
+        theGrid,
+        [&]()
+        {
+          auto image = MyRasterizer::fill(theGrid, limits, size, size, transform, threads);
+          sink += image[size * size / 2];
+        });
+  }
+}
+
+void bench_smooth(const std::string &theField, const Grid &theGrid)
+{
+  for (int length : {1, 3, 6})
+  {
+    run("savitzkygolay-" + std::to_string(length),
+        theField,
+        theGrid,
+        [&]()
+        {
+          Grid grid = theGrid;
+          Tron::SavitzkyGolay2D::smooth(grid, length, 2);
+          sink += grid(0, 0);
+        });
+  }
+
+  run("savitzkygolay-6-rolling",
+      theField,
+      theGrid,
+      [&]()
+      {
+        Grid grid = theGrid;
+        Tron::SavitzkyGolay2D::smooth_rolling(grid, 6, 2);
+        sink += grid(0, 0);
+      });
+
+  run("savitzkygolay-6-normalized",
+      theField,
+      theGrid,
+      [&]()
+      {
+        Grid grid = theGrid;
+        Tron::SavitzkyGolay2D::smooth_normalized(grid, 6, 2);
+        sink += grid(0, 0);
+      });
+
+  // Wide smoothing, the cost should not depend on the radius
+  for (int radius : {5, 50})
+  {
+    run("box-" + std::to_string(radius),
+        theField,
+        theGrid,
+        [&]()
+        {
+          Grid grid = theGrid;
+          Tron::BoxFilter2D::box(grid, radius);
+          sink += grid(0, 0);
+        });
+  }
+
+  run("gaussian-20",
+      theField,
+      theGrid,
+      [&]()
+      {
+        Grid grid = theGrid;
+        Tron::BoxFilter2D::gaussian(grid, 20);
+        sink += grid(0, 0);
+      });
+
+  // Scaling with the number of threads
+  for (unsigned int threads : options.threads)
+  {
+    run("savitzkygolay-6-t" + std::to_string(threads),
+        theField,
+        theGrid,
+        [&]()
+        {
+          Grid grid = theGrid;
+          Tron::SavitzkyGolay2D::smooth(grid, 6, 2, threads);
+          sink += grid(0, 0);
+        });
+  }
+}
+
+void bench(const std::string &theField, const Grid &theGrid)
+{
+  bench_fill<Tron::LinearInterpolation>("fill-linear", theField, theGrid);
+  bench_fill<Tron::LogLinearInterpolation>("fill-loglinear", theField, theGrid);
+  bench_fill<Tron::NearestNeighbourInterpolation>("fill-nearest", theField, theGrid);
+  bench_fill<Tron::DiscreteInterpolation>("fill-discrete", theField, theGrid);
+  bench_line<Tron::LinearInterpolation>("line-linear", theField, theGrid);
+  bench_line<Tron::LogLinearInterpolation>("line-loglinear", theField, theGrid);
+  bench_hints(theField, theGrid);
+  bench_flipset(theField, theGrid);
+  bench_rasterize(theField, theGrid);
+  bench_smooth(theField, theGrid);
+}
+
+// ----------------------------------------------------------------------
+
+template <typename T>
+std::vector<T> parse_list(const std::string &theList)
+{
+  std::vector<T> ret;
+  std::istringstream in(theList);
+  std::string item;
+  while (std::getline(in, item, ','))
+  {
+    std::istringstream tmp(item);
+    T value;
+    tmp >> value;
+    ret.push_back(value);
+  }
+  return ret;
+}
+
+void parse_options(int argc, char *argv[])
+{
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string arg = argv[i];
+    const bool hasvalue = (i + 1 < argc);
+
+    if (arg == "--sizes" && hasvalue)
+      options.sizes = parse_list<int>(argv[++i]);
+    else if (arg == "--fields" && hasvalue)
+      options.fields = parse_list<std::string>(argv[++i]);
+    else if (arg == "--filter" && hasvalue)
+      options.filter = argv[++i];
+    else if (arg == "--mintime" && hasvalue)
+      options.mintime = std::atof(argv[++i]);
+    else if (arg == "--threads" && hasvalue)
+      options.threads = parse_list<unsigned int>(argv[++i]);
+    else if (arg == "--grid" && i + 3 < argc)
+    {
+      options.gridfile = argv[++i];
+      options.gridwidth = std::atoi(argv[++i]);
+      options.gridheight = std::atoi(argv[++i]);
+    }
+    else
+      throw std::runtime_error("Unknown option or missing value for '" + arg + "'");
+  }
+}
+
+}  // namespace TronBench
+
+//! The main program
+int main(int argc, char *argv[])
+{
+  using namespace TronBench;
+  try
+  {
+    parse_options(argc, argv);
+
+    std::cout << "benchmark,field,width,height,iterations,ns_per_iteration\n";
+
+    if (!options.gridfile.empty())
+    {
+      Grid grid = read_field(options.gridfile, options.gridwidth, options.gridheight);
+      bench(options.gridfile, grid);
+    }
+    else
+    {
+      for (int size : options.sizes)
+        for (const auto &field : options.fields)
+          bench(field, make_field(field, size, size));
+    }
+  }
+  catch (std::exception &e)
+  {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+// ======================================================================
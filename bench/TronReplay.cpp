@@ -0,0 +1,339 @@
+// ======================================================================
+/*!
+ * \file
+ * \brief Replay a contouring job dumped with Tron::JobDump
+ *
+ * Usage: TronReplay [options] dumpfile
+ *
+ *   --repeat N               Number of times to run the job (default 1)
+ *   --interpolation name     linear, loglinear, nearest or discrete (default as dumped)
+ *
+ * Grid jobs are contoured from scratch using the value and coordinate
+ * types, the missing value policy and the interpolation recorded in the
+ * dump. Edge jobs only run the builder.
+ * The accumulated per-stage timings are printed at the end, which makes
+ * the program suitable for running under perf or valgrind, for example
+ *
+ *   perf record -g ./TronReplay --repeat 100 job.dump
+ */
+// ======================================================================
+
+#include "FmiBuilder.h"
+#include "JobDump.h"
+#include "Stats.h"
+#include "Tron.h"
+
+#include <geos/geom/GeometryFactory.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//! Protection against conflicts with global functions
+namespace TronReplay
+{
+using Tron::JobDump::Interpolation;
+using Tron::JobDump::Job;
+using Tron::JobDump::MissingPolicy;
+using Tron::JobDump::Mode;
+using Tron::JobDump::Type;
+
+struct Options
+{
+  int repeat = 1;
+  std::string interpolation;
+  std::string file;
+};
+
+std::size_t sink = 0;
+
+void usage()
+{
+  std::cerr << "Usage: TronReplay [--repeat N] [--interpolation linear|loglinear|nearest|discrete] "
+               "dumpfile\n";
+}
+
+Options parse_options(int argc, char *argv[])
+{
+  Options options;
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string arg = argv[i];
+    if (arg == "--repeat" && i + 1 < argc)
+      options.repeat = std::atoi(argv[++i]);
+    else if (arg == "--interpolation" && i + 1 < argc)
+      options.interpolation = argv[++i];
+    else if (!arg.empty() && arg[0] != '-' && options.file.empty())
+      options.file = arg;
+    else
+      throw std::runtime_error("Invalid option '" + arg + "'");
+  }
+  if (options.file.empty())
+    throw std::runtime_error("Dump file not given");
+  if (options.repeat < 1)
+    throw std::runtime_error("Repeat count must be positive");
+  return options;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Contour a grid job in fill mode
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits, template <typename> class Interpolation>
+void replay_fill(const Job &theJob,
+                 int theRepeat,
+                 const geos::geom::GeometryFactory &theFactory,
+                 Tron::Stats &theStats)
+{
+  typedef typename Traits::value_type value_type;
+  typedef Tron::JobDump::Grid<value_type, typename Traits::coord_type> Grid;
+  typedef Tron::Contourer<Grid, Tron::FmiBuilder, Traits, Interpolation> MyContourer;
+  Grid grid(theJob);
+
+  const auto lolimit = static_cast<value_type>(theJob.lolimit);
+  const auto hilimit = static_cast<value_type>(theJob.hilimit);
+
+  for (int i = 0; i < theRepeat; i++)
+  {
+    Tron::FmiBuilder builder(theFactory);
+    MyContourer::fill(builder, grid, lolimit, hilimit, &theStats);
+    sink += builder.result()->getNumGeometries();
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Contour a grid job in line mode
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits, template <typename> class Interpolation>
+void replay_line(const Job &theJob,
+                 int theRepeat,
+                 const geos::geom::GeometryFactory &theFactory,
+                 Tron::Stats &theStats)
+{
+  typedef typename Traits::value_type value_type;
+  typedef Tron::JobDump::Grid<value_type, typename Traits::coord_type> Grid;
+  typedef Tron::Contourer<Grid, Tron::FmiBuilder, Traits, Interpolation> MyContourer;
+  Grid grid(theJob);
+
+  const auto isovalue = static_cast<value_type>(theJob.lolimit);
+
+  for (int i = 0; i < theRepeat; i++)
+  {
+    Tron::FmiBuilder builder(theFactory);
+    MyContourer::line(builder, grid, isovalue, &theStats);
+    sink += builder.result()->getNumGeometries();
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Run the builder on an edge job
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+void replay_edges(const Job &theJob,
+                  int theRepeat,
+                  const geos::geom::GeometryFactory &theFactory,
+                  Tron::Stats &theStats)
+{
+  typedef Tron::Edge<Traits> MyEdge;
+  typedef typename Traits::coord_type coord_type;
+
+  std::vector<MyEdge> edges;
+  edges.reserve(theJob.edges.size() / 4);
+  for (std::size_t i = 0; i + 3 < theJob.edges.size(); i += 4)
+    edges.emplace_back(static_cast<coord_type>(theJob.edges[i]),
+                       static_cast<coord_type>(theJob.edges[i + 1]),
+                       static_cast<coord_type>(theJob.edges[i + 2]),
+                       static_cast<coord_type>(theJob.edges[i + 3]));
+
+  const bool fillmode = (theJob.mode == Mode::Fill);
+
+  for (int i = 0; i < theRepeat; i++)
+  {
+    Tron::FmiBuilder builder(theFactory);
+    builder.build<Traits>(edges, fillmode, &theStats);
+    ++theStats.calls;
+    sink += builder.result()->getNumGeometries();
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Select the interpolation of a grid job
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+void replay_grid(const Job &theJob,
+                 int theRepeat,
+                 const geos::geom::GeometryFactory &theFactory,
+                 Tron::Stats &theStats)
+{
+  const bool fillmode = (theJob.mode == Mode::Fill);
+
+  switch (theJob.format.interpolation)
+  {
+    case Interpolation::Linear:
+      if (fillmode)
+        return replay_fill<Traits, Tron::LinearInterpolation>(
+            theJob, theRepeat, theFactory, theStats);
+      return replay_line<Traits, Tron::LinearInterpolation>(
+          theJob, theRepeat, theFactory, theStats);
+    case Interpolation::LogLinear:
+      if (fillmode)
+        return replay_fill<Traits, Tron::LogLinearInterpolation>(
+            theJob, theRepeat, theFactory, theStats);
+      return replay_line<Traits, Tron::LogLinearInterpolation>(
+          theJob, theRepeat, theFactory, theStats);
+    case Interpolation::NearestNeighbour:
+      if (fillmode)
+        return replay_fill<Traits, Tron::NearestNeighbourInterpolation>(
+            theJob, theRepeat, theFactory, theStats);
+      break;
+    case Interpolation::Discrete:
+      if (fillmode)
+        return replay_fill<Traits, Tron::DiscreteInterpolation>(
+            theJob, theRepeat, theFactory, theStats);
+      break;
+  }
+  throw std::runtime_error("The interpolation is not available for isolines");
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Select the missing value policy of a grid job
+ */
+// ----------------------------------------------------------------------
+
+template <typename Value, typename Coordinate>
+void replay_missing(const Job &theJob,
+                    int theRepeat,
+                    const geos::geom::GeometryFactory &theFactory,
+                    Tron::Stats &theStats)
+{
+  switch (theJob.format.missing)
+  {
+    case MissingPolicy::NotMissing:
+      return replay_grid<Tron::Traits<Value, Coordinate, Tron::NotMissing>>(
+          theJob, theRepeat, theFactory, theStats);
+    case MissingPolicy::NanMissing:
+      return replay_grid<Tron::Traits<Value, Coordinate, Tron::NanMissing>>(
+          theJob, theRepeat, theFactory, theStats);
+    case MissingPolicy::InfMissing:
+      return replay_grid<Tron::Traits<Value, Coordinate, Tron::InfMissing>>(
+          theJob, theRepeat, theFactory, theStats);
+    case MissingPolicy::FmiMissing:
+      return replay_grid<Tron::Traits<Value, Coordinate, Tron::FmiMissing>>(
+          theJob, theRepeat, theFactory, theStats);
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Select the value and coordinate types of a job
+ */
+// ----------------------------------------------------------------------
+
+template <typename Value>
+void replay_coordinates(const Job &theJob,
+                        int theRepeat,
+                        const geos::geom::GeometryFactory &theFactory,
+                        Tron::Stats &theStats)
+{
+  const bool edges = (theJob.kind == Tron::JobDump::Kind::Edges);
+
+  if (theJob.format.coord == Type::Float)
+  {
+    if (edges)
+      return replay_edges<Tron::Traits<Value, float>>(theJob, theRepeat, theFactory, theStats);
+    return replay_missing<Value, float>(theJob, theRepeat, theFactory, theStats);
+  }
+  if (edges)
+    return replay_edges<Tron::Traits<Value, double>>(theJob, theRepeat, theFactory, theStats);
+  return replay_missing<Value, double>(theJob, theRepeat, theFactory, theStats);
+}
+
+void replay(const Job &theJob,
+            int theRepeat,
+            const geos::geom::GeometryFactory &theFactory,
+            Tron::Stats &theStats)
+{
+  if (theJob.format.value == Type::Float)
+    replay_coordinates<float>(theJob, theRepeat, theFactory, theStats);
+  else
+    replay_coordinates<double>(theJob, theRepeat, theFactory, theStats);
+}
+
+Interpolation parse_interpolation(const std::string &theName)
+{
+  if (theName == "linear")
+    return Interpolation::Linear;
+  if (theName == "loglinear")
+    return Interpolation::LogLinear;
+  if (theName == "nearest")
+    return Interpolation::NearestNeighbour;
+  if (theName == "discrete")
+    return Interpolation::Discrete;
+  throw std::runtime_error("Unknown interpolation '" + theName + "'");
+}
+
+void print_stats(const Tron::Stats &theStats, int theRepeat, double theElapsed)
+{
+  std::cout << "stage,total_ms,ms_per_run\n";
+  for (int i = 0; i < Tron::Stats::NumStages; i++)
+  {
+    const double ms = theStats.durations[i].count() / 1e6;
+    std::cout << Tron::Stats::name(static_cast<Tron::Stats::Stage>(i)) << ',' << ms << ','
+              << ms / theRepeat << '\n';
+  }
+  std::cout << "wallclock," << 1000 * theElapsed << ',' << 1000 * theElapsed / theRepeat << '\n'
+            << '\n'
+            << theStats.asText() << '\n';
+}
+
+int run(int argc, char *argv[])
+{
+  const Options options = parse_options(argc, argv);
+  Job job = Tron::JobDump::read(options.file);
+
+  if (!options.interpolation.empty())
+    job.format.interpolation = parse_interpolation(options.interpolation);
+
+  geos::geom::GeometryFactory::Ptr factory = geos::geom::GeometryFactory::create();
+  Tron::Stats stats;
+
+  const auto start = std::chrono::steady_clock::now();
+
+  replay(job, options.repeat, *factory, stats);
+
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  print_stats(stats, options.repeat, elapsed.count());
+  return 0;
+}
+
+}  // namespace TronReplay
+
+int main(int argc, char *argv[])
+{
+  try
+  {
+    return TronReplay::run(argc, argv);
+  }
+  catch (std::exception &e)
+  {
+    std::cerr << "Error: " << e.what() << std::endl;
+    TronReplay::usage();
+    return 1;
+  }
+}
@@ -0,0 +1,268 @@
+// ======================================================================
+/*!
+ * \file
+ * \brief Regression tests for Contourer::fill_clipped and line_clipped
+ */
+// ======================================================================
+
+#include "EdgeCollector.h"
+#include <regression/tframe.h>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+//! Protection against conflicts with global functions
+namespace BoxClipperTest
+{
+typedef Tron::Traits<double, double, Tron::NanMissing> MyTraits;
+typedef Tron::Edge<MyTraits> MyEdge;
+typedef TronTest::EdgeCollector<MyEdge> Collector;
+}  // namespace BoxClipperTest
+
+#include "Tron.h"
+
+using namespace std;
+
+namespace BoxClipperTest
+{
+typedef TronTest::WaveGrid<> Grid;
+typedef Tron::Contourer<Grid, Collector, MyTraits, Tron::LinearInterpolation> MyContourer;
+
+const double nan = std::numeric_limits<double>::quiet_NaN();
+
+// Shoelace formula over closed rings, the sign depends on the orientation
+double area(const Collector& theCollector)
+{
+  double sum = 0;
+  for (const auto& edge : theCollector.edges)
+    sum += edge.x1() * edge.y2() - edge.x2() * edge.y1();
+  return sum / 2;
+}
+
+// Test whether all edges are inside the box
+bool inside(const Collector& theCollector, double x1, double y1, double x2, double y2)
+{
+  for (const auto& edge : theCollector.edges)
+    if (edge.x1() < x1 || edge.x2() < x1 || edge.x1() > x2 || edge.x2() > x2 || edge.y1() < y1 ||
+        edge.y2() < y1 || edge.y1() > y2 || edge.y2() > y2)
+      return false;
+  return true;
+}
+
+// Test whether the edges form closed rings, each vertex is entered as often as left
+bool closed(const Collector& theCollector)
+{
+  map<pair<double, double>, int> degree;
+  for (const auto& edge : theCollector.edges)
+  {
+    ++degree[make_pair(edge.x1(), edge.y1())];
+    --degree[make_pair(edge.x2(), edge.y2())];
+  }
+  for (const auto& vertex : degree)
+    if (vertex.second != 0) return false;
+  return true;
+}
+
+// Boxes with sides between and on the grid lines
+struct Box
+{
+  double x1, y1, x2, y2;
+};
+
+const vector<Box> boxes{{3.3, 2.7, 17.6, 11.2}, {3, 2, 17, 11}, {3.5, 2, 17, 11.5}};
+
+string name(const Box& theBox)
+{
+  return "box " + to_string(theBox.x1) + "," + to_string(theBox.y1) + "," + to_string(theBox.x2) +
+         "," + to_string(theBox.y2);
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that a box covering the grid changes nothing
+ */
+// ----------------------------------------------------------------------
+
+void covering()
+{
+  Grid grid(20, 15);
+
+  Collector clipped, original;
+  MyContourer::fill_clipped(clipped, grid, -0.2, 0.4, -1, -1, 30, 30);
+  MyContourer::fill(original, grid, -0.2, 0.4);
+
+  if (original.edges.empty()) TEST_FAILED("No edges were produced");
+  if (!same(clipped, original)) TEST_FAILED("Fill edges differ");
+
+  clipped.edges.clear();
+  original.edges.clear();
+  MyContourer::line_clipped(clipped, grid, 0.1, -1, -1, 30, 30);
+  MyContourer::line(original, grid, 0.1);
+
+  if (original.edges.empty()) TEST_FAILED("No line edges were produced");
+  if (!same(clipped, original)) TEST_FAILED("Line edges differ");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that clipped isobands stay in the box and cover it
+ */
+// ----------------------------------------------------------------------
+
+void fill()
+{
+  Grid grid(20, 15);
+  const vector<double> limits{nan, -0.5, -0.2, 0.1, 0.4, nan};
+
+  for (const auto& box : boxes)
+  {
+    double total = 0;
+    for (size_t i = 1; i < limits.size(); i++)
+    {
+      Collector band;
+      MyContourer::fill_clipped(
+          band, grid, limits[i - 1], limits[i], box.x1, box.y1, box.x2, box.y2);
+      if (band.edges.empty()) TEST_FAILED("Band " + to_string(i) + " is empty for " + name(box));
+      if (!inside(band, box.x1, box.y1, box.x2, box.y2))
+        TEST_FAILED("Band " + to_string(i) + " has edges outside the " + name(box));
+      if (!closed(band)) TEST_FAILED("Band " + to_string(i) + " is not closed for " + name(box));
+      total += area(band);
+    }
+
+    const double expected = (box.x2 - box.x1) * (box.y2 - box.y1);
+    if (std::abs(std::abs(total) - expected) > 1e-6)
+      TEST_FAILED("Total area " + to_string(total) + " should be " + to_string(expected) +
+                  " for " + name(box));
+
+    // Everything inside the box is a single rectangle
+
+    Collector all;
+    MyContourer::fill_clipped(all, grid, nan, nan, box.x1, box.y1, box.x2, box.y2);
+    if (std::abs(std::abs(area(all)) - expected) > 1e-6)
+      TEST_FAILED("Area of the full band is " + to_string(area(all)) + " for " + name(box));
+  }
+
+  // A box on the grid lines of a small grid
+
+  Grid small(6, 6);
+  Collector square;
+  MyContourer::fill_clipped(square, small, nan, nan, 1, 1, 4, 4);
+  if (std::abs(std::abs(area(square)) - 9) > 1e-6)
+    TEST_FAILED("Area of the grid aligned square is " + to_string(area(square)));
+  if (!closed(square)) TEST_FAILED("The grid aligned square is not closed");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test clipping isolines
+ */
+// ----------------------------------------------------------------------
+
+void line()
+{
+  Grid grid(20, 15);
+
+  Collector original;
+  MyContourer::line(original, grid, 0.1);
+
+  for (const auto& box : boxes)
+  {
+    const double x1 = box.x1, y1 = box.y1, x2 = box.x2, y2 = box.y2;
+
+    Collector clipped;
+    MyContourer::line_clipped(clipped, grid, 0.1, x1, y1, x2, y2);
+
+    if (clipped.edges.empty()) TEST_FAILED("No edges were produced for " + name(box));
+    if (!inside(clipped, x1, y1, x2, y2)) TEST_FAILED("Edges outside the " + name(box));
+
+    // Compare the lengths with the original edges clipped one by one
+    double length = 0;
+    for (const auto& edge : clipped.edges)
+      length += std::hypot(edge.x2() - edge.x1(), edge.y2() - edge.y1());
+
+    double expected = 0;
+    for (const auto& edge : original.edges)
+    {
+      double ax = edge.x1(), ay = edge.y1(), bx = edge.x2(), by = edge.y2();
+      double t0 = 0, t1 = 1;
+      const double p[4] = {ax - bx, bx - ax, ay - by, by - ay};
+      const double q[4] = {ax - x1, x2 - ax, ay - y1, y2 - ay};
+      bool visible = true;
+      for (int k = 0; k < 4 && visible; k++)
+      {
+        if (p[k] == 0)
+          visible = (q[k] >= 0);
+        else if (p[k] < 0)
+          t0 = std::max(t0, q[k] / p[k]);
+        else
+          t1 = std::min(t1, q[k] / p[k]);
+      }
+      if (visible && t0 < t1) expected += (t1 - t0) * std::hypot(bx - ax, by - ay);
+    }
+
+    if (std::abs(length - expected) > 1e-9)
+      TEST_FAILED("Length " + to_string(length) + " should be " + to_string(expected) + " for " +
+                  name(box));
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that an invalid box is rejected
+ */
+// ----------------------------------------------------------------------
+
+void invalid()
+{
+  Grid grid(5, 5);
+  Collector collector;
+  try
+  {
+    MyContourer::fill_clipped(collector, grid, 0, 1, 3, 0, 1, 4);
+    TEST_FAILED("Invalid box should throw");
+  }
+  catch (const std::runtime_error&)
+  {
+  }
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test(void)
+  {
+    TEST(covering);
+    TEST(fill);
+    TEST(line);
+    TEST(invalid);
+  }
+};
+
+}  // namespace BoxClipperTest
+
+//! The main program
+int main(void)
+{
+  using namespace std;
+  cout << endl << "BoxClipper" << endl << "==========" << endl;
+  BoxClipperTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
@@ -0,0 +1,229 @@
+// ======================================================================
+/*!
+ * \file
+ * \brief Regression tests for namespace BoxFilter2D
+ */
+// ======================================================================
+
+#include "BoxFilter2D.h"
+#include "MirrorMatrix.h"
+#include <regression/tframe.h>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+template <typename T>
+string tostr(const T& value)
+{
+  ostringstream out;
+  out << value;
+  return out.str();
+}
+
+//! Protection against conflicts with global functions
+namespace BoxFilter2DTest
+{
+// ----------------------------------------------------------------------
+/*
+ * A customized grid for testing purposes
+ */
+// ----------------------------------------------------------------------
+
+class Matrix
+{
+ public:
+  typedef double value_type;
+  typedef int size_type;
+  size_type width() const { return itsWidth; }
+  size_type height() const { return itsHeight; }
+  const value_type& operator()(size_type i, size_type j) const { return itsData[i + itsWidth * j]; }
+  value_type& operator()(size_type i, size_type j) { return itsData[i + itsWidth * j]; }
+  Matrix(size_type i, size_type j)
+      : itsWidth(i), itsHeight(j), itsData(itsWidth * itsHeight, value_type())
+  {
+  }
+
+ private:
+  Matrix();
+  size_type itsWidth;
+  size_type itsHeight;
+  std::vector<value_type> itsData;
+};
+
+// ----------------------------------------------------------------------
+
+Matrix make_noise(Matrix::size_type w, Matrix::size_type h)
+{
+  Matrix grid(w, h);
+  unsigned int seed = 123456;
+  for (Matrix::size_type j = 0; j < grid.height(); j++)
+    for (Matrix::size_type i = 0; i < grid.width(); i++)
+      grid(i, j) = sin(0.1 * i + 0.2 * j) + 1.0 * rand_r(&seed) / RAND_MAX;
+  return grid;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that linear fields are preserved thanks to the mirroring
+ */
+// ----------------------------------------------------------------------
+
+void linear()
+{
+  Matrix original(50, 40);
+  for (int j = 0; j < original.height(); j++)
+    for (int i = 0; i < original.width(); i++)
+      original(i, j) = 3 + 0.5 * i - 0.25 * j;
+
+  for (int radius : {1, 5, 30, 100})
+  {
+    Matrix grid = original;
+    Tron::BoxFilter2D::box(grid, radius);
+    for (int j = 0; j < grid.height(); j++)
+      for (int i = 0; i < grid.width(); i++)
+        if (std::abs(grid(i, j) - original(i, j)) > 1e-9)
+          TEST_FAILED("Radius " + tostr(radius) + " at " + tostr(i) + "," + tostr(j) + ": " +
+                      tostr(grid(i, j)) + " <> " + tostr(original(i, j)));
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test the box filter against a direct convolution
+ */
+// ----------------------------------------------------------------------
+
+void reference()
+{
+  Matrix original = make_noise(40, 30);
+  original(17, 11) = NAN;
+  Tron::MirrorMatrix<Matrix> mirror(original);
+
+  for (int radius : {1, 4, 12})
+  {
+    Matrix grid = original;
+    Tron::BoxFilter2D::box(grid, radius);
+
+    for (int jj = 0; jj < grid.height(); jj++)
+      for (int ii = 0; ii < grid.width(); ii++)
+      {
+        double sum = 0;
+        for (int j = -radius; j <= radius; j++)
+          for (int i = -radius; i <= radius; i++)
+            sum += mirror(ii + i, jj + j);
+        const double n = 2 * radius + 1;
+        const double expected = (std::isnan(sum) ? original(ii, jj) : sum / (n * n));
+        const double value = grid(ii, jj);
+
+        if (std::isnan(expected) != std::isnan(value) ||
+            (!std::isnan(expected) && std::abs(expected - value) > 1e-9))
+          TEST_FAILED("Radius " + tostr(radius) + " at " + tostr(ii) + "," + tostr(jj) + ": " +
+                      tostr(value) + " <> " + tostr(expected));
+      }
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test the variance of the Gaussian approximation
+ */
+// ----------------------------------------------------------------------
+
+void gaussian()
+{
+  for (double sigma : {1.5, 4.0, 10.0})
+  {
+    Matrix grid(201, 201);
+    grid(100, 100) = 1;
+    Tron::BoxFilter2D::gaussian(grid, sigma);
+
+    double sum = 0;
+    double variance = 0;
+    for (int j = 0; j < grid.height(); j++)
+      for (int i = 0; i < grid.width(); i++)
+      {
+        sum += grid(i, j);
+        variance += grid(i, j) * (i - 100) * (i - 100);
+      }
+
+    if (std::abs(sum - 1) > 1e-9)
+      TEST_FAILED("Sum for sigma " + tostr(sigma) + " is " + tostr(sum));
+
+    // The box widths are integers, hence small standard deviations are inexact
+    if (std::abs(std::sqrt(variance) - sigma) > 0.1 * sigma)
+      TEST_FAILED("Sigma " + tostr(sigma) + " was approximated by " + tostr(std::sqrt(variance)));
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that threaded filtering equals serial filtering
+ */
+// ----------------------------------------------------------------------
+
+void threads()
+{
+  Matrix original = make_noise(123, 77);
+  original(60, 40) = NAN;
+
+  Matrix expected = original;
+  Tron::BoxFilter2D::gaussian(expected, 5);
+
+  for (unsigned int threads : {0U, 2U, 3U, 8U, 100U})
+  {
+    Matrix grid = original;
+    Tron::BoxFilter2D::gaussian(grid, 5, threads);
+
+    for (int j = 0; j < grid.height(); j++)
+      for (int i = 0; i < grid.width(); i++)
+      {
+        const double a = grid(i, j);
+        const double b = expected(i, j);
+        if (!(a == b || (std::isnan(a) && std::isnan(b))))
+          TEST_FAILED("Threads " + tostr(threads) + " differ at " + tostr(i) + "," + tostr(j));
+      }
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test(void)
+  {
+    TEST(linear);
+    TEST(reference);
+    TEST(gaussian);
+    TEST(threads);
+  }
+};
+
+}  // namespace BoxFilter2DTest
+
+//! The main program
+int main(void)
+{
+  using namespace std;
+  cout << endl << "BoxFilter2D" << endl << "===========" << endl;
+  BoxFilter2DTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
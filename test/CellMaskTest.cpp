@@ -0,0 +1,382 @@
+// ======================================================================
+/*!
+ * \file
+ * \brief Regression tests for Tron::CellMask
+ */
+// ======================================================================
+
+#include "CellMask.h"
+#include "EdgeCollector.h"
+#include <regression/tframe.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+//! Protection against conflicts with global functions
+namespace CellMaskTest
+{
+typedef Tron::Traits<double, double, Tron::NanMissing> MyTraits;
+typedef Tron::Edge<MyTraits> MyEdge;
+typedef TronTest::EdgeCollector<MyEdge> Collector;
+}  // namespace CellMaskTest
+
+#include "Tron.h"
+
+using namespace std;
+
+namespace CellMaskTest
+{
+typedef vector<pair<double, double> > Points;
+
+// Closed square ring
+Points square(double x1, double y1, double x2, double y2)
+{
+  return Points{{x1, y1}, {x1, y2}, {x2, y2}, {x2, y1}, {x1, y1}};
+}
+
+typedef TronTest::WaveGrid<> Grid;
+
+// The same grid with the mask applied by valid()
+class MaskedGrid : public Grid
+{
+ public:
+  MaskedGrid(size_type theWidth, size_type theHeight, const Tron::CellMask& theMask)
+      : Grid(theWidth, theHeight), itsMask(theMask)
+  {
+  }
+  bool valid(size_type i, size_type j) const { return itsMask.test(i, j); }
+
+ private:
+  const Tron::CellMask& itsMask;
+};
+
+typedef Tron::Contourer<Grid, Collector, MyTraits, Tron::LinearInterpolation> MyContourer;
+typedef Tron::Contourer<MaskedGrid, Collector, MyTraits, Tron::LinearInterpolation>
+    MaskedContourer;
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test setting and counting bits
+ */
+// ----------------------------------------------------------------------
+
+void bits()
+{
+  Tron::CellMask mask(130, 3);
+  if (mask.count() != 0) TEST_FAILED("New mask should be empty");
+
+  mask.set(0, 0);
+  mask.set(63, 1);
+  mask.set(64, 1);
+  mask.set(129, 2);
+  if (mask.count() != 4) TEST_FAILED("Expected 4 cells, got " + to_string(mask.count()));
+  if (!mask.test(63, 1) || !mask.test(64, 1) || mask.test(65, 1) || !mask.test(129, 2))
+    TEST_FAILED("Wrong bits set");
+
+  mask.set(64, 1, false);
+  if (mask.test(64, 1)) TEST_FAILED("Failed to reset a bit");
+
+  Tron::CellMask full(130, 3, true);
+  if (full.count() != 390) TEST_FAILED("Full mask should have 390 cells");
+
+  full &= mask;
+  if (full.count() != 3) TEST_FAILED("Intersection should have 3 cells");
+
+  full.fill(true);
+  if (full.count() != 390) TEST_FAILED("Filled mask should have 390 cells");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test rasterizing polygons
+ */
+// ----------------------------------------------------------------------
+
+void rasterize()
+{
+  Grid grid(20, 15);
+
+  vector<Points> rings{square(2.5, 2.5, 10.5, 8.5)};
+  auto mask = Tron::CellMask::rasterize(grid, rings);
+  if (mask.width() != 19 || mask.height() != 14) TEST_FAILED("Wrong mask size");
+  if (mask.count() != 48) TEST_FAILED("Expected 48 cells, got " + to_string(mask.count()));
+  if (!mask.test(2, 2) || !mask.test(9, 7) || mask.test(1, 2) || mask.test(10, 7))
+    TEST_FAILED("Wrong cells in the square");
+
+  // A hole and a separate polygon, the rings need not be closed
+  rings.push_back(square(4.5, 4.5, 6.5, 6.5));
+  rings.push_back(Points{{15, 10}, {15, 13}, {18, 13}, {18, 10}});
+  mask = Tron::CellMask::rasterize(grid, rings);
+  if (mask.count() != 44 + 9) TEST_FAILED("Expected 53 cells, got " + to_string(mask.count()));
+  if (mask.test(4, 4) || !mask.test(16, 11)) TEST_FAILED("Wrong cells in the hole or polygon");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test contouring with a mask
+ */
+// ----------------------------------------------------------------------
+
+void contour()
+{
+  Grid grid(20, 15);
+  auto mask = Tron::CellMask::rasterize(
+      grid, vector<Points>{square(2.5, 2.5, 10.5, 8.5), square(4.5, 4.5, 6.5, 6.5)});
+  MaskedGrid masked(20, 15, mask);
+
+  Collector result, expected;
+  MyContourer::fill(result, grid, -0.2, 0.4, mask);
+  MaskedContourer::fill(expected, masked, -0.2, 0.4);
+  if (result.edges.empty()) TEST_FAILED("No edges were produced");
+  if (!same(result, expected)) TEST_FAILED("Fill edges differ");
+
+  result.edges.clear();
+  expected.edges.clear();
+  MyContourer::line(result, grid, 0.1, mask);
+  MaskedContourer::line(expected, masked, 0.1);
+  if (result.edges.empty()) TEST_FAILED("No line edges were produced");
+  if (!same(result, expected)) TEST_FAILED("Line edges differ");
+
+  try
+  {
+    Tron::CellMask wrong(20, 15);
+    MyContourer::fill(result, grid, -0.2, 0.4, wrong);
+    TEST_FAILED("Mask size mismatch should throw");
+  }
+  catch (const std::runtime_error&)
+  {
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test iterating over the cells with word scans
+ */
+// ----------------------------------------------------------------------
+
+void for_each()
+{
+  Tron::CellMask mask(200, 4);
+  for (size_t i = 0; i < 200; i += 7)
+    mask.set(i, 1);
+  mask.set(63, 2);
+  mask.set(64, 2);
+  mask.set(199, 3);
+
+  vector<pair<size_t, size_t> > cells;
+  auto collect = [&](size_t i, size_t j) { cells.push_back(make_pair(i, j)); };
+
+  size_t n = mask.for_each(0, 0, 200, 4, collect);
+  if (n != mask.count() || cells.size() != n) TEST_FAILED("All cells should be visited");
+
+  // Partial words at both ends
+  cells.clear();
+  n = mask.for_each(63, 1, 129, 3, collect);
+  size_t expected = 0;
+  for (size_t j = 1; j < 3; j++)
+    for (size_t i = 63; i < 129; i++)
+      expected += mask.test(i, j);
+  if (n != expected) TEST_FAILED("Expected " + to_string(expected) + " cells, got " + to_string(n));
+  for (const auto& cell : cells)
+    if (cell.first < 63 || cell.first >= 129 || cell.second < 1 || cell.second >= 3 ||
+        !mask.test(cell.first, cell.second))
+      TEST_FAILED("Cell outside the rectangle or the mask");
+
+  if (mask.for_each(10, 0, 10, 4, collect) != 0) TEST_FAILED("Empty rectangle should be empty");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test contouring with a precomputed validity mask
+ */
+// ----------------------------------------------------------------------
+
+void validity()
+{
+  Grid grid(20, 15);
+  auto region = Tron::CellMask::rasterize(
+      grid, vector<Points>{square(1.5, 2.5, 16.5, 12.5), square(4.5, 4.5, 6.5, 6.5)});
+  MaskedGrid masked(20, 15, region);
+
+  const auto valid = Tron::CellMask::validity(masked);
+  if (valid.count() != region.count()) TEST_FAILED("Validity mask differs from grid.valid()");
+
+  Collector result, expected;
+  MaskedContourer::fill(result, masked, -0.2, 0.4, valid);
+  MaskedContourer::fill(expected, masked, -0.2, 0.4);
+  if (expected.edges.empty()) TEST_FAILED("No edges were produced");
+  if (!same(result, expected)) TEST_FAILED("Fill edges differ");
+
+  Tron::Hints<MaskedGrid, MyTraits> hints(masked, 4);
+  result.edges.clear();
+  MaskedContourer::fill(result, masked, -0.2, 0.4, hints, valid);
+  if (!same(result, expected)) TEST_FAILED("Fill edges with hints differ");
+
+  result.edges.clear();
+  expected.edges.clear();
+  MaskedContourer::line(result, masked, 0.1, hints, valid);
+  MaskedContourer::line(expected, masked, 0.1);
+  if (expected.edges.empty()) TEST_FAILED("No line edges were produced");
+  if (!same(result, expected)) TEST_FAILED("Line edges with hints differ");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test caching masks
+ */
+// ----------------------------------------------------------------------
+
+void cache()
+{
+  Grid grid(20, 15);
+  Tron::CellMaskCache cache;
+  int created = 0;
+  auto creator = [&]()
+  {
+    ++created;
+    return Tron::CellMask::rasterize(grid, vector<Points>{square(2.5, 2.5, 10.5, 8.5)});
+  };
+
+  auto mask1 = cache.get(1, creator);
+  auto mask2 = cache.get(1, creator);
+  auto mask3 = cache.get(2, creator);
+
+  if (created != 2) TEST_FAILED("Masks should have been created twice");
+  if (mask1 != mask2) TEST_FAILED("Same key should return the same mask");
+  if (mask1 == mask3) TEST_FAILED("Different keys should return different masks");
+  if (cache.size() != 2) TEST_FAILED("Cache should contain 2 masks");
+
+  cache.clear();
+  if (cache.size() != 0) TEST_FAILED("Cache should be empty");
+  if (mask1->count() != 48) TEST_FAILED("Cleared masks should remain usable");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that creating a mask does not block other keys
+ */
+// ----------------------------------------------------------------------
+
+void cache_threads()
+{
+  Grid grid(20, 15);
+  Tron::CellMaskCache cache;
+  auto creator = [&]()
+  { return Tron::CellMask::rasterize(grid, vector<Points>{square(2.5, 2.5, 10.5, 8.5)}); };
+
+  // The first mask is finished only after the second one has been created
+  std::atomic<bool> second(false);
+  std::atomic<bool> waited(true);
+  std::atomic<int> created(0);
+  auto slow = [&]()
+  {
+    ++created;
+    const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!second && std::chrono::steady_clock::now() < timeout)
+      std::this_thread::yield();
+    waited = second.load();
+    return creator();
+  };
+
+  Tron::CellMaskCache::value_type mask1, mask2, mask3;
+  std::thread first([&]() { mask1 = cache.get(1, slow); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  std::thread same([&]() { mask3 = cache.get(1, slow); });
+  mask2 = cache.get(2, creator);
+  second = true;
+  first.join();
+  same.join();
+
+  if (!waited) TEST_FAILED("Creating the second mask waited for the first one");
+  if (created != 1) TEST_FAILED("The first mask was created " + to_string(created) + " times");
+  if (!mask1 || mask1 != mask3) TEST_FAILED("Same key should return the same mask");
+  if (!mask2 || mask2->count() != 48) TEST_FAILED("The second mask is wrong");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that a failed mask is created again
+ */
+// ----------------------------------------------------------------------
+
+void cache_failure()
+{
+  Grid grid(20, 15);
+  Tron::CellMaskCache cache;
+  int calls = 0;
+  auto creator = [&]()
+  {
+    if (++calls == 1) throw std::runtime_error("Rasterization failed");
+    return Tron::CellMask::rasterize(grid, vector<Points>{square(2.5, 2.5, 10.5, 8.5)});
+  };
+
+  try
+  {
+    cache.get(1, creator);
+    TEST_FAILED("The creator exception should be passed on");
+  }
+  catch (const std::runtime_error&)
+  {
+  }
+
+  if (cache.size() != 0) TEST_FAILED("The failed mask should not be cached");
+  auto mask = cache.get(1, creator);
+  if (!mask || mask->count() != 48) TEST_FAILED("The mask was not created again");
+  if (calls != 2) TEST_FAILED("Expected 2 creator calls, got " + to_string(calls));
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test(void)
+  {
+    TEST(bits);
+    TEST(rasterize);
+    TEST(contour);
+    TEST(for_each);
+    TEST(validity);
+    TEST(cache);
+    TEST(cache_threads);
+    TEST(cache_failure);
+  }
+};
+
+}  // namespace CellMaskTest
+
+//! The main program
+int main(void)
+{
+  using namespace std;
+  cout << endl << "CellMask" << endl << "========" << endl;
+  CellMaskTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
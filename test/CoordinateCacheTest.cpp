@@ -0,0 +1,308 @@
+// ======================================================================
+/*!
+ * \file
+ * \brief Regression tests for Tron::CoordinateCache
+ */
+// ======================================================================
+
+#include "CoordinateCache.h"
+#include "EdgeCollector.h"
+#include <regression/tframe.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+//! Protection against conflicts with global functions
+namespace CoordinateCacheTest
+{
+typedef Tron::Traits<double, double, Tron::NanMissing> MyTraits;
+typedef Tron::Edge<MyTraits> MyEdge;
+typedef TronTest::EdgeCollector<MyEdge> Collector;
+}  // namespace CoordinateCacheTest
+
+#include "Tron.h"
+
+using namespace std;
+
+namespace CoordinateCacheTest
+{
+// ----------------------------------------------------------------------
+/*
+ * A curvilinear grid whose coordinates are expensive to compute
+ */
+// ----------------------------------------------------------------------
+
+class Grid
+{
+ public:
+  typedef double value_type;
+  typedef int size_type;
+  typedef double coord_type;
+
+  Grid(size_type theWidth, size_type theHeight, double thePhase)
+      : itsWidth(theWidth), itsHeight(theHeight), itsData(theWidth * theHeight)
+  {
+    for (size_type j = 0; j < itsHeight; j++)
+      for (size_type i = 0; i < itsWidth; i++)
+        itsData[i + itsWidth * j] = sin(0.2 * i + thePhase) * cos(0.15 * j);
+  }
+
+  size_type width() const { return itsWidth; }
+  size_type height() const { return itsHeight; }
+  const value_type& operator()(size_type i, size_type j) const { return itsData[i + itsWidth * j]; }
+  coord_type x(size_type i, size_type j) const { return i * cos(0.01 * j) + 0.1 * j; }
+  coord_type y(size_type i, size_type j) const { return j + 0.05 * i * i / itsWidth; }
+  bool valid(size_type i, size_type j) const { return true; }
+
+ private:
+  Grid();
+  size_type itsWidth;
+  size_type itsHeight;
+  std::vector<value_type> itsData;
+};
+
+typedef Tron::CoordinateCache<double> MyCache;
+typedef Tron::CachedGrid<Grid> MyCachedGrid;
+typedef Tron::Contourer<Grid, Collector, MyTraits, Tron::LinearInterpolation> MyContourer;
+typedef Tron::Contourer<MyCachedGrid, Collector, MyTraits, Tron::LinearInterpolation>
+    CachedContourer;
+
+// Counts the projector calls
+MyCache::projector_type counting(const Grid& theGrid, std::atomic<int>& theCalls)
+{
+  auto projector = Tron::grid_projector<double>(theGrid);
+  return [projector, &theCalls](std::size_t j1, std::size_t j2, double* x, double* y)
+  {
+    ++theCalls;
+    projector(j1, j2, x, y);
+  };
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that blocks are computed only when needed
+ */
+// ----------------------------------------------------------------------
+
+void lazy()
+{
+  Grid grid(30, 50, 0);
+  std::atomic<int> calls(0);
+  MyCache cache(30, 50, counting(grid, calls), 16);
+
+  if (cache.computed_blocks() != 0) TEST_FAILED("Nothing should be computed initially");
+
+  if (cache.x(7, 40) != grid.x(7, 40)) TEST_FAILED("Incorrect x-coordinate");
+  if (cache.y(7, 40) != grid.y(7, 40)) TEST_FAILED("Incorrect y-coordinate");
+  if (cache.x_row(33)[29] != grid.x(29, 33)) TEST_FAILED("Incorrect row access");
+  if (cache.computed_blocks() != 1) TEST_FAILED("Only one block should be computed");
+  if (calls != 1) TEST_FAILED("The projector should be called once");
+
+  // The last block is partial
+
+  if (cache.y(0, 49) != grid.y(0, 49)) TEST_FAILED("Incorrect last row");
+  if (cache.computed_blocks() != 2) TEST_FAILED("Two blocks should be computed");
+
+  // The adapter caches the row pointers of even and odd rows separately
+
+  Grid other(30, 50, 1);
+  MyCachedGrid cached(other, cache);
+  for (int j : {40, 41, 15, 16, 40, 17, 49, 41})
+    if (cached.x(5, j) != grid.x(5, j) || cached.y(29, j) != grid.y(29, j))
+      TEST_FAILED("Incorrect adapter coordinates on row " + to_string(j));
+  if (cache.computed_blocks() != 4) TEST_FAILED("All blocks should be computed");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test contouring several parameters with a shared cache
+ */
+// ----------------------------------------------------------------------
+
+void contour()
+{
+  Grid first(40, 35, 0);
+  Grid second(40, 35, 1.5);
+
+  std::atomic<int> calls(0);
+  MyCache cache(40, 35, counting(first, calls), 8);
+
+  for (const Grid* grid : {&first, &second})
+  {
+    MyCachedGrid cached(*grid, cache);
+
+    Collector result, expected;
+    CachedContourer::fill(result, cached, -0.3, 0.4);
+    MyContourer::fill(expected, *grid, -0.3, 0.4);
+    if (expected.edges.empty()) TEST_FAILED("No edges were produced");
+    if (!same(result, expected)) TEST_FAILED("Fill edges differ");
+
+    result.edges.clear();
+    expected.edges.clear();
+    CachedContourer::line(result, cached, 0.1);
+    MyContourer::line(expected, *grid, 0.1);
+    if (expected.edges.empty()) TEST_FAILED("No line edges were produced");
+    if (!same(result, expected)) TEST_FAILED("Line edges differ");
+  }
+
+  if (calls != 5) TEST_FAILED("Expected 5 projector calls, got " + to_string(calls));
+
+  Grid other(41, 35, 0);
+  try
+  {
+    MyCachedGrid cached(other, cache);
+    TEST_FAILED("Size mismatch should throw");
+  }
+  catch (const std::runtime_error&)
+  {
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that each block is computed once with several threads
+ */
+// ----------------------------------------------------------------------
+
+void threads()
+{
+  Grid grid(50, 200, 0);
+  std::atomic<int> calls(0);
+  MyCache cache(50, 200, counting(grid, calls), 10);
+
+  std::atomic<int> errors(0);
+  std::vector<std::thread> workers;
+  for (int t = 0; t < 8; t++)
+    workers.emplace_back(
+        [&, t]()
+        {
+          for (int j = 0; j < grid.height(); j++)
+          {
+            const int jj = (j + 25 * t) % grid.height();
+            for (int i = 0; i < grid.width(); i++)
+              if (cache.x(i, jj) != grid.x(i, jj) || cache.y(i, jj) != grid.y(i, jj)) ++errors;
+          }
+        });
+  for (auto& worker : workers)
+    worker.join();
+
+  if (errors != 0) TEST_FAILED("Incorrect coordinates were read");
+  if (calls != 20) TEST_FAILED("Expected 20 projector calls, got " + to_string(calls));
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that different blocks can be computed simultaneously
+ */
+// ----------------------------------------------------------------------
+
+void parallel()
+{
+  Grid grid(50, 40, 0);
+  auto projector = Tron::grid_projector<double>(grid);
+
+  // The first block is finished only after the second one has been started
+  std::atomic<bool> second(false);
+  std::atomic<bool> waited(true);
+  auto blocking = [&](std::size_t j1, std::size_t j2, double* x, double* y)
+  {
+    if (j1 == 0)
+    {
+      const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+      while (!second && std::chrono::steady_clock::now() < timeout)
+        std::this_thread::yield();
+      waited = second.load();
+    }
+    else
+      second = true;
+    projector(j1, j2, x, y);
+  };
+
+  MyCache cache(50, 40, blocking, 20);
+  std::thread first([&]() { cache.x(0, 0); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  cache.x(0, 30);
+  first.join();
+
+  if (!waited) TEST_FAILED("The second block waited for the first one");
+  if (cache.x(3, 5) != grid.x(3, 5) || cache.y(3, 35) != grid.y(3, 35))
+    TEST_FAILED("Incorrect coordinates were read");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that a failed block is computed again
+ */
+// ----------------------------------------------------------------------
+
+void failure()
+{
+  Grid grid(20, 20, 0);
+  auto projector = Tron::grid_projector<double>(grid);
+  int calls = 0;
+  auto failing = [&](std::size_t j1, std::size_t j2, double* x, double* y)
+  {
+    if (++calls == 1) throw std::runtime_error("Projection failed");
+    projector(j1, j2, x, y);
+  };
+
+  MyCache cache(20, 20, failing, 10);
+  try
+  {
+    cache.x(0, 0);
+    TEST_FAILED("The projector exception should be passed on");
+  }
+  catch (const std::runtime_error&)
+  {
+  }
+
+  if (cache.computed_blocks() != 0) TEST_FAILED("The failed block should not be marked ready");
+  if (cache.x(4, 3) != grid.x(4, 3)) TEST_FAILED("The block was not computed again");
+  if (calls != 2) TEST_FAILED("Expected 2 projector calls, got " + to_string(calls));
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test(void)
+  {
+    TEST(lazy);
+    TEST(contour);
+    TEST(threads);
+    TEST(parallel);
+    TEST(failure);
+  }
+};
+
+}  // namespace CoordinateCacheTest
+
+//! The main program
+int main(void)
+{
+  using namespace std;
+  cout << endl << "CoordinateCache" << endl << "===============" << endl;
+  CoordinateCacheTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
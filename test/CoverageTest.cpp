@@ -0,0 +1,222 @@
+// ======================================================================
+/*!
+ * \file
+ * \brief Regression tests for Tron::Coverage
+ */
+// ======================================================================
+
+#include "Coverage.h"
+#include "FlatBuilder.h"
+#include "MultiBandBuilder.h"
+#include "Tron.h"
+#include <regression/tframe.h>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//! Protection against conflicts with global functions
+namespace CoverageTest
+{
+typedef Tron::Traits<double, double, Tron::NanMissing> MyTraits;
+typedef Tron::MultiBandBuilder<MyTraits> MyBuilder;
+typedef Tron::Coverage<MyTraits> MyCoverage;
+
+// ----------------------------------------------------------------------
+/*
+ * A grid whose coordinates are the grid indexes
+ */
+// ----------------------------------------------------------------------
+
+class Grid
+{
+ public:
+  typedef double value_type;
+  typedef int size_type;
+  typedef double coord_type;
+
+  Grid(size_type theWidth, size_type theHeight)
+      : itsWidth(theWidth), itsHeight(theHeight), itsData(theWidth * theHeight)
+  {
+    for (size_type j = 0; j < itsHeight; j++)
+      for (size_type i = 0; i < itsWidth; i++)
+        itsData[i + itsWidth * j] = sin(0.37 * i) * cos(0.29 * j) + 0.3 * sin(1.3 * i + 0.7 * j);
+  }
+
+  size_type width() const { return itsWidth; }
+  size_type height() const { return itsHeight; }
+  const value_type& operator()(size_type i, size_type j) const { return itsData[i + itsWidth * j]; }
+  coord_type x(size_type i, size_type j) const { return i; }
+  coord_type y(size_type i, size_type j) const { return j; }
+  bool valid(size_type i, size_type j) const { return true; }
+
+ private:
+  Grid();
+  size_type itsWidth;
+  size_type itsHeight;
+  std::vector<value_type> itsData;
+};
+
+typedef Tron::Contourer<Grid, MyBuilder, MyTraits, Tron::LinearInterpolation> MyContourer;
+typedef Tron::Contourer<Grid, Tron::FlatBuilder, MyTraits, Tron::LinearInterpolation> MyFlatContourer;
+
+const double nan = std::numeric_limits<double>::quiet_NaN();
+
+// A sink counting the path commands and the signed area
+class Sink
+{
+ public:
+  void moveto(double x, double y)
+  {
+    itsX0 = itsX = x;
+    itsY0 = itsY = y;
+    ++moves;
+  }
+  void lineto(double x, double y)
+  {
+    area += (x - itsX) * (itsY + y) / 2;
+    itsX = x;
+    itsY = y;
+  }
+  void closepath()
+  {
+    lineto(itsX0, itsY0);
+    ++closes;
+  }
+
+  int moves = 0;
+  int closes = 0;
+  double area = 0;
+
+ private:
+  double itsX0 = 0, itsY0 = 0, itsX = 0, itsY = 0;
+};
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test building a coverage from a list of limits
+ */
+// ----------------------------------------------------------------------
+
+void limits()
+{
+  Grid grid(40, 30);
+  MyBuilder builder;
+  MyContourer::fill(builder, grid, vector<double>{nan, -0.5, 0, 0.5, nan});
+  MyCoverage coverage(builder);
+
+  if (coverage.bands() != 4) TEST_FAILED("Expected 4 bands, got " + to_string(coverage.bands()));
+  if (builder.bands() != 0 || builder.arcs().size() != 0)
+    TEST_FAILED("The results should be moved out of the builder");
+
+  // The faces are in band order
+  for (size_t band = 0; band < coverage.bands(); band++)
+  {
+    auto range = coverage.band_faces(band);
+    if (range.first >= range.second) TEST_FAILED("Band " + to_string(band) + " has no faces");
+    for (size_t i = range.first; i < range.second; i++)
+      if (coverage.faces()[i].band != band) TEST_FAILED("Face in the wrong band");
+  }
+
+  // The bands cover the grid exactly
+  double area = 0;
+  for (size_t band = 0; band < coverage.bands(); band++)
+  {
+    Sink sink;
+    coverage.draw(band, sink);
+    if (sink.moves != sink.closes) TEST_FAILED("Unclosed rings");
+    area += sink.area;
+  }
+  if (std::abs(area - 39 * 29) > 1e-6) TEST_FAILED("Total area is " + to_string(area));
+
+  // Unsorted limits are an error
+  try
+  {
+    MyBuilder builder2;
+    MyContourer::fill(builder2, grid, vector<double>{0, 1, 0.5});
+    TEST_FAILED("Unsorted limits should throw");
+  }
+  catch (const std::runtime_error&)
+  {
+  }
+
+  // Missing limits are allowed only at the ends
+  try
+  {
+    MyBuilder builder3;
+    MyContourer::fill(builder3, grid, vector<double>{0, nan, 1});
+    TEST_FAILED("Missing limits in the middle should throw");
+  }
+  catch (const std::runtime_error&)
+  {
+  }
+
+  // Other builders collecting bands work too
+  Tron::FlatBuilder flat;
+  MyFlatContourer::fill(flat, grid, vector<double>{nan, -0.5, 0, 0.5, nan});
+  if (flat.bands() != 4) TEST_FAILED("FlatBuilder should have 4 bands");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test TopoJSON output
+ */
+// ----------------------------------------------------------------------
+
+void topojson()
+{
+  Grid grid(3, 3);
+  MyBuilder builder;
+  MyContourer::fill(builder, grid, vector<double>{nan, 0.5, nan});
+  MyCoverage coverage(builder);
+
+  ostringstream out;
+  coverage.write_topojson(out);
+  string result = out.str();
+
+  string prefix =
+      R"({"type":"Topology","objects":{"coverage":{"type":"GeometryCollection","geometries":[)"
+      R"({"type":"MultiPolygon","properties":{"band":0},"arcs":[[[)";
+  if (result.compare(0, prefix.size(), prefix) != 0) TEST_FAILED("Unexpected output: " + result);
+
+  // The isoline between the bands is used by both, once reversed
+  if (result.find("[[[~") != string::npos) TEST_FAILED("Reversed arcs must be negative numbers");
+  if (result.find(",-") == string::npos && result.find("[-") == string::npos)
+    TEST_FAILED("No reversed arcs in the output: " + result);
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test(void)
+  {
+    TEST(limits);
+    TEST(topojson);
+  }
+};
+
+}  // namespace CoverageTest
+
+//! The main program
+int main(void)
+{
+  using namespace std;
+  cout << endl << "Coverage" << endl << "========" << endl;
+  CoverageTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
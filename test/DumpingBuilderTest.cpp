@@ -0,0 +1,275 @@
+// ======================================================================
+/*!
+ * \file
+ * \brief Regression tests for Tron::DumpingBuilder
+ */
+// ======================================================================
+
+#include "FlatBuilder.h"
+#include "Stats.h"
+#include <regression/tframe.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//! Protection against conflicts with global functions
+namespace DumpingBuilderTest
+{
+// A builder which always fails
+struct Failing
+{
+};
+}  // namespace DumpingBuilderTest
+
+namespace Tron
+{
+namespace Builder
+{
+template <typename Traits, typename Edges>
+void fill(const Edges& theEdges, DumpingBuilderTest::Failing& theAdapter, Stats* theStats = nullptr)
+{
+  throw std::runtime_error("Builder failed");
+}
+}  // namespace Builder
+}  // namespace Tron
+
+#include "DumpingBuilder.h"
+#include "Tron.h"
+
+using namespace std;
+
+namespace DumpingBuilderTest
+{
+typedef Tron::Traits<double, double, Tron::NanMissing> MyTraits;
+typedef Tron::Edge<MyTraits> MyEdge;
+
+// ----------------------------------------------------------------------
+/*
+ * A customized grid for testing purposes
+ */
+// ----------------------------------------------------------------------
+
+class Grid
+{
+ public:
+  typedef double value_type;
+  typedef int size_type;
+  typedef double coord_type;
+
+  Grid(size_type theWidth, size_type theHeight)
+      : itsWidth(theWidth), itsHeight(theHeight), itsData(theWidth * theHeight)
+  {
+    for (size_type j = 0; j < itsHeight; j++)
+      for (size_type i = 0; i < itsWidth; i++)
+        itsData[i + itsWidth * j] = sin(0.3 * i) * cos(0.25 * j);
+  }
+
+  size_type width() const { return itsWidth; }
+  size_type height() const { return itsHeight; }
+  const value_type& operator()(size_type i, size_type j) const { return itsData[i + itsWidth * j]; }
+  coord_type x(size_type i, size_type j) const { return i; }
+  coord_type y(size_type i, size_type j) const { return j; }
+  bool valid(size_type i, size_type j) const { return true; }
+
+ private:
+  Grid();
+  size_type itsWidth;
+  size_type itsHeight;
+  std::vector<value_type> itsData;
+};
+
+// A temporary directory for the dumps
+class TempDir
+{
+ public:
+  TempDir() : itsPath("/tmp/DumpingBuilderTest-XXXXXX")
+  {
+    if (mkdtemp(&itsPath[0]) == nullptr)
+      throw std::runtime_error("Failed to create a temporary directory");
+  }
+  ~TempDir()
+  {
+    for (const auto& file : itsFiles)
+      std::remove(file.c_str());
+    std::remove(itsPath.c_str());
+  }
+  std::string prefix() const { return itsPath + "/job-"; }
+  void add(const std::string& theFile) { itsFiles.push_back(theFile); }
+
+ private:
+  std::string itsPath;
+  std::vector<std::string> itsFiles;
+};
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that sampled jobs are dumped and replay identically
+ */
+// ----------------------------------------------------------------------
+
+void sample()
+{
+  typedef Tron::DumpingBuilder<Tron::FlatBuilder> MyBuilder;
+  typedef Tron::Contourer<Grid, MyBuilder, MyTraits, Tron::LinearInterpolation> MyContourer;
+
+  Grid grid(30, 20);
+  TempDir tmp;
+
+  // Dump every second job
+
+  Tron::JobDump::Sampler sampler(2);
+  Tron::FlatBuilder builder;
+  MyBuilder dumper(builder, sampler, tmp.prefix());
+
+  MyContourer::fill(dumper, grid, -0.2, 0.3);
+  const std::string first = dumper.last_dump();
+  if (first.empty()) TEST_FAILED("The first job should be dumped");
+  tmp.add(first);
+
+  MyContourer::fill(dumper, grid, 0.3, 0.8);
+  if (dumper.last_dump() != first) TEST_FAILED("The second job should not be dumped");
+
+  // The builder result is not affected and the dump replays to the same result
+
+  Tron::FlatBuilder direct;
+  Tron::Contourer<Grid, Tron::FlatBuilder, MyTraits, Tron::LinearInterpolation>::fill(
+      direct, grid, -0.2, 0.3);
+
+  const auto job = Tron::JobDump::read(first);
+  if (job.kind != Tron::JobDump::Kind::Edges) TEST_FAILED("Expected an edge job");
+  if (job.mode != Tron::JobDump::Mode::Fill) TEST_FAILED("Expected a fill job");
+
+  std::vector<MyEdge> edges;
+  for (std::size_t i = 0; i + 3 < job.edges.size(); i += 4)
+    edges.emplace_back(job.edges[i], job.edges[i + 1], job.edges[i + 2], job.edges[i + 3]);
+
+  Tron::FlatBuilder replay;
+  replay.build<MyTraits>(edges, true);
+
+  if (direct.coords().empty()) TEST_FAILED("No polygons were produced");
+  if (replay.coords() != direct.coords()) TEST_FAILED("Replayed coordinates differ");
+  if (replay.ring_offsets() != direct.ring_offsets()) TEST_FAILED("Replayed rings differ");
+
+  const std::size_t n = direct.coords().size();
+  if (builder.bands() != 2 || std::vector<double>(builder.coords().begin(),
+                                                  builder.coords().begin() + n) != direct.coords())
+    TEST_FAILED("The wrapped builder result differs");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that a failing job is dumped
+ */
+// ----------------------------------------------------------------------
+
+void failure()
+{
+  typedef Tron::DumpingBuilder<Failing> MyBuilder;
+  typedef Tron::Contourer<Grid, MyBuilder, MyTraits, Tron::LinearInterpolation> MyContourer;
+
+  Grid grid(30, 20);
+  TempDir tmp;
+
+  Tron::JobDump::Sampler never;
+  Failing failing;
+  MyBuilder dumper(failing, never, tmp.prefix());
+
+  try
+  {
+    MyContourer::fill(dumper, grid, -0.2, 0.3);
+    TEST_FAILED("The builder exception should be passed on");
+  }
+  catch (const std::runtime_error&)
+  {
+  }
+
+  if (dumper.last_dump().empty()) TEST_FAILED("The failed job should be dumped");
+  tmp.add(dumper.last_dump());
+
+  const auto job = Tron::JobDump::read(dumper.last_dump());
+  if (job.edges.empty()) TEST_FAILED("The failed job has no edges");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that failing to write a dump fails neither job nor builder error
+ */
+// ----------------------------------------------------------------------
+
+void unwritable()
+{
+  typedef Tron::DumpingBuilder<Tron::FlatBuilder> MyBuilder;
+  typedef Tron::DumpingBuilder<Failing> FailingBuilder;
+  typedef Tron::Contourer<Grid, MyBuilder, MyTraits, Tron::LinearInterpolation> MyContourer;
+  typedef Tron::Contourer<Grid, FailingBuilder, MyTraits, Tron::LinearInterpolation>
+      FailingContourer;
+
+  Grid grid(30, 20);
+  const std::string prefix = "/nonexistent/DumpingBuilderTest/job-";
+
+  // A sampled job is still built
+
+  Tron::JobDump::Sampler always(1);
+  Tron::FlatBuilder builder;
+  MyBuilder dumper(builder, always, prefix);
+  MyContourer::fill(dumper, grid, -0.2, 0.3);
+  if (builder.bands() != 1) TEST_FAILED("The job should be built even though the dump failed");
+  if (!dumper.last_dump().empty()) TEST_FAILED("No dump should have been written");
+  if (dumper.last_error().empty()) TEST_FAILED("The dump failure should be reported");
+
+  // The builder exception is passed on instead of the dump failure
+
+  Tron::JobDump::Sampler never;
+  Failing failing;
+  FailingBuilder failer(failing, never, prefix);
+  try
+  {
+    FailingContourer::fill(failer, grid, -0.2, 0.3);
+    TEST_FAILED("The builder exception should be passed on");
+  }
+  catch (const std::runtime_error& e)
+  {
+    if (std::string(e.what()) != "Builder failed")
+      TEST_FAILED("Expected the builder exception, got: " + std::string(e.what()));
+  }
+  if (failer.last_error().empty()) TEST_FAILED("The dump failure should be reported");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test(void)
+  {
+    TEST(sample);
+    TEST(failure);
+    TEST(unwritable);
+  }
+};
+
+}  // namespace DumpingBuilderTest
+
+//! The main program
+int main(void)
+{
+  using namespace std;
+  cout << endl << "DumpingBuilder" << endl << "==============" << endl;
+  DumpingBuilderTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
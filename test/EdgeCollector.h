@@ -0,0 +1,110 @@
+// ======================================================================
+/*!
+ * \file
+ * \brief Shared fixtures for tests comparing the edges of two contourers
+ *
+ * EdgeCollector is a builder which simply stores the edges it is given,
+ * hence the output of two grid adapters or kernels can be compared
+ * edge by edge with same(). WaveGrid is a smooth grid whose coordinates
+ * are the grid indexes.
+ *
+ * The builder overloads must be declared before the contourer, hence
+ * this header must be included before Tron.h.
+ */
+// ======================================================================
+
+#pragma once
+
+#include "Edge.h"
+#include "Stats.h"
+#include "Traits.h"
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace TronTest
+{
+// Collects the edges passed to the builder
+template <typename Edge>
+struct EdgeCollector
+{
+  std::vector<Edge> edges;
+};
+
+// Compare the edges, Edge::operator== deliberately matches reversed edges only
+template <typename Edge>
+bool same(const EdgeCollector<Edge>& theFirst, const EdgeCollector<Edge>& theSecond)
+{
+  if (theFirst.edges.size() != theSecond.edges.size()) return false;
+  for (std::size_t i = 0; i < theFirst.edges.size(); i++)
+  {
+    const auto& a = theFirst.edges[i];
+    const auto& b = theSecond.edges[i];
+    if (a.x1() != b.x1() || a.y1() != b.y1() || a.x2() != b.x2() || a.y2() != b.y2()) return false;
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------
+/*
+ * A grid of sin(a*i)*cos(b*j) + 0.3*sin(1.3*i+0.7*j) whose coordinates
+ * are the grid indexes
+ */
+// ----------------------------------------------------------------------
+
+template <typename T = double>
+class WaveGrid
+{
+ public:
+  typedef T value_type;
+  typedef int size_type;
+  typedef T coord_type;
+
+  WaveGrid(size_type theWidth, size_type theHeight, double theA = 0.77, double theB = 0.59)
+      : itsWidth(theWidth), itsHeight(theHeight), itsData(theWidth * theHeight)
+  {
+    for (size_type j = 0; j < itsHeight; j++)
+      for (size_type i = 0; i < itsWidth; i++)
+        itsData[i + itsWidth * j] = sin(theA * i) * cos(theB * j) + 0.3 * sin(1.3 * i + 0.7 * j);
+  }
+
+  size_type width() const { return itsWidth; }
+  size_type height() const { return itsHeight; }
+  const value_type& operator()(size_type i, size_type j) const { return itsData[i + itsWidth * j]; }
+  value_type& operator()(size_type i, size_type j) { return itsData[i + itsWidth * j]; }
+  coord_type x(size_type i, size_type j) const { return i; }
+  coord_type y(size_type i, size_type j) const { return j; }
+  bool valid(size_type i, size_type j) const { return true; }
+
+ private:
+  WaveGrid();
+  size_type itsWidth;
+  size_type itsHeight;
+  std::vector<value_type> itsData;
+};
+
+}  // namespace TronTest
+
+namespace Tron
+{
+namespace Builder
+{
+template <typename Traits, typename Edges, typename Edge>
+void fill(const Edges& theEdges,
+          TronTest::EdgeCollector<Edge>& theAdapter,
+          Stats* theStats = nullptr)
+{
+  theAdapter.edges.insert(theAdapter.edges.end(), theEdges.begin(), theEdges.end());
+}
+
+template <typename Traits, typename Edges, typename Edge>
+void line(const Edges& theEdges,
+          TronTest::EdgeCollector<Edge>& theAdapter,
+          Stats* theStats = nullptr)
+{
+  theAdapter.edges.insert(theAdapter.edges.end(), theEdges.begin(), theEdges.end());
+}
+}  // namespace Builder
+}  // namespace Tron
+
+// ======================================================================
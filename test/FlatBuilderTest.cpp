@@ -0,0 +1,182 @@
+// ======================================================================
+/*!
+ * \file
+ * \brief Regression tests for Tron::FlatBuilder
+ */
+// ======================================================================
+
+#include "Edge.h"
+#include "FlatBuilder.h"
+#include "FlipSet.h"
+#include "Traits.h"
+#include <regression/tframe.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+//! Protection against conflicts with global functions
+namespace FlatBuilderTest
+{
+typedef Tron::Traits<double, double> MyTraits;
+typedef Tron::Edge<MyTraits> MyEdge;
+typedef Tron::FlipSet<MyEdge> MyFlipSet;
+
+template <typename T>
+string tostring(const std::vector<T>& theValues)
+{
+  ostringstream out;
+  for (std::size_t i = 0; i < theValues.size(); i++)
+  {
+    if (i > 0) out << ' ';
+    out << theValues[i];
+  }
+  return out.str();
+}
+
+// Add a closed clockwise square with the given corners, or a counter clockwise one
+void square(MyFlipSet& theFlipSet, double x1, double y1, double x2, double y2, bool cw)
+{
+  if (cw)
+  {
+    theFlipSet.flip(MyEdge(x1, y1, x1, y2));
+    theFlipSet.flip(MyEdge(x1, y2, x2, y2));
+    theFlipSet.flip(MyEdge(x2, y2, x2, y1));
+    theFlipSet.flip(MyEdge(x2, y1, x1, y1));
+  }
+  else
+  {
+    theFlipSet.flip(MyEdge(x1, y1, x2, y1));
+    theFlipSet.flip(MyEdge(x2, y1, x2, y2));
+    theFlipSet.flip(MyEdge(x2, y2, x1, y2));
+    theFlipSet.flip(MyEdge(x1, y2, x1, y1));
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test polygon output
+ */
+// ----------------------------------------------------------------------
+
+void polygons()
+{
+  Tron::FlatBuilder builder;
+
+  // Band 1: a polygon with a hole and a separate square
+  {
+    MyFlipSet flipset;
+    square(flipset, 0, 0, 3, 3, true);
+    square(flipset, 1, 1, 2, 2, false);
+    square(flipset, 4, 0, 5, 1, true);
+    flipset.prepare();
+    builder.build<MyTraits>(flipset.edges(), true);
+  }
+
+  // Band 2: empty
+  {
+    MyFlipSet flipset;
+    flipset.prepare();
+    builder.build<MyTraits>(flipset.edges(), true);
+  }
+
+  // Band 3: a single square
+  {
+    MyFlipSet flipset;
+    square(flipset, 0, 0, 1, 1, true);
+    flipset.prepare();
+    builder.build<MyTraits>(flipset.edges(), true);
+  }
+
+  if (builder.bands() != 3) TEST_FAILED("Expected 3 bands, got " + to_string(builder.bands()));
+
+  string result = tostring(builder.band_offsets());
+  string ok = "0 2 2 3";
+  if (result != ok) TEST_FAILED("Band offsets: expected " + ok + " got " + result);
+
+  result = tostring(builder.polygon_offsets());
+  ok = "0 2 3 4";
+  if (result != ok) TEST_FAILED("Polygon offsets: expected " + ok + " got " + result);
+
+  result = tostring(builder.ring_offsets());
+  ok = "0 5 10 15 20";
+  if (result != ok) TEST_FAILED("Ring offsets: expected " + ok + " got " + result);
+
+  if (builder.coords().size() != 40)
+    TEST_FAILED("Expected 40 coordinates, got " + to_string(builder.coords().size()));
+
+  result = tostring(builder.coords()).substr(0, 39);
+  ok = "0 0 0 3 3 3 3 0 0 0 1 1 2 1 2 2 1 2 1 1";
+  if (result != ok) TEST_FAILED("Coordinates: expected " + ok + " got " + result);
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test line output
+ */
+// ----------------------------------------------------------------------
+
+void lines()
+{
+  Tron::FlatBuilder builder;
+
+  MyFlipSet flipset;
+  flipset.flip(MyEdge(0, 0, 1, 0));
+  flipset.flip(MyEdge(1, 0, 2, 1));
+  flipset.flip(MyEdge(5, 5, 6, 6));
+  flipset.prepare();
+  builder.build<MyTraits>(flipset.edges(), false);
+
+  string result = tostring(builder.band_offsets());
+  string ok = "0 2";
+  if (result != ok) TEST_FAILED("Band offsets: expected " + ok + " got " + result);
+
+  result = tostring(builder.ring_offsets());
+  ok = "0 3 5";
+  if (result != ok) TEST_FAILED("Linestring offsets: expected " + ok + " got " + result);
+
+  // Mixing polygons and lines is an error
+
+  try
+  {
+    builder.build<MyTraits>(flipset.edges(), true);
+    TEST_FAILED("Mixing polygons and lines should fail");
+  }
+  catch (std::runtime_error&)
+  {
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test(void)
+  {
+    TEST(polygons);
+    TEST(lines);
+  }
+};
+
+}  // namespace FlatBuilderTest
+
+//! The main program
+int main(void)
+{
+  using namespace std;
+  cout << endl << "FlatBuilder" << endl << "===========" << endl;
+  FlatBuilderTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
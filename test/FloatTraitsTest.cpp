@@ -0,0 +1,304 @@
+// ======================================================================
+/*!
+ * \file
+ * \brief Regression tests for contouring with float coordinates
+ */
+// ======================================================================
+
+#include "EdgeCollector.h"
+#include "FlatBuilder.h"
+#include "FlipSet.h"
+#include "MultiBandBuilder.h"
+#include "Ring.h"
+#include <regression/tframe.h>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+//! Protection against conflicts with global functions
+namespace FloatTraitsTest
+{
+typedef Tron::Traits<float, float, Tron::NanMissing> FloatTraits;
+typedef Tron::Traits<double, double, Tron::NanMissing> DoubleTraits;
+typedef Tron::Edge<FloatTraits> FloatEdge;
+typedef Tron::Edge<DoubleTraits> DoubleEdge;
+
+template <typename Edge>
+using Collector = TronTest::EdgeCollector<Edge>;
+}  // namespace FloatTraitsTest
+
+#include "Tron.h"
+
+using namespace std;
+
+namespace FloatTraitsTest
+{
+// ----------------------------------------------------------------------
+/*
+ * A screen space grid. The values are rounded to float so that the
+ * float and double grids classify the vertices identically.
+ */
+// ----------------------------------------------------------------------
+
+template <typename T>
+class Grid : public TronTest::WaveGrid<T>
+{
+ public:
+  typedef typename TronTest::WaveGrid<T>::size_type size_type;
+  typedef typename TronTest::WaveGrid<T>::coord_type coord_type;
+
+  Grid(size_type theWidth, size_type theHeight)
+      : TronTest::WaveGrid<T>(theWidth, theHeight, 0.37, 0.29)
+  {
+    for (size_type j = 0; j < theHeight; j++)
+      for (size_type i = 0; i < theWidth; i++)
+        (*this)(i, j) = static_cast<float>((*this)(i, j));
+  }
+
+  coord_type x(size_type i, size_type j) const { return 1500 + i; }
+  coord_type y(size_type i, size_type j) const { return 800 + j; }
+};
+
+typedef Grid<float> FloatGrid;
+typedef Grid<double> DoubleGrid;
+
+// Maximum coordinate difference expected from float arithmetic near 2000
+const double tolerance = 1e-3;
+
+// Test whether two edges are equal within the tolerance
+bool similar(const FloatEdge& theFirst, const DoubleEdge& theSecond)
+{
+  return (std::abs(theFirst.x1() - theSecond.x1()) <= tolerance &&
+          std::abs(theFirst.y1() - theSecond.y1()) <= tolerance &&
+          std::abs(theFirst.x2() - theSecond.x2()) <= tolerance &&
+          std::abs(theFirst.y2() - theSecond.y2()) <= tolerance);
+}
+
+// Bands covering all values
+template <typename Builder, typename Traits, typename Grid>
+void contour(Builder& theBuilder, const Grid& theGrid)
+{
+  typedef Tron::Contourer<Grid, Builder, Traits, Tron::LinearInterpolation> MyContourer;
+  const typename Traits::value_type nan = std::numeric_limits<float>::quiet_NaN();
+  MyContourer::fill(theBuilder, theGrid, nan, -0.3f);
+  MyContourer::fill(theBuilder, theGrid, -0.3f, 0.3f);
+  MyContourer::fill(theBuilder, theGrid, 0.3f, nan);
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that float edges take half the space
+ */
+// ----------------------------------------------------------------------
+
+void size()
+{
+  if (sizeof(FloatEdge) != 4 * sizeof(float))
+    TEST_FAILED("Float edge size is " + to_string(sizeof(FloatEdge)));
+  if (sizeof(Tron::Ring<FloatTraits>::value_type) != 2 * sizeof(float))
+    TEST_FAILED("Float ring point size is " +
+                to_string(sizeof(Tron::Ring<FloatTraits>::value_type)));
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that float edges are matched exactly
+ */
+// ----------------------------------------------------------------------
+
+void flipset()
+{
+  const float x1 = 1500.25f;
+  const float y1 = 800.5f;
+  const float x2 = 1501.0f;
+  const float y2 = 800.75f;
+
+  const FloatEdge edge(x1, y1, x2, y2);
+  const FloatEdge reversed(x2, y2, x1, y1);
+  std::hash<FloatEdge> hasher;
+  if (hasher(edge) != hasher(reversed)) TEST_FAILED("Reversed edges should hash equally");
+
+  Tron::FlipSet<FloatEdge> flipset;
+  flipset.flip(edge);
+  flipset.flip(reversed);
+  flipset.prepare();
+  if (!flipset.empty()) TEST_FAILED("Reversed edges should cancel each other");
+
+  // An edge differing by a single ulp is a different edge
+
+  const float next = std::nextafter(x1, 2000.0f);
+  Tron::FlipSet<FloatEdge> other;
+  other.flip(edge);
+  other.flip(FloatEdge(x2, y2, next, y1));
+  other.prepare();
+  if (other.size() != 2) TEST_FAILED("Edges one ulp apart should not cancel");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that float and double contours agree
+ */
+// ----------------------------------------------------------------------
+
+void edges()
+{
+  FloatGrid fgrid(80, 60);
+  DoubleGrid dgrid(80, 60);
+
+  for (int line = 0; line < 2; line++)
+  {
+    Collector<FloatEdge> fresult;
+    Collector<DoubleEdge> dresult;
+    if (line)
+    {
+      Tron::Contourer<FloatGrid, Collector<FloatEdge>, FloatTraits, Tron::LinearInterpolation>::
+          line(fresult, fgrid, 0.2f);
+      Tron::Contourer<DoubleGrid, Collector<DoubleEdge>, DoubleTraits, Tron::LinearInterpolation>::
+          line(dresult, dgrid, 0.2f);
+    }
+    else
+    {
+      Tron::Contourer<FloatGrid, Collector<FloatEdge>, FloatTraits, Tron::LinearInterpolation>::
+          fill(fresult, fgrid, -0.3f, 0.4f);
+      Tron::Contourer<DoubleGrid, Collector<DoubleEdge>, DoubleTraits, Tron::LinearInterpolation>::
+          fill(dresult, dgrid, -0.3f, 0.4f);
+    }
+
+    if (dresult.edges.empty()) TEST_FAILED("No edges were produced");
+    if (fresult.edges.size() != dresult.edges.size())
+      TEST_FAILED("Edge counts differ: " + to_string(fresult.edges.size()) + " <> " +
+                  to_string(dresult.edges.size()));
+
+    // Rounding may reorder edges starting at almost the same x-coordinate, hence
+    // we match each float edge to a distinct double edge
+
+    vector<bool> used(dresult.edges.size(), false);
+    for (const auto& edge : fresult.edges)
+    {
+      size_t i = 0;
+      while (i < dresult.edges.size() && (used[i] || !similar(edge, dresult.edges[i])))
+        ++i;
+      if (i == dresult.edges.size())
+        TEST_FAILED("No match for edge " + to_string(edge.x1()) + "," + to_string(edge.y1()) +
+                    " " + to_string(edge.x2()) + "," + to_string(edge.y2()));
+      used[i] = true;
+    }
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test float rings through the flat output arrays
+ */
+// ----------------------------------------------------------------------
+
+void flat()
+{
+  FloatGrid fgrid(80, 60);
+  DoubleGrid dgrid(80, 60);
+
+  Tron::FlatBuilder fbuilder;
+  Tron::FlatBuilder dbuilder;
+  contour<Tron::FlatBuilder, FloatTraits>(fbuilder, fgrid);
+  contour<Tron::FlatBuilder, DoubleTraits>(dbuilder, dgrid);
+
+  if (fbuilder.bands() != 3) TEST_FAILED("Expected 3 bands");
+  if (fbuilder.band_offsets() != dbuilder.band_offsets()) TEST_FAILED("Band offsets differ");
+  if (fbuilder.polygon_offsets() != dbuilder.polygon_offsets())
+    TEST_FAILED("Polygon offsets differ");
+  if (fbuilder.ring_offsets() != dbuilder.ring_offsets()) TEST_FAILED("Ring offsets differ");
+  if (fbuilder.coords().size() != dbuilder.coords().size()) TEST_FAILED("Point counts differ");
+
+  for (size_t i = 0; i < fbuilder.coords().size(); i++)
+  {
+    const double value = fbuilder.coords()[i];
+    if (static_cast<float>(value) != value)
+      TEST_FAILED("Coordinate " + to_string(i) + " is not a widened float");
+    if (std::abs(value - dbuilder.coords()[i]) > tolerance)
+      TEST_FAILED("Coordinate " + to_string(i) + " differs");
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that float bands cover the grid exactly
+ */
+// ----------------------------------------------------------------------
+
+void multiband()
+{
+  FloatGrid grid(80, 60);
+  typedef Tron::MultiBandBuilder<FloatTraits> MyBuilder;
+
+  for (double tolerance : {0.0, 0.5})
+  {
+    MyBuilder builder(tolerance);
+    contour<MyBuilder, FloatTraits>(builder, grid);
+    builder.finish();
+
+    if (builder.bands() != 3) TEST_FAILED("Expected 3 bands");
+
+    double area = 0;
+    for (size_t band = 0; band < builder.bands(); band++)
+      for (const auto& polygon : builder.polygons(band))
+      {
+        const auto shell = builder.ring(polygon.shell);
+        if (!shell.closed()) TEST_FAILED("Shell is not closed");
+        if (!shell.isClockWise()) TEST_FAILED("Shell is not clockwise");
+        area += shell.signedArea();
+        for (const auto& hole : polygon.holes)
+        {
+          const auto ring = builder.ring(hole);
+          if (ring.isClockWise()) TEST_FAILED("Hole is clockwise");
+          area += ring.signedArea();
+        }
+      }
+
+    if (std::abs(area - 79 * 59) > 1e-6)
+      TEST_FAILED("Total area with tolerance " + to_string(tolerance) + " is " +
+                  to_string(area));
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test(void)
+  {
+    TEST(size);
+    TEST(flipset);
+    TEST(edges);
+    TEST(flat);
+    TEST(multiband);
+  }
+};
+
+}  // namespace FloatTraitsTest
+
+//! The main program
+int main(void)
+{
+  using namespace std;
+  cout << endl << "FloatTraits" << endl << "===========" << endl;
+  FloatTraitsTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
@@ -0,0 +1,250 @@
+// ======================================================================
+/*!
+ * \file
+ * \brief Regression tests for namespace JobDump
+ */
+// ======================================================================
+
+#include "Edge.h"
+#include "JobDump.h"
+#include "Traits.h"
+#include <regression/tframe.h>
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+using namespace Tron;
+using namespace std;
+
+//! Protection against conflicts with global functions
+namespace JobDumpTest
+{
+// ----------------------------------------------------------------------
+/*
+ * A customized grid for testing purposes
+ */
+// ----------------------------------------------------------------------
+
+class Grid
+{
+ public:
+  typedef float value_type;
+  typedef int size_type;
+  typedef double coord_type;
+
+  size_type width() const { return itsWidth; }
+  size_type height() const { return itsHeight; }
+  float operator()(size_type i, size_type j) const { return itsData[i + itsWidth * j]; }
+  float& operator()(size_type i, size_type j) { return itsData[i + itsWidth * j]; }
+  coord_type x(size_type i, size_type j) const { return 10 + 0.5 * i; }
+  coord_type y(size_type i, size_type j) const { return 60 - 0.25 * j; }
+  bool valid(size_type i, size_type j) const { return (i + j) % 3 != 0; }
+  Grid(size_type i, size_type j) : itsWidth(i), itsHeight(j), itsData(itsWidth * itsHeight, 0) {}
+
+ private:
+  Grid();
+  size_type itsWidth;
+  size_type itsHeight;
+  std::vector<float> itsData;
+};
+
+// ----------------------------------------------------------------------
+/*!
+ * Dumping and reading back a grid job
+ */
+// ----------------------------------------------------------------------
+
+void grid()
+{
+  Grid grid(4, 3);
+  for (int j = 0; j < grid.height(); j++)
+    for (int i = 0; i < grid.width(); i++)
+      grid(i, j) = 1.5f * i - j;
+
+  typedef Tron::Traits<float, double, Tron::FmiMissing> MyTraits;
+
+  stringstream buffer;
+  JobDump::write<MyTraits, Tron::LogLinearInterpolation>(
+      buffer, grid, JobDump::Mode::Fill, 0.5, 2.5);
+
+  const JobDump::Job job = JobDump::read(buffer);
+
+  if (job.kind != JobDump::Kind::Grid) TEST_FAILED("Expected a grid job");
+  if (job.mode != JobDump::Mode::Fill) TEST_FAILED("Expected a fill job");
+  if (job.width != 4 || job.height != 3) TEST_FAILED("Wrong grid size");
+  if (job.lolimit != 0.5 || job.hilimit != 2.5) TEST_FAILED("Wrong limits");
+
+  if (job.format.interpolation != JobDump::Interpolation::LogLinear)
+    TEST_FAILED("Expected loglinear interpolation");
+  if (job.format.missing != JobDump::MissingPolicy::FmiMissing)
+    TEST_FAILED("Expected FmiMissing");
+  if (job.format.value != JobDump::Type::Float) TEST_FAILED("Expected float values");
+  if (job.format.coord != JobDump::Type::Double) TEST_FAILED("Expected double coordinates");
+
+  JobDump::Grid<float, double> replay(job);
+  for (int j = 0; j < grid.height(); j++)
+    for (int i = 0; i < grid.width(); i++)
+    {
+      if (replay(i, j) != grid(i, j)) TEST_FAILED("Grid values differ");
+      if (replay.x(i, j) != grid.x(i, j) || replay.y(i, j) != grid.y(i, j))
+        TEST_FAILED("Grid coordinates differ");
+    }
+
+  for (int j = 0; j < grid.height() - 1; j++)
+    for (int i = 0; i < grid.width() - 1; i++)
+      if (replay.valid(i, j) != grid.valid(i, j)) TEST_FAILED("Cell validity differs");
+
+  // Line jobs have no upper limit
+
+  stringstream linebuffer;
+  JobDump::write<Tron::Traits<float, double, Tron::NanMissing>, Tron::LinearInterpolation>(
+      linebuffer, grid, JobDump::Mode::Line, 1.0);
+  const JobDump::Job linejob = JobDump::read(linebuffer);
+  if (linejob.mode != JobDump::Mode::Line) TEST_FAILED("Expected a line job");
+  if (linejob.lolimit != 1.0 || !std::isnan(linejob.hilimit)) TEST_FAILED("Wrong line limits");
+  if (linejob.format.interpolation != JobDump::Interpolation::Linear ||
+      linejob.format.missing != JobDump::MissingPolicy::NanMissing)
+    TEST_FAILED("Wrong line job format");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * Dumping and reading back an edge job
+ */
+// ----------------------------------------------------------------------
+
+void edges()
+{
+  typedef Tron::Traits<float, float> MyTraits;
+  typedef Tron::Edge<MyTraits> MyEdge;
+
+  std::vector<MyEdge> edges{MyEdge(0, 0, 1, 0), MyEdge(1, 0, 1, 1), MyEdge(1, 1, 0, 0)};
+
+  stringstream buffer;
+  JobDump::write_edges<MyTraits>(buffer, edges, JobDump::Mode::Line);
+
+  const JobDump::Job job = JobDump::read(buffer);
+  if (job.kind != JobDump::Kind::Edges) TEST_FAILED("Expected an edge job");
+  if (job.mode != JobDump::Mode::Line) TEST_FAILED("Expected a line job");
+  if (job.format.coord != JobDump::Type::Float) TEST_FAILED("Expected float coordinates");
+
+  const std::vector<double> ok{0, 0, 1, 0, 1, 0, 1, 1, 1, 1, 0, 0};
+  if (job.edges != ok) TEST_FAILED("Edge coordinates differ");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * Invalid input must be rejected
+ */
+// ----------------------------------------------------------------------
+
+void invalid()
+{
+  {
+    stringstream buffer("not a dump");
+    try
+    {
+      JobDump::read(buffer);
+      TEST_FAILED("Reading garbage should fail");
+    }
+    catch (std::runtime_error&)
+    {
+    }
+  }
+
+  {
+    Grid grid(4, 3);
+    stringstream full;
+    JobDump::write<Tron::Traits<float, double>, Tron::LinearInterpolation>(
+        full, grid, JobDump::Mode::Fill, 0, 1);
+    const string data = full.str();
+    stringstream buffer(data.substr(0, data.size() - 5));
+    try
+    {
+      JobDump::read(buffer);
+      TEST_FAILED("Reading a truncated dump should fail");
+    }
+    catch (std::runtime_error&)
+    {
+    }
+  }
+
+  // Huge sizes in a short stream must fail without allocating the full size
+
+  for (uint64_t size : {uint64_t(100000), uint64_t(1) << 40})
+  {
+    stringstream buffer;
+    JobDump::write_header(buffer, JobDump::Kind::Grid, JobDump::Mode::Fill, JobDump::Format());
+    JobDump::write_size(buffer, size);
+    JobDump::write_size(buffer, size);
+    JobDump::write_values(buffer, {0, 1, 2, 3, 4});
+    try
+    {
+      JobDump::read(buffer);
+      TEST_FAILED("Reading a corrupt grid size should fail");
+    }
+    catch (std::runtime_error&)
+    {
+    }
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * Sampling every N'th job
+ */
+// ----------------------------------------------------------------------
+
+void sampler()
+{
+  JobDump::Sampler never;
+  for (int i = 0; i < 10; i++)
+    if (never.sample()) TEST_FAILED("Default sampler should never sample");
+
+  JobDump::Sampler every3(3);
+  int count = 0;
+  for (int i = 0; i < 10; i++)
+    if (every3.sample()) ++count;
+  if (count != 4) TEST_FAILED("Expected 4 samples out of 10 with period 3");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test(void)
+  {
+    TEST(grid);
+    TEST(edges);
+    TEST(invalid);
+    TEST(sampler);
+  }
+};
+
+}  // namespace JobDumpTest
+
+//! The main program
+int main(void)
+{
+  using namespace std;
+  cout << endl << "JobDump" << endl << "=======" << endl;
+  JobDumpTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
@@ -0,0 +1,413 @@
+// ======================================================================
+/*!
+ * \file
+ * \brief Regression tests for Tron::MultiBandBuilder
+ */
+// ======================================================================
+
+#include "MultiBandBuilder.h"
+#include "Tron.h"
+#include <regression/tframe.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//! Protection against conflicts with global functions
+namespace MultiBandBuilderTest
+{
+typedef Tron::Traits<double, double, Tron::NanMissing> MyTraits;
+typedef Tron::MultiBandBuilder<MyTraits> MyBuilder;
+typedef Tron::Ring<MyTraits> MyRing;
+
+// ----------------------------------------------------------------------
+/*
+ * A grid whose coordinates are the grid indexes
+ */
+// ----------------------------------------------------------------------
+
+class Grid
+{
+ public:
+  typedef double value_type;
+  typedef int size_type;
+  typedef double coord_type;
+
+  Grid(size_type theWidth, size_type theHeight)
+      : itsWidth(theWidth), itsHeight(theHeight), itsData(theWidth * theHeight)
+  {
+    for (size_type j = 0; j < itsHeight; j++)
+      for (size_type i = 0; i < itsWidth; i++)
+        itsData[i + itsWidth * j] = sin(0.37 * i) * cos(0.29 * j) + 0.3 * sin(1.3 * i + 0.7 * j);
+  }
+
+  size_type width() const { return itsWidth; }
+  size_type height() const { return itsHeight; }
+  const value_type& operator()(size_type i, size_type j) const { return itsData[i + itsWidth * j]; }
+  coord_type x(size_type i, size_type j) const { return i; }
+  coord_type y(size_type i, size_type j) const { return j; }
+  bool valid(size_type i, size_type j) const { return true; }
+
+ private:
+  Grid();
+  size_type itsWidth;
+  size_type itsHeight;
+  std::vector<value_type> itsData;
+};
+
+typedef Tron::Contourer<Grid, MyBuilder, MyTraits, Tron::LinearInterpolation> MyContourer;
+
+// Bands covering all values
+void contour(MyBuilder& theBuilder, const Grid& theGrid)
+{
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  MyContourer::fill(theBuilder, theGrid, nan, -0.3);
+  MyContourer::fill(theBuilder, theGrid, -0.3, 0.3);
+  MyContourer::fill(theBuilder, theGrid, 0.3, nan);
+  theBuilder.finish();
+}
+
+// Crossing number test
+bool inside(const MyRing& theRing, double px, double py)
+{
+  bool ret = false;
+  auto prev = theRing.begin();
+  for (auto it = std::next(prev); it != theRing.end(); prev = it++)
+  {
+    if ((it->second > py) != (prev->second > py) &&
+        px < (prev->first - it->first) * (py - it->second) / (prev->second - it->second) + it->first)
+      ret = !ret;
+  }
+  return ret;
+}
+
+// Number of bands covering a point
+int coverage(const MyBuilder& theBuilder, double px, double py)
+{
+  int count = 0;
+  for (size_t band = 0; band < theBuilder.bands(); band++)
+    for (const auto& polygon : theBuilder.polygons(band))
+    {
+      if (!inside(theBuilder.ring(polygon.shell), px, py)) continue;
+      bool inhole = false;
+      for (const auto& hole : polygon.holes)
+        inhole |= inside(theBuilder.ring(hole), px, py);
+      if (!inhole) ++count;
+    }
+  return count;
+}
+
+// Vertices where the arcs join or leave the grid boundary, and the grid corners
+vector<MyRing::value_type> boundary_vertices(const MyBuilder& theBuilder)
+{
+  auto on_boundary = [](const MyRing::value_type& p)
+  { return (p.first == 0 || p.first == 39 || p.second == 0 || p.second == 29); };
+  auto corner = [](const MyRing::value_type& p)
+  { return ((p.first == 0 || p.first == 39) && (p.second == 0 || p.second == 29)); };
+  auto side = [](const MyRing::value_type& p, const MyRing::value_type& q)
+  {
+    return ((p.first == q.first && (p.first == 0 || p.first == 39)) ||
+            (p.second == q.second && (p.second == 0 || p.second == 29)));
+  };
+
+  vector<MyRing::value_type> vertices;
+  for (size_t i = 0; i < theBuilder.arcs().size(); i++)
+  {
+    const auto& arc = theBuilder.arcs().arc(i);
+    for (size_t k = 0; k < arc.size(); k++)
+    {
+      if (corner(arc[k]))
+        vertices.push_back(arc[k]);
+      if (k + 1 < arc.size() && !side(arc[k], arc[k + 1]))
+      {
+        if (on_boundary(arc[k])) vertices.push_back(arc[k]);
+        if (on_boundary(arc[k + 1])) vertices.push_back(arc[k + 1]);
+      }
+    }
+  }
+  std::sort(vertices.begin(), vertices.end());
+  vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+  return vertices;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that the bands share their arcs
+ */
+// ----------------------------------------------------------------------
+
+void shared_arcs()
+{
+  Grid grid(40, 30);
+  MyBuilder builder;
+  contour(builder, grid);
+
+  if (builder.bands() != 3) TEST_FAILED("Expected 3 bands");
+
+  // Count the references to each arc in both directions
+  const auto& table = builder.arcs();
+  vector<int> forward(table.size(), 0), backward(table.size(), 0);
+  double area = 0;
+  size_t ringpoints = 0;
+
+  for (size_t band = 0; band < builder.bands(); band++)
+    for (const auto& polygon : builder.polygons(band))
+    {
+      vector<MyBuilder::RingArcs> rings{polygon.shell};
+      rings.insert(rings.end(), polygon.holes.begin(), polygon.holes.end());
+      for (const auto& ring : rings)
+      {
+        for (auto ref : ring)
+          (MyBuilder::Table::reversed(ref) ? backward : forward)[MyBuilder::Table::index(ref)]++;
+        MyRing r = builder.ring(ring);
+        if (!r.closed()) TEST_FAILED("Ring is not closed");
+        area += r.signedArea();
+        ringpoints += r.size();
+      }
+    }
+
+  size_t arcpoints = 0;
+  int shared = 0;
+  for (size_t i = 0; i < table.size(); i++)
+  {
+    arcpoints += table.arc(i).size();
+    if (forward[i] != 1 || backward[i] > 1)
+      TEST_FAILED("Arc " + to_string(i) + " used " + to_string(forward[i]) + "+" +
+                  to_string(backward[i]) + " times");
+    shared += backward[i];
+  }
+
+  if (shared == 0) TEST_FAILED("No shared arcs found");
+  if (arcpoints >= ringpoints) TEST_FAILED("Arcs should have fewer points than the rings");
+
+  // The bands cover the grid exactly
+  if (std::abs(area - 39 * 29) > 1e-6) TEST_FAILED("Total area is " + to_string(area));
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that simplified bands have no gaps or overlaps
+ */
+// ----------------------------------------------------------------------
+
+void simplified()
+{
+  Grid grid(40, 30);
+  MyBuilder builder(0.4);
+  contour(builder, grid);
+
+  MyBuilder original;
+  contour(original, grid);
+
+  size_t points = 0, oldpoints = 0;
+  for (size_t i = 0; i < builder.arcs().size(); i++)
+    points += builder.arcs().arc(i).size();
+  for (size_t i = 0; i < original.arcs().size(); i++)
+    oldpoints += original.arcs().arc(i).size();
+
+  if (points >= oldpoints) TEST_FAILED("Nothing was simplified");
+
+  // The grid boundary is anchored, hence the whole grid is covered
+  for (double y = 0.03; y < 29; y += 0.21)
+    for (double x = 0.01; x < 39; x += 0.19)
+    {
+      int n = coverage(builder, x, y);
+      if (n != 1)
+        TEST_FAILED("Point " + to_string(x) + "," + to_string(y) + " is covered by " +
+                    to_string(n) + " bands");
+    }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that the grid boundary is kept when only one band is built
+ */
+// ----------------------------------------------------------------------
+
+void boundary()
+{
+  Grid grid(40, 30);
+  MyBuilder builder(2.0);
+  MyContourer::fill(builder, grid, -0.3, 0.3);
+  builder.finish();
+
+  MyBuilder original;
+  MyContourer::fill(original, grid, -0.3, 0.3);
+  original.finish();
+
+  // The vertices must remain, the arcs may still end up on the boundary elsewhere
+  const auto before = boundary_vertices(original);
+  if (before.empty()) TEST_FAILED("The band does not touch the grid boundary");
+
+  vector<MyRing::value_type> after;
+  for (size_t i = 0; i < builder.arcs().size(); i++)
+    after.insert(after.end(), builder.arcs().arc(i).begin(), builder.arcs().arc(i).end());
+  std::sort(after.begin(), after.end());
+
+  for (const auto& p : before)
+    if (!std::binary_search(after.begin(), after.end(), p))
+      TEST_FAILED("Boundary vertex " + to_string(p.first) + "," + to_string(p.second) +
+                  " was removed");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that a simplified arc may not cross a neighbouring arc
+ */
+// ----------------------------------------------------------------------
+
+void crossing()
+{
+  // A square with a deep notch on top, and a bar standing in the notch. Simplifying
+  // the top of the square removes the notch, which would cut through the bar.
+
+  const vector<MyRing::value_type> squarepoints{
+      {0, 0}, {0, 100}, {45, 100}, {50, 92}, {55, 100}, {100, 100}, {100, 0}, {0, 0}};
+  const vector<MyRing::value_type> barpoints{{49, 95}, {49, 105}, {51, 105}, {51, 95}, {49, 95}};
+  const MyRing::value_type tip(50, 92);
+
+  MyRing square, bar;
+  square.assign(squarepoints.begin(), squarepoints.end());
+  bar.assign(barpoints.begin(), barpoints.end());
+
+  MyBuilder::Table table;
+  table.add_vertices(square);
+  table.add_vertices(bar);
+  vector<MyBuilder::RingArcs> rings{table.split(square), table.split(bar)};
+  table.simplify(10.0, rings);
+
+  auto shell = table.ring(rings[0]);
+  if (std::find(shell.begin(), shell.end(), tip) == shell.end())
+    TEST_FAILED("The notch was removed even though the top would cross the bar");
+
+  // Without the bar the notch is removed
+
+  MyBuilder::Table alone;
+  alone.add_vertices(square);
+  vector<MyBuilder::RingArcs> ring{alone.split(square)};
+  if (alone.simplify(10.0, ring) == 0) TEST_FAILED("The square was not simplified");
+  shell = alone.ring(ring[0]);
+  if (std::find(shell.begin(), shell.end(), tip) != shell.end())
+    TEST_FAILED("The notch should be removed without the bar");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that a simplified arc may not move an island to the other band
+ */
+// ----------------------------------------------------------------------
+
+void island()
+{
+  // Two bands sharing a boundary with a spike thinner than the tolerance, and
+  // a small island inside the spike. Removing the spike would move the island
+  // to the upper band without crossing it.
+
+  const vector<MyRing::value_type> lowerpoints{
+      {0, 0}, {0, 100}, {45, 100}, {50, 104}, {55, 100}, {100, 100}, {100, 0}, {0, 0}};
+  const vector<MyRing::value_type> upperpoints{
+      {0, 100}, {0, 200}, {100, 200}, {100, 100}, {55, 100}, {50, 104}, {45, 100}, {0, 100}};
+  const vector<MyRing::value_type> islandpoints{
+      {49.5, 101}, {50, 102.5}, {50.5, 101}, {49.5, 101}};
+  const MyRing::value_type tip(50, 104);
+
+  MyRing lower, upper, isle;
+  lower.assign(lowerpoints.begin(), lowerpoints.end());
+  upper.assign(upperpoints.begin(), upperpoints.end());
+  isle.assign(islandpoints.begin(), islandpoints.end());
+
+  MyBuilder::Table table;
+  table.add_vertices(lower);
+  table.add_vertices(upper);
+  table.add_vertices(isle);
+  vector<MyBuilder::RingArcs> rings{table.split(lower), table.split(upper), table.split(isle)};
+  table.simplify(10.0, rings);
+
+  for (size_t i = 0; i < 2; i++)
+  {
+    const auto ring = table.ring(rings[i]);
+    if (std::find(ring.begin(), ring.end(), tip) == ring.end())
+      TEST_FAILED("The spike was removed even though the island would change bands");
+  }
+
+  // Without the island the spike is removed from both bands
+
+  MyBuilder::Table alone;
+  alone.add_vertices(lower);
+  alone.add_vertices(upper);
+  vector<MyBuilder::RingArcs> bands{alone.split(lower), alone.split(upper)};
+  if (alone.simplify(10.0, bands) == 0) TEST_FAILED("The boundary was not simplified");
+  for (size_t i = 0; i < 2; i++)
+  {
+    const auto ring = alone.ring(bands[i]);
+    if (std::find(ring.begin(), ring.end(), tip) != ring.end())
+      TEST_FAILED("The spike should be removed without the island");
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that isolines are not accepted
+ */
+// ----------------------------------------------------------------------
+
+void lines()
+{
+  Grid grid(10, 10);
+  MyBuilder builder;
+  try
+  {
+    MyContourer::line(builder, grid, 0.1);
+    TEST_FAILED("Line mode should throw");
+  }
+  catch (const std::runtime_error&)
+  {
+  }
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test(void)
+  {
+    TEST(shared_arcs);
+    TEST(simplified);
+    TEST(boundary);
+    TEST(crossing);
+    TEST(island);
+    TEST(lines);
+  }
+};
+
+}  // namespace MultiBandBuilderTest
+
+//! The main program
+int main(void)
+{
+  using namespace std;
+  cout << endl << "MultiBandBuilder" << endl << "================" << endl;
+  MultiBandBuilderTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
@@ -0,0 +1,183 @@
+// ======================================================================
+/*!
+ * \file
+ * \brief Regression tests for Tron::PaddedMatrix
+ */
+// ======================================================================
+
+#include "PaddedMatrix.h"
+#include "MirrorMatrix.h"
+#include <regression/tframe.h>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+template <typename T>
+string tostr(const T& value)
+{
+  ostringstream out;
+  out << value;
+  return out.str();
+}
+
+//! Protection against conflicts with global functions
+namespace PaddedMatrixTest
+{
+// ----------------------------------------------------------------------
+/*
+ * A customized grid for testing purposes
+ */
+// ----------------------------------------------------------------------
+
+class Matrix
+{
+ public:
+  typedef double value_type;
+  typedef int size_type;
+  size_type width() const { return itsWidth; }
+  size_type height() const { return itsHeight; }
+  const value_type& operator()(size_type i, size_type j) const { return itsData[i + itsWidth * j]; }
+  value_type& operator()(size_type i, size_type j) { return itsData[i + itsWidth * j]; }
+  Matrix(size_type i, size_type j)
+      : itsWidth(i), itsHeight(j), itsData(itsWidth * itsHeight, value_type())
+  {
+  }
+
+ private:
+  Matrix();
+  size_type itsWidth;
+  size_type itsHeight;
+  std::vector<value_type> itsData;
+};
+
+// ----------------------------------------------------------------------
+
+Matrix make_noise(Matrix::size_type w, Matrix::size_type h)
+{
+  Matrix grid(w, h);
+  unsigned int seed = 123456;
+  for (Matrix::size_type j = 0; j < grid.height(); j++)
+    for (Matrix::size_type i = 0; i < grid.width(); i++)
+      grid(i, j) = 1.0 * rand_r(&seed) / RAND_MAX;
+  return grid;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test equivalence with MirrorMatrix
+ */
+// ----------------------------------------------------------------------
+
+void mirror()
+{
+  Matrix grid = make_noise(10, 7);
+  Tron::MirrorMatrix<Matrix> mirrored(grid);
+
+  for (int padding : {0, 1, 3, 6})
+  {
+    Tron::PaddedMatrix<Matrix> padded(grid, padding);
+
+    if (padded.width() != 10) TEST_FAILED("Width should be 10");
+    if (padded.height() != 7) TEST_FAILED("Height should be 7");
+    if (padded.stride() != 10 + 2 * padding) TEST_FAILED("Incorrect stride");
+
+    for (int j = -padding; j < grid.height() + padding; j++)
+      for (int i = -padding; i < grid.width() + padding; i++)
+        if (padded(i, j) != mirrored(i, j))
+          TEST_FAILED("Padding " + tostr(padding) + " at " + tostr(i) + "," + tostr(j) + ": " +
+                      tostr(padded(i, j)) + " <> " + tostr(mirrored(i, j)));
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test pointer access
+ */
+// ----------------------------------------------------------------------
+
+void data()
+{
+  Matrix grid = make_noise(10, 7);
+  Tron::PaddedMatrix<Matrix> padded(grid, 4);
+
+  for (int j = -4; j < 11; j++)
+  {
+    const double* row = padded.data(-4, j);
+    for (int i = -4; i < 14; i++)
+      if (row[i + 4] != padded(i, j)) TEST_FAILED("Row access failed at " + tostr(i));
+    if (j + 1 < 11 && padded.data(0, j) + padded.stride() != padded.data(0, j + 1))
+      TEST_FAILED("Stride is not the distance between rows");
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test halos wider than the grid
+ */
+// ----------------------------------------------------------------------
+
+void wide()
+{
+  // Linear trends continue beyond one grid width
+
+  Matrix linear(4, 3);
+  for (int j = 0; j < linear.height(); j++)
+    for (int i = 0; i < linear.width(); i++)
+      linear(i, j) = 1 + 2 * i - 3 * j;
+
+  Tron::PaddedMatrix<Matrix> padded(linear, 10);
+  for (int j = -10; j < 13; j++)
+    for (int i = -10; i < 14; i++)
+      if (padded(i, j) != 1 + 2 * i - 3 * j)
+        TEST_FAILED("Value at " + tostr(i) + "," + tostr(j) + " is " + tostr(padded(i, j)));
+
+  // A single row or column is repeated
+
+  Matrix single(1, 1);
+  single(0, 0) = 5;
+  Tron::PaddedMatrix<Matrix> constant(single, 3);
+  for (int j = -3; j < 4; j++)
+    for (int i = -3; i < 4; i++)
+      if (constant(i, j) != 5)
+        TEST_FAILED("Value at " + tostr(i) + "," + tostr(j) + " is " + tostr(constant(i, j)));
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test(void)
+  {
+    TEST(mirror);
+    TEST(data);
+    TEST(wide);
+  }
+};
+
+}  // namespace PaddedMatrixTest
+
+//! The main program
+int main(void)
+{
+  using namespace std;
+  cout << endl << "PaddedMatrix" << endl << "============" << endl;
+  PaddedMatrixTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
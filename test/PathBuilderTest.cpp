@@ -0,0 +1,137 @@
+// ======================================================================
+/*!
+ * \file
+ * \brief Regression tests for Tron::PathBuilder
+ */
+// ======================================================================
+
+#include "Edge.h"
+#include "FlipSet.h"
+#include "PathBuilder.h"
+#include "Traits.h"
+#include <regression/tframe.h>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+//! Protection against conflicts with global functions
+namespace PathBuilderTest
+{
+typedef Tron::Traits<double, double> MyTraits;
+typedef Tron::Edge<MyTraits> MyEdge;
+typedef Tron::FlipSet<MyEdge> MyFlipSet;
+
+// A sink which records the path commands as SVG
+class Sink
+{
+ public:
+  void moveto(double x, double y) { itsPath << "M" << x << " " << y << " "; }
+  void lineto(double x, double y) { itsPath << "L" << x << " " << y << " "; }
+  void closepath() { itsPath << "Z "; }
+  std::string path() const { return itsPath.str(); }
+
+ private:
+  std::ostringstream itsPath;
+};
+
+// Add a closed clockwise square with the given corners, or a counter clockwise one
+void square(MyFlipSet& theFlipSet, double x1, double y1, double x2, double y2, bool cw)
+{
+  if (cw)
+  {
+    theFlipSet.flip(MyEdge(x1, y1, x1, y2));
+    theFlipSet.flip(MyEdge(x1, y2, x2, y2));
+    theFlipSet.flip(MyEdge(x2, y2, x2, y1));
+    theFlipSet.flip(MyEdge(x2, y1, x1, y1));
+  }
+  else
+  {
+    theFlipSet.flip(MyEdge(x1, y1, x2, y1));
+    theFlipSet.flip(MyEdge(x2, y1, x2, y2));
+    theFlipSet.flip(MyEdge(x2, y2, x1, y2));
+    theFlipSet.flip(MyEdge(x1, y2, x1, y1));
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test polygon output
+ */
+// ----------------------------------------------------------------------
+
+void polygons()
+{
+  MyFlipSet flipset;
+  square(flipset, 0, 0, 3, 3, true);
+  square(flipset, 1, 1, 2, 2, false);
+  square(flipset, 4, 0, 5, 1, true);
+  flipset.prepare();
+
+  Sink sink;
+  Tron::PathBuilder<Sink> builder(sink);
+  Tron::Builder::fill<MyTraits>(flipset.edges(), builder);
+
+  string result = sink.path();
+  string ok =
+      "M0 0 L0 3 L3 3 L3 0 Z "
+      "M1 1 L2 1 L2 2 L1 2 Z "
+      "M4 0 L4 1 L5 1 L5 0 Z ";
+  if (result != ok) TEST_FAILED("Expected " + ok + " got " + result);
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test line output
+ */
+// ----------------------------------------------------------------------
+
+void lines()
+{
+  MyFlipSet flipset;
+  flipset.flip(MyEdge(0, 0, 1, 0));
+  flipset.flip(MyEdge(1, 0, 2, 1));
+  square(flipset, 5, 5, 6, 6, true);
+  flipset.prepare();
+
+  Sink sink;
+  Tron::PathBuilder<Sink> builder(sink);
+  Tron::Builder::line<MyTraits>(flipset.edges(), builder);
+
+  string result = sink.path();
+  string ok = "M0 0 L1 0 L2 1 M5 5 L5 6 L6 6 L6 5 Z ";
+  if (result != ok) TEST_FAILED("Expected " + ok + " got " + result);
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test(void)
+  {
+    TEST(polygons);
+    TEST(lines);
+  }
+};
+
+}  // namespace PathBuilderTest
+
+//! The main program
+int main(void)
+{
+  using namespace std;
+  cout << endl << "PathBuilder" << endl << "===========" << endl;
+  PathBuilderTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
@@ -0,0 +1,217 @@
+// ======================================================================
+/*!
+ * \file
+ * \brief Regression tests for Tron::PeriodicGrid
+ */
+// ======================================================================
+
+#include "EdgeCollector.h"
+#include "PeriodicGrid.h"
+#include <regression/tframe.h>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+//! Protection against conflicts with global functions
+namespace PeriodicGridTest
+{
+typedef Tron::Traits<double, double, Tron::NanMissing> MyTraits;
+typedef Tron::Edge<MyTraits> MyEdge;
+typedef TronTest::EdgeCollector<MyEdge> Collector;
+}  // namespace PeriodicGridTest
+
+#include "Tron.h"
+
+using namespace std;
+
+namespace PeriodicGridTest
+{
+// ----------------------------------------------------------------------
+/*
+ * A global 10x10 degree grid, 37 columns wide repeats the first column
+ */
+// ----------------------------------------------------------------------
+
+class Grid
+{
+ public:
+  typedef double value_type;
+  typedef int size_type;
+  typedef double coord_type;
+
+  Grid(size_type theWidth, size_type theHeight)
+      : itsWidth(theWidth), itsHeight(theHeight), itsData(theWidth * theHeight)
+  {
+    for (size_type j = 0; j < itsHeight; j++)
+      for (size_type i = 0; i < itsWidth; i++)
+      {
+        const double lon = x(i % 36, j) * M_PI / 180;
+        itsData[i + itsWidth * j] = sin(lon) * cos(0.4 * j) + 0.3 * cos(3 * lon + 0.7 * j);
+      }
+  }
+
+  size_type width() const { return itsWidth; }
+  size_type height() const { return itsHeight; }
+  const value_type& operator()(size_type i, size_type j) const { return itsData[i + itsWidth * j]; }
+  coord_type x(size_type i, size_type j) const
+  {
+    return (i == itsMissingColumn ? std::numeric_limits<double>::quiet_NaN() : 10.0 * i - 180);
+  }
+  coord_type y(size_type i, size_type j) const { return 10.0 * j - 60; }
+  bool valid(size_type i, size_type j) const { return i != itsInvalidColumn; }
+
+  // Invalidate the cells starting at the column
+  void invalidate(size_type theColumn) { itsInvalidColumn = theColumn; }
+
+  // Remove the coordinates of the column
+  void remove(size_type theColumn) { itsMissingColumn = theColumn; }
+
+ private:
+  Grid();
+  size_type itsWidth;
+  size_type itsHeight;
+  size_type itsInvalidColumn = -1;
+  size_type itsMissingColumn = -1;
+  std::vector<value_type> itsData;
+};
+
+typedef Tron::PeriodicGrid<Grid> MyPeriodicGrid;
+typedef Tron::Contourer<Grid, Collector, MyTraits, Tron::LinearInterpolation> MyContourer;
+typedef Tron::Contourer<MyPeriodicGrid, Collector, MyTraits, Tron::LinearInterpolation>
+    PeriodicContourer;
+
+const double nan = std::numeric_limits<double>::quiet_NaN();
+
+// Shoelace formula over closed rings
+double area(const Collector& theCollector)
+{
+  double sum = 0;
+  for (const auto& edge : theCollector.edges)
+    sum += edge.x1() * edge.y2() - edge.x2() * edge.y1();
+  return std::abs(sum / 2);
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test the adapter interface
+ */
+// ----------------------------------------------------------------------
+
+void adapter()
+{
+  Grid grid(36, 13);
+  MyPeriodicGrid wrapped(grid, 360);
+
+  if (wrapped.width() != 37) TEST_FAILED("Width should be 37");
+  if (wrapped.height() != 13) TEST_FAILED("Height should be 13");
+  if (wrapped.x(36, 5) != 180) TEST_FAILED("Wrapped x should be 180");
+  if (wrapped.y(36, 5) != grid.y(0, 5)) TEST_FAILED("Wrapped y should equal the first column");
+  if (wrapped(36, 5) != grid(0, 5)) TEST_FAILED("Wrapped value should equal the first column");
+  if (wrapped(35, 5) != grid(35, 5)) TEST_FAILED("Other values should not change");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that wrapping equals repeating the first column
+ */
+// ----------------------------------------------------------------------
+
+void contour()
+{
+  Grid grid(36, 13);
+  Grid repeated(37, 13);
+  MyPeriodicGrid wrapped(grid, 360);
+
+  Collector result, expected;
+  PeriodicContourer::fill(result, wrapped, -0.2, 0.4);
+  MyContourer::fill(expected, repeated, -0.2, 0.4);
+  if (expected.edges.empty()) TEST_FAILED("No edges were produced");
+  if (!same(result, expected)) TEST_FAILED("Fill edges differ");
+
+  result.edges.clear();
+  expected.edges.clear();
+  PeriodicContourer::line(result, wrapped, 0.1);
+  MyContourer::line(expected, repeated, 0.1);
+  if (expected.edges.empty()) TEST_FAILED("No line edges were produced");
+  if (!same(result, expected)) TEST_FAILED("Line edges differ");
+
+  // The bands cover the full globe instead of leaving a gap
+
+  Collector all, open;
+  PeriodicContourer::fill(all, wrapped, nan, nan);
+  MyContourer::fill(open, grid, nan, nan);
+  if (std::abs(area(all) - 360 * 120) > 1e-6) TEST_FAILED("Area is " + to_string(area(all)));
+  if (std::abs(area(open) - 350 * 120) > 1e-6) TEST_FAILED("Area is " + to_string(area(open)));
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test the validity of the wrap cells
+ */
+// ----------------------------------------------------------------------
+
+void validity()
+{
+  Grid grid(36, 13);
+  MyPeriodicGrid wrapped(grid, 360);
+  if (!wrapped.valid(35, 0)) TEST_FAILED("Wrap cell should be valid");
+
+  // The wrap cell does not depend on the second to last column
+
+  grid.invalidate(34);
+  if (!wrapped.valid(35, 0)) TEST_FAILED("Wrap cell should be valid next to an invalid column");
+
+  Collector all;
+  PeriodicContourer::fill(all, wrapped, nan, nan);
+  if (std::abs(area(all) - 350 * 120) > 1e-6) TEST_FAILED("Area is " + to_string(area(all)));
+
+  // Missing corner coordinates invalidate the wrap cell
+
+  grid.remove(0);
+  if (wrapped.valid(35, 0)) TEST_FAILED("Wrap cell should be invalid without coordinates");
+
+  // The caller may decide
+
+  Grid other(36, 13);
+  MyPeriodicGrid predicate(other, 360, [](int j) { return j != 5; });
+  if (!predicate.valid(35, 4)) TEST_FAILED("Wrap cell on row 4 should be valid");
+  if (predicate.valid(35, 5)) TEST_FAILED("Wrap cell on row 5 should be invalid");
+  if (!predicate.valid(34, 5)) TEST_FAILED("Other cells should not be affected");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test(void)
+  {
+    TEST(adapter);
+    TEST(contour);
+    TEST(validity);
+  }
+};
+
+}  // namespace PeriodicGridTest
+
+//! The main program
+int main(void)
+{
+  using namespace std;
+  cout << endl << "PeriodicGrid" << endl << "============" << endl;
+  PeriodicGridTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
@@ -0,0 +1,213 @@
+// ======================================================================
+/*!
+ * \file
+ * \brief Regression tests for Tron::Rasterizer
+ */
+// ======================================================================
+
+#include "FlatBuilder.h"
+#include "Rasterizer.h"
+#include "Tron.h"
+#include <regression/tframe.h>
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//! Protection against conflicts with global functions
+namespace RasterizerTest
+{
+typedef Tron::Traits<double, double, Tron::NanMissing> MyTraits;
+
+// ----------------------------------------------------------------------
+/*
+ * A grid whose coordinates are the grid indexes
+ */
+// ----------------------------------------------------------------------
+
+class Grid
+{
+ public:
+  typedef double value_type;
+  typedef int size_type;
+  typedef double coord_type;
+
+  Grid(size_type theWidth, size_type theHeight)
+      : itsWidth(theWidth), itsHeight(theHeight), itsData(theWidth * theHeight)
+  {
+    for (size_type j = 0; j < itsHeight; j++)
+      for (size_type i = 0; i < itsWidth; i++)
+        itsData[i + itsWidth * j] = sin(0.77 * i) * cos(0.59 * j) + 0.3 * sin(1.3 * i + 0.7 * j);
+  }
+
+  size_type width() const { return itsWidth; }
+  size_type height() const { return itsHeight; }
+  const value_type& operator()(size_type i, size_type j) const { return itsData[i + itsWidth * j]; }
+  value_type& operator()(size_type i, size_type j) { return itsData[i + itsWidth * j]; }
+  coord_type x(size_type i, size_type j) const { return i; }
+  coord_type y(size_type i, size_type j) const { return j; }
+  bool valid(size_type i, size_type j) const { return true; }
+
+ private:
+  Grid();
+  size_type itsWidth;
+  size_type itsHeight;
+  std::vector<value_type> itsData;
+};
+
+typedef Tron::Rasterizer<Grid, MyTraits> MyRasterizer;
+
+// Crossing number test for a ring in the flat coordinate array
+bool inside_ring(const vector<double>& c, int begin, int end, double px, double py)
+{
+  bool ret = false;
+  for (int k = begin, m = end - 1; k < end; m = k++)
+  {
+    const double xk = c[2 * k], yk = c[2 * k + 1], xm = c[2 * m], ym = c[2 * m + 1];
+    if ((yk > py) != (ym > py) && px < (xm - xk) * (py - yk) / (ym - yk) + xk) ret = !ret;
+  }
+  return ret;
+}
+
+// Band of a point according to the vector output, 0 if none
+int vector_class(const Tron::FlatBuilder& theBuilder, double px, double py)
+{
+  const auto& bands = theBuilder.band_offsets();
+  const auto& polygons = theBuilder.polygon_offsets();
+  const auto& rings = theBuilder.ring_offsets();
+
+  for (size_t b = 0; b + 1 < bands.size(); b++)
+    for (int p = bands[b]; p < bands[b + 1]; p++)
+    {
+      bool inside = false;
+      // The closing point is not needed for the test
+      for (int r = polygons[p]; r < polygons[p + 1]; r++)
+        if (inside_ring(theBuilder.coords(), rings[r], rings[r + 1] - 1, px, py)) inside = !inside;
+      if (inside) return b + 1;
+    }
+  return 0;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Pixels must agree with the vector output
+ */
+// ----------------------------------------------------------------------
+
+void classify()
+{
+  Grid grid(30, 20);
+  grid(15, 1) = NAN;
+  grid(20, 6) = NAN;
+  grid(21, 6) = NAN;
+
+  const vector<double> limits{-1.5, -1, -0.5, 0, 0.25, 0.5, 1, 1.5};
+
+  typedef Tron::Contourer<Grid, Tron::FlatBuilder, MyTraits, Tron::LinearInterpolation>
+      MyContourer;
+
+  Tron::FlatBuilder builder;
+  for (size_t k = 0; k + 1 < limits.size(); k++)
+    MyContourer::fill(builder, grid, limits[k], limits[k + 1]);
+
+  // Sample points irregularly to avoid hitting grid points exactly
+
+  int mismatches = 0;
+  for (int n = 0; n < 20000; n++)
+  {
+    const double x = fmod(n * 0.618034 * 29, 29.0);
+    const double y = fmod(n * 0.414214 * 19, 19.0);
+    if (MyRasterizer::classify(grid, limits, x, y) != vector_class(builder, x, y)) ++mismatches;
+  }
+
+  if (mismatches > 0)
+    TEST_FAILED(to_string(mismatches) + " pixels do not match the vector output");
+
+  // Outside the grid
+
+  if (MyRasterizer::classify(grid, limits, -0.1, 5) != 0)
+    TEST_FAILED("Points outside the grid should not be classified");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Cells whose corners are below and above all the bands
+ */
+// ----------------------------------------------------------------------
+
+void straddle()
+{
+  Grid grid(2, 2);
+  grid(0, 0) = -5;
+  grid(1, 0) = -5;
+  grid(0, 1) = 5;
+  grid(1, 1) = 5;
+
+  const vector<double> limits{0, 1};
+
+  // The band is at 0.5 <= y < 0.6
+  if (MyRasterizer::classify(grid, limits, 0.5, 0.55) != 1)
+    TEST_FAILED("Point inside the band should be in band 0");
+  if (MyRasterizer::classify(grid, limits, 0.5, 0.25) != 0)
+    TEST_FAILED("Point below the band should not be classified");
+  if (MyRasterizer::classify(grid, limits, 0.5, 0.75) != 0)
+    TEST_FAILED("Point above the band should not be classified");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief The result must not depend on the number of threads
+ */
+// ----------------------------------------------------------------------
+
+void threads()
+{
+  Grid grid(30, 20);
+  const vector<double> limits{-1, 0, 1};
+
+  // Flip the image vertically so that row 0 is at the top
+  Tron::AffineTransform transform(0, 29.0 / 300, 0, 19, 0, -19.0 / 200);
+
+  auto image1 = MyRasterizer::fill(grid, limits, 300, 200, transform, 1);
+  auto image4 = MyRasterizer::fill(grid, limits, 300, 200, transform, 4);
+
+  if (image1.size() != 300 * 200) TEST_FAILED("Wrong image size");
+  if (image1 != image4) TEST_FAILED("Results differ with 1 and 4 threads");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test(void)
+  {
+    TEST(classify);
+    TEST(straddle);
+    TEST(threads);
+  }
+};
+
+}  // namespace RasterizerTest
+
+//! The main program
+int main(void)
+{
+  using namespace std;
+  cout << endl << "Rasterizer" << endl << "==========" << endl;
+  RasterizerTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
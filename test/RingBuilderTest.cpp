@@ -0,0 +1,162 @@
+// ======================================================================
+/*!
+ * \file
+ * \brief Regression tests for the ring assembly utilities
+ */
+// ======================================================================
+
+#include "Edge.h"
+#include "FlipSet.h"
+#include "RingBuilder.h"
+#include "Traits.h"
+#include <regression/tframe.h>
+#include <string>
+
+using namespace std;
+
+//! Protection against conflicts with global functions
+namespace RingBuilderTest
+{
+typedef Tron::Traits<double, double> MyTraits;
+typedef Tron::Edge<MyTraits> MyEdge;
+typedef Tron::FlipSet<MyEdge> MyFlipSet;
+
+// Add a closed clockwise square with the given corners, or a counter clockwise one
+void square(MyFlipSet& theFlipSet, double x1, double y1, double x2, double y2, bool cw)
+{
+  if (cw)
+  {
+    theFlipSet.flip(MyEdge(x1, y1, x1, y2));
+    theFlipSet.flip(MyEdge(x1, y2, x2, y2));
+    theFlipSet.flip(MyEdge(x2, y2, x2, y1));
+    theFlipSet.flip(MyEdge(x2, y1, x1, y1));
+  }
+  else
+  {
+    theFlipSet.flip(MyEdge(x1, y1, x2, y1));
+    theFlipSet.flip(MyEdge(x2, y1, x2, y2));
+    theFlipSet.flip(MyEdge(x2, y2, x1, y2));
+    theFlipSet.flip(MyEdge(x1, y2, x1, y1));
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test assigning holes to shells
+ */
+// ----------------------------------------------------------------------
+
+void holes()
+{
+  MyFlipSet flipset;
+  square(flipset, 0, 0, 10, 10, true);
+  square(flipset, 1, 1, 2, 2, false);
+  square(flipset, 4, 4, 8, 8, false);
+  square(flipset, 20, 0, 21, 1, true);
+  flipset.prepare();
+
+  Tron::RingAssembly<MyTraits> assembly;
+  Tron::build_rings(flipset.edges(), assembly);
+  if (assembly.polylines.size() != 4) TEST_FAILED("Expected 4 rings");
+
+  auto holeshells = Tron::assign_holes(flipset.edges(), assembly);
+  if (holeshells.size() != 2) TEST_FAILED("Expected 2 holes");
+
+  auto polygons = Tron::collect_polygons(assembly.polylines, holeshells);
+  if (polygons.size() != 2) TEST_FAILED("Expected 2 polygons");
+  if (polygons[0].holes.size() != 2) TEST_FAILED("Expected 2 holes in the first polygon");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test removing small rings
+ */
+// ----------------------------------------------------------------------
+
+void small_rings()
+{
+  MyFlipSet flipset;
+  square(flipset, 0, 0, 10, 10, true);
+  square(flipset, 1, 1, 2, 2, false);   // small hole
+  square(flipset, 4, 4, 8, 8, false);   // large hole
+  square(flipset, 20, 0, 21, 1, true);  // small shell
+  square(flipset, 30, 0, 33, 3, true);  // small shell with a hole
+  square(flipset, 31, 1, 32, 2, false);
+  flipset.prepare();
+
+  Tron::RingAssembly<MyTraits> assembly;
+  Tron::build_rings(flipset.edges(), assembly);
+
+  auto removed = Tron::remove_small_rings(assembly, 10, 0);
+  if (removed != 4) TEST_FAILED("Expected 4 removed rings, got " + to_string(removed));
+
+  auto holeshells = Tron::assign_holes(flipset.edges(), assembly);
+  auto polygons = Tron::collect_polygons(assembly.polylines, holeshells);
+
+  if (polygons.size() != 1) TEST_FAILED("Expected 1 polygon, got " + to_string(polygons.size()));
+  if (polygons[0].holes.size() != 1) TEST_FAILED("Expected 1 hole");
+  if (assembly.polylines[polygons[0].holes[0]].signedArea() != -16)
+    TEST_FAILED("The large hole should remain");
+
+  // Vertex counts
+  Tron::RingAssembly<MyTraits> assembly2;
+  Tron::build_rings(flipset.edges(), assembly2);
+  removed = Tron::remove_small_rings(assembly2, 0, 5);
+  if (removed != 6) TEST_FAILED("All squares have only 4 vertices");
+
+  // A hole with enough vertices is dropped with its shell
+  MyFlipSet flipset2;
+  square(flipset2, 0, 0, 10, 10, true);
+  flipset2.flip(MyEdge(2, 2, 5, 2));
+  flipset2.flip(MyEdge(5, 2, 8, 2));
+  flipset2.flip(MyEdge(8, 2, 8, 5));
+  flipset2.flip(MyEdge(8, 5, 8, 8));
+  flipset2.flip(MyEdge(8, 8, 5, 8));
+  flipset2.flip(MyEdge(5, 8, 2, 8));
+  flipset2.flip(MyEdge(2, 8, 2, 5));
+  flipset2.flip(MyEdge(2, 5, 2, 2));
+  flipset2.prepare();
+
+  Tron::RingAssembly<MyTraits> assembly3;
+  Tron::build_rings(flipset2.edges(), assembly3);
+  removed = Tron::remove_small_rings(assembly3, 0, 5);
+  if (removed != 1) TEST_FAILED("Only the shell should be removed");
+
+  holeshells = Tron::assign_holes(flipset2.edges(), assembly3);
+  if (!holeshells.empty()) TEST_FAILED("The hole should be dropped with its shell");
+  polygons = Tron::collect_polygons(assembly3.polylines, holeshells);
+  if (!polygons.empty()) TEST_FAILED("No polygons should remain");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test(void)
+  {
+    TEST(holes);
+    TEST(small_rings);
+  }
+};
+
+}  // namespace RingBuilderTest
+
+//! The main program
+int main(void)
+{
+  using namespace std;
+  cout << endl << "RingBuilder" << endl << "===========" << endl;
+  RingBuilderTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
@@ -426,6 +426,226 @@ void smooth_6_4()
   TEST_PASSED();
 }
 
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test all smoothers against a direct convolution
+ */
+// ----------------------------------------------------------------------
+
+void reference()
+{
+  using namespace Tron::SavitzkyGolay2DCoefficients;
+
+  Matrix original = add_noise(make_matrix(40, 30));
+  original(17, 11) = NAN;
+  Tron::MirrorMatrix<Matrix> mirror(original);
+
+  for (int length = 1; length <= 6; length++)
+    for (int degree = 1; degree <= 5; degree++)
+    {
+      const int* factor = coeffs[length - 1][degree - 1];
+      if (factor == nullptr) continue;
+
+      Matrix grid = original;
+      Tron::SavitzkyGolay2D::smooth(grid, length, degree);
+
+      const int n = 2 * length + 1;
+      for (int jj = 0; jj < grid.height(); jj++)
+        for (int ii = 0; ii < grid.width(); ii++)
+        {
+          double sum = 0;
+          for (int j = 0; j < n; j++)
+            for (int i = 0; i < n; i++)
+              sum += factor[j * n + i] * mirror(ii + i - length, jj + j - length);
+          const double expected =
+              (std::isnan(sum) ? original(ii, jj) : sum / denoms[length - 1][degree - 1]);
+          const double value = grid(ii, jj);
+
+          if (std::isnan(expected) != std::isnan(value) ||
+              (!std::isnan(expected) && std::abs(expected - value) > 1e-5))
+            TEST_FAILED("Length " + tostr(length) + " degree " + tostr(degree) + " at " +
+                        tostr(ii) + "," + tostr(jj) + ": " + tostr(value) + " <> " +
+                        tostr(expected));
+        }
+    }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that threaded smoothing equals serial smoothing
+ */
+// ----------------------------------------------------------------------
+
+void threads()
+{
+  Matrix original = add_noise(make_matrix(123, 77));
+  original(60, 40) = NAN;
+
+  for (int length : {1, 3, 6})
+  {
+    Matrix expected = original;
+    Tron::SavitzkyGolay2D::smooth(expected, length, 2);
+
+    for (unsigned int threads : {0U, 2U, 3U, 8U, 100U})
+    {
+      Matrix grid = original;
+      Tron::SavitzkyGolay2D::smooth(grid, length, 2, threads);
+
+      for (int j = 0; j < grid.height(); j++)
+        for (int i = 0; i < grid.width(); i++)
+        {
+          const float a = grid(i, j);
+          const float b = expected(i, j);
+          if (!(a == b || (std::isnan(a) && std::isnan(b))))
+            TEST_FAILED("Length " + tostr(length) + " with " + tostr(threads) + " threads at " +
+                        tostr(i) + "," + tostr(j) + ": " + tostr(a) + " <> " + tostr(b));
+        }
+    }
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that rolling smoothing equals smoothing from a full copy
+ */
+// ----------------------------------------------------------------------
+
+void rolling()
+{
+  using namespace Tron::SavitzkyGolay2DCoefficients;
+
+  Matrix large = add_noise(make_matrix(40, 30));
+  large(17, 11) = NAN;
+  Matrix narrow = add_noise(make_matrix(9, 20));
+
+  for (const Matrix* original : {&large, &narrow})
+    for (int length = 1; length <= 6; length++)
+      for (int degree = 1; degree <= 5; degree++)
+      {
+        if (coeffs[length - 1][degree - 1] == nullptr) continue;
+
+        Matrix expected = *original;
+        Tron::SavitzkyGolay2D::smooth(expected, length, degree);
+        Matrix grid = *original;
+        Tron::SavitzkyGolay2D::smooth_rolling(grid, length, degree);
+
+        for (int j = 0; j < grid.height(); j++)
+          for (int i = 0; i < grid.width(); i++)
+          {
+            const float a = grid(i, j);
+            const float b = expected(i, j);
+            if (!(a == b || (std::isnan(a) && std::isnan(b))))
+              TEST_FAILED("Length " + tostr(length) + " degree " + tostr(degree) + " at " +
+                          tostr(i) + "," + tostr(j) + ": " + tostr(a) + " <> " + tostr(b));
+          }
+      }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test normalized smoothing against a direct convolution
+ */
+// ----------------------------------------------------------------------
+
+void normalized()
+{
+  using namespace Tron::SavitzkyGolay2DCoefficients;
+
+  // A missing block, a single missing value and a missing border pixel
+  Matrix original = add_noise(make_matrix(40, 30));
+  for (int j = 10; j < 14; j++)
+    for (int i = 20; i < 25; i++)
+      original(i, j) = NAN;
+  original(5, 20) = NAN;
+  original(0, 3) = NAN;
+  Tron::MirrorMatrix<Matrix> mirror(original);
+
+  for (int length = 1; length <= 6; length++)
+    for (int degree = 1; degree <= 5; degree++)
+    {
+      const int* factor = coeffs[length - 1][degree - 1];
+      if (factor == nullptr) continue;
+
+      Matrix grid = original;
+      Tron::SavitzkyGolay2D::smooth_normalized(grid, length, degree);
+
+      const double denom = denoms[length - 1][degree - 1];
+      const int n = 2 * length + 1;
+      for (int jj = 0; jj < grid.height(); jj++)
+        for (int ii = 0; ii < grid.width(); ii++)
+        {
+          double sum = 0;
+          double weight = 0;
+          for (int j = 0; j < n; j++)
+            for (int i = 0; i < n; i++)
+            {
+              // Mirrored values are NaN if any of their sources is missing
+              const double value = mirror(ii + i - length, jj + j - length);
+              if (!std::isnan(value))
+              {
+                sum += factor[j * n + i] / denom * value;
+                weight += factor[j * n + i] / denom;
+              }
+            }
+          double expected = original(ii, jj);
+          if (!std::isnan(expected) && weight >= 0.5) expected = sum / weight;
+          const double value = grid(ii, jj);
+
+          if (std::isnan(expected) != std::isnan(value) ||
+              (!std::isnan(expected) && std::abs(expected - value) > 1e-4))
+            TEST_FAILED("Length " + tostr(length) + " degree " + tostr(degree) + " at " +
+                        tostr(ii) + "," + tostr(jj) + ": " + tostr(value) + " <> " +
+                        tostr(expected));
+        }
+    }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test normalized smoothing with other missing value policies
+ */
+// ----------------------------------------------------------------------
+
+void normalized_policy()
+{
+  // Constant fields stay constant, missing values stay missing
+
+  Matrix constant(30, 20);
+  for (int j = 0; j < constant.height(); j++)
+    for (int i = 0; i < constant.width(); i++)
+      constant(i, j) = (i % 7 == 3 && j % 5 == 2 ? 32700 : 5);
+
+  Matrix grid = constant;
+  Tron::SavitzkyGolay2D::smooth_normalized<Tron::FmiMissing>(grid, 3, 2);
+  for (int j = 0; j < grid.height(); j++)
+    for (int i = 0; i < grid.width(); i++)
+      if (std::abs(grid(i, j) - constant(i, j)) > 1e-4)
+        TEST_FAILED("Value at " + tostr(i) + "," + tostr(j) + " is " + tostr(grid(i, j)));
+
+  // Without missing values the result equals the plain smoother
+
+  Matrix original = add_noise(make_matrix(40, 30));
+  Matrix expected = original;
+  Tron::SavitzkyGolay2D::smooth(expected, 3, 2);
+  grid = original;
+  Tron::SavitzkyGolay2D::smooth_normalized<Tron::NotMissing>(grid, 3, 2);
+  for (int j = 0; j < grid.height(); j++)
+    for (int i = 0; i < grid.width(); i++)
+      if (std::abs(grid(i, j) - expected(i, j)) > 1e-5)
+        TEST_FAILED("Value at " + tostr(i) + "," + tostr(j) + " is " + tostr(grid(i, j)) +
+                    " instead of " + tostr(expected(i, j)));
+
+  TEST_PASSED();
+}
+
 // ----------------------------------------------------------------------
 /*!
  * The actual test suite
@@ -454,6 +674,11 @@ class tests : public tframe::tests
     TEST(smooth_6_1);
     TEST(smooth_6_2);
     TEST(smooth_6_4);
+    TEST(reference);
+    TEST(threads);
+    TEST(rolling);
+    TEST(normalized);
+    TEST(normalized_policy);
   }
 };
 
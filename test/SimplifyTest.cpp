@@ -0,0 +1,316 @@
+// ======================================================================
+/*!
+ * \file
+ * \brief Regression tests for Tron::Simplifier
+ */
+// ======================================================================
+
+#include "Edge.h"
+#include "Ring.h"
+#include "Simplify.h"
+#include "Traits.h"
+#include <regression/tframe.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//! Protection against conflicts with global functions
+namespace SimplifyTest
+{
+typedef Tron::Traits<double, double> MyTraits;
+typedef Tron::Edge<MyTraits> MyEdge;
+typedef Tron::Ring<MyTraits> MyRing;
+typedef Tron::Simplifier<MyTraits> MySimplifier;
+typedef MySimplifier::Points Points;
+
+MyRing make_ring(const Points& thePoints)
+{
+  MyRing ring;
+  ring.assign(thePoints.begin(), thePoints.end());
+  return ring;
+}
+
+// The sorted edges of a ring or polyline
+vector<MyEdge> make_edges(const Points& thePoints)
+{
+  vector<MyEdge> edges;
+  for (size_t i = 1; i < thePoints.size(); i++)
+    edges.emplace_back(
+        thePoints[i - 1].first, thePoints[i - 1].second, thePoints[i].first, thePoints[i].second);
+  sort(edges.begin(), edges.end());
+  return edges;
+}
+
+// A clockwise wobbly circle
+Points circle(int n, double radius)
+{
+  Points points;
+  for (int i = 0; i < n; i++)
+  {
+    double angle = -2 * M_PI * i / n;
+    double r = radius + 0.01 * ((i % 2) ? 1 : -1);
+    points.emplace_back(r * cos(angle), r * sin(angle));
+  }
+  points.push_back(points.front());
+  return points;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that zero tolerance changes nothing
+ */
+// ----------------------------------------------------------------------
+
+void zero_tolerance()
+{
+  Points points = circle(50, 10);
+  MyRing ring = make_ring(points);
+  MySimplifier simplifier(make_edges(points), 0);
+  if (simplifier.simplify(ring)) TEST_FAILED("Zero tolerance should not modify the ring");
+  if (ring.size() != points.size()) TEST_FAILED("Ring size changed");
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test closed ring simplification
+ */
+// ----------------------------------------------------------------------
+
+void rings()
+{
+  Points points = circle(200, 10);
+  MyRing ring = make_ring(points);
+  MySimplifier simplifier(make_edges(points), 0.1);
+  if (!simplifier.simplify(ring)) TEST_FAILED("Circle was not simplified");
+  if (!ring.closed()) TEST_FAILED("Simplified ring is not closed");
+  if (ring.size() >= points.size() / 2)
+    TEST_FAILED("Too little simplification: " + to_string(ring.size()) + " points left");
+  if (!ring.isClockWise()) TEST_FAILED("Orientation changed");
+  if (!MySimplifier::is_simple(Points(ring.begin(), ring.end()), true))
+    TEST_FAILED("Simplified ring is not simple");
+
+  // The error must be within the tolerance
+  for (const auto& point : ring)
+  {
+    double r = hypot(point.first, point.second);
+    if (abs(r - 10) > 0.11) TEST_FAILED("Point too far from the circle");
+  }
+
+  // Huge tolerances may not collapse the ring
+  MyRing ring2 = make_ring(points);
+  MySimplifier simplifier2(make_edges(points), 100);
+  simplifier2.simplify(ring2);
+  if (ring2.size() < 4) TEST_FAILED("Ring collapsed to " + to_string(ring2.size()) + " points");
+  if (!ring2.isClockWise()) TEST_FAILED("Orientation changed with huge tolerance");
+
+  // Nothing can be removed from a diamond
+  Points diamond{{0, 1}, {1, 2}, {2, 1}, {1, 0}, {0, 1}};
+  MyRing ring3 = make_ring(diamond);
+  MySimplifier simplifier3(make_edges(diamond), 100);
+  if (simplifier3.simplify(ring3)) TEST_FAILED("Diamond should not be simplified");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test polyline simplification
+ */
+// ----------------------------------------------------------------------
+
+void polylines()
+{
+  Points points{{0, 0}, {1, 0.01}, {2, -0.01}, {3, 0}, {4, 2}, {5, 2.01}, {6, 2}};
+  MyRing line = make_ring(points);
+  MySimplifier simplifier(make_edges(points), 0.1);
+  simplifier.simplify(line);
+
+  string result = line.asText(0);
+  string ok = "0 0,3 0,4 2,6 2";
+  if (result != ok) TEST_FAILED("Expected " + ok + " got " + result);
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that vertices on the bounding box are kept
+ */
+// ----------------------------------------------------------------------
+
+void anchors()
+{
+  // A band touching the bottom side y=0 between x=2 and x=8, the
+  // isoline makes a shallow arc above it.
+  Points points{{2, 0}, {3, 1}, {5, 1.05}, {7, 1}, {8, 0}, {6, 0}, {4, 0}, {2, 0}};
+  MyRing ring = make_ring(points);
+  MySimplifier simplifier(make_edges(points), 10);
+  simplifier.simplify(ring);
+
+  // The boundary points are anchors, the duplicate boundary vertices are not
+  bool has2 = false, has8 = false;
+  for (const auto& point : ring)
+  {
+    has2 |= (point == make_pair(2.0, 0.0));
+    has8 |= (point == make_pair(8.0, 0.0));
+  }
+  if (!has2 || !has8) TEST_FAILED("Boundary vertices removed: " + ring.asText(2));
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that the result does not depend on the direction
+ */
+// ----------------------------------------------------------------------
+
+void direction()
+{
+  Points points;
+  for (int i = 0; i <= 100; i++)
+    points.emplace_back(i, sin(i / 5.0) + 0.001 * (i % 3));
+
+  Points reversed(points.rbegin(), points.rend());
+
+  MyRing line1 = make_ring(points);
+  MyRing line2 = make_ring(reversed);
+  MySimplifier(make_edges(points), 0.05).simplify(line1);
+  MySimplifier(make_edges(reversed), 0.05).simplify(line2);
+
+  Points result1(line1.begin(), line1.end());
+  Points result2(line2.begin(), line2.end());
+  reverse(result2.begin(), result2.end());
+
+  if (result1 != result2)
+    TEST_FAILED("Different results: " + line1.asText(2) + " vs " + line2.asText(2));
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test self intersection detection
+ */
+// ----------------------------------------------------------------------
+
+void simple()
+{
+  Points square{{0, 0}, {0, 1}, {1, 1}, {1, 0}, {0, 0}};
+  if (!MySimplifier::is_simple(square, true)) TEST_FAILED("Square should be simple");
+
+  Points bowtie{{0, 0}, {1, 1}, {1, 0}, {0, 1}, {0, 0}};
+  if (MySimplifier::is_simple(bowtie, true)) TEST_FAILED("Bowtie should not be simple");
+
+  Points spike{{0, 0}, {2, 0}, {1, 0}, {1, 1}};
+  if (MySimplifier::is_simple(spike, false)) TEST_FAILED("Spike should not be simple");
+
+  Points touch{{0, 0}, {2, 0}, {2, 2}, {1, 0}};
+  if (MySimplifier::is_simple(touch, false)) TEST_FAILED("Self touch should not be simple");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that simplified shells and holes may not intersect
+ */
+// ----------------------------------------------------------------------
+
+void holes()
+{
+  // An octagonal hole whose corners are closer to the shell than the tolerance
+  Points shell = circle(40, 10);
+  Points hole;
+  for (int i = 0; i <= 8; i++)
+    hole.emplace_back(9.5 * cos(M_PI * (i + 0.5) / 4), 9.5 * sin(M_PI * (i + 0.5) / 4));
+
+  vector<MyRing> rings{make_ring(shell), make_ring(hole)};
+  Points all = shell;
+  all.insert(all.end(), hole.begin(), hole.end());
+  MySimplifier simplifier(make_edges(all), 1);
+  simplifier.simplify(rings);
+
+  vector<Tron::SimplifyDetail::Segment<MyRing::value_type>> segments;
+  for (size_t i = 0; i < rings.size(); i++)
+    for (auto it = rings[i].begin(), next = std::next(it); next != rings[i].end(); it = next++)
+      segments.push_back({*it, *next, i});
+  const auto crossing = Tron::SimplifyDetail::crossings(segments, vector<char>(rings.size(), 1));
+  if (crossing[0] || crossing[1]) TEST_FAILED("The simplified shell and hole intersect");
+
+  // Each ring alone is simplified
+
+  vector<MyRing> alone{make_ring(shell)};
+  if (MySimplifier(make_edges(shell), 1).simplify(alone) != 1)
+    TEST_FAILED("The shell alone should be simplified");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that a simplified shell may not leave its hole outside
+ */
+// ----------------------------------------------------------------------
+
+void containment()
+{
+  // The hole is inside the spike of the shell, which is thinner than the tolerance
+  Points shell{{0, 0}, {0, 10}, {4, 10}, {5, 10.4}, {6, 10}, {10, 10}, {10, 0}, {0, 0}};
+  Points hole{{4.9, 10.1}, {5.1, 10.1}, {5, 10.25}, {4.9, 10.1}};
+
+  vector<MyRing> rings{make_ring(shell), make_ring(hole)};
+  Points all = shell;
+  all.insert(all.end(), hole.begin(), hole.end());
+  MySimplifier simplifier(make_edges(all), 1);
+  if (simplifier.simplify(rings) != 0) TEST_FAILED("Nothing should remain simplified");
+  if (Points(rings[0].begin(), rings[0].end()) != shell) TEST_FAILED("The shell was not restored");
+
+  // The shell alone loses the spike
+
+  vector<MyRing> alone{make_ring(shell)};
+  if (MySimplifier(make_edges(shell), 1).simplify(alone) != 1)
+    TEST_FAILED("The shell alone should be simplified");
+  if (alone[0].size() != 5) TEST_FAILED("The spike should be removed");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test(void)
+  {
+    TEST(zero_tolerance);
+    TEST(rings);
+    TEST(polylines);
+    TEST(anchors);
+    TEST(direction);
+    TEST(simple);
+    TEST(holes);
+    TEST(containment);
+  }
+};
+
+}  // namespace SimplifyTest
+
+//! The main program
+int main(void)
+{
+  using namespace std;
+  cout << endl << "Simplify" << endl << "========" << endl;
+  SimplifyTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
@@ -0,0 +1,177 @@
+// ======================================================================
+/*!
+ * \file
+ * \brief Regression tests for Tron::SmoothedGridView
+ */
+// ======================================================================
+
+#include "EdgeCollector.h"
+#include "SmoothedGridView.h"
+#include <regression/tframe.h>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//! Protection against conflicts with global functions
+namespace SmoothedGridViewTest
+{
+typedef Tron::Traits<double, double, Tron::NanMissing> MyTraits;
+typedef Tron::Edge<MyTraits> MyEdge;
+typedef TronTest::EdgeCollector<MyEdge> Collector;
+}  // namespace SmoothedGridViewTest
+
+#include "Tron.h"
+
+using namespace std;
+
+template <typename T>
+string tostr(const T& value)
+{
+  ostringstream out;
+  out << value;
+  return out.str();
+}
+
+namespace SmoothedGridViewTest
+{
+// ----------------------------------------------------------------------
+/*
+ * A noisy grid with unit spacing
+ */
+// ----------------------------------------------------------------------
+
+class Grid
+{
+ public:
+  typedef double value_type;
+  typedef int size_type;
+  typedef double coord_type;
+
+  Grid(size_type theWidth, size_type theHeight)
+      : itsWidth(theWidth), itsHeight(theHeight), itsData(theWidth * theHeight)
+  {
+    unsigned int seed = 123456;
+    for (size_type j = 0; j < itsHeight; j++)
+      for (size_type i = 0; i < itsWidth; i++)
+        itsData[i + itsWidth * j] =
+            sin(0.05 * i) * cos(0.07 * j) + 0.3 * rand_r(&seed) / RAND_MAX;
+  }
+
+  size_type width() const { return itsWidth; }
+  size_type height() const { return itsHeight; }
+  const value_type& operator()(size_type i, size_type j) const { return itsData[i + itsWidth * j]; }
+  value_type& operator()(size_type i, size_type j) { return itsData[i + itsWidth * j]; }
+  coord_type x(size_type i, size_type j) const { return i; }
+  coord_type y(size_type i, size_type j) const { return j; }
+  bool valid(size_type i, size_type j) const { return true; }
+
+ private:
+  Grid();
+  size_type itsWidth;
+  size_type itsHeight;
+  std::vector<value_type> itsData;
+};
+
+typedef Tron::SmoothedGridView<Grid> MyView;
+typedef Tron::Contourer<Grid, Collector, MyTraits, Tron::LinearInterpolation> MyContourer;
+typedef Tron::Contourer<MyView, Collector, MyTraits, Tron::LinearInterpolation> ViewContourer;
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that the values equal those of SavitzkyGolay2D::smooth
+ */
+// ----------------------------------------------------------------------
+
+void values()
+{
+  Grid grid(150, 100);
+  grid(70, 64) = NAN;
+
+  for (int length = 0; length <= 6; length++)
+    for (int degree = 1; degree <= 5; degree++)
+    {
+      Grid expected = grid;
+      Tron::SavitzkyGolay2D::smooth(expected, length, degree);
+
+      // A tiny cache to force tiles to be evicted and recomputed
+      MyView view(grid, length, degree, 2);
+
+      for (int i = 0; i < grid.width(); i++)
+        for (int j = 0; j < grid.height(); j++)
+        {
+          const double a = view(i, j);
+          const double b = expected(i, j);
+          if (!(a == b || (std::isnan(a) && std::isnan(b))))
+            TEST_FAILED("Length " + tostr(length) + " degree " + tostr(degree) + " at " +
+                        tostr(i) + "," + tostr(j) + ": " + tostr(a) + " <> " + tostr(b));
+        }
+    }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test that contouring an area smoothens only the tiles needed
+ */
+// ----------------------------------------------------------------------
+
+void lazy()
+{
+  Grid grid(640, 640);
+  Grid smoothed = grid;
+  Tron::SavitzkyGolay2D::smooth(smoothed, 3, 2);
+
+  MyView view(grid, 3, 2);
+  ViewContourer::coordinate_hints_type viewhints(view);
+  MyContourer::coordinate_hints_type hints(smoothed);
+
+  Collector result, expected;
+  ViewContourer::fill(result, view, 0.1, 0.5, viewhints, 200, 300, 260, 350);
+  MyContourer::fill(expected, smoothed, 0.1, 0.5, hints, 200, 300, 260, 350);
+  if (expected.edges.empty()) TEST_FAILED("No edges were produced");
+  if (!same(result, expected)) TEST_FAILED("Fill edges differ");
+
+  result.edges.clear();
+  expected.edges.clear();
+  ViewContourer::line(result, view, 0.2, viewhints, 200, 300, 260, 350);
+  MyContourer::line(expected, smoothed, 0.2, hints, 200, 300, 260, 350);
+  if (expected.edges.empty()) TEST_FAILED("No line edges were produced");
+  if (!same(result, expected)) TEST_FAILED("Line edges differ");
+
+  if (view.computed_tiles() > 16)
+    TEST_FAILED("Smoothed " + tostr(view.computed_tiles()) + " of 100 tiles");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test(void)
+  {
+    TEST(values);
+    TEST(lazy);
+  }
+};
+
+}  // namespace SmoothedGridViewTest
+
+//! The main program
+int main(void)
+{
+  using namespace std;
+  cout << endl << "SmoothedGridView" << endl << "================" << endl;
+  SmoothedGridViewTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
@@ -0,0 +1,184 @@
+// ======================================================================
+/*!
+ * \file
+ * \brief Regression tests for Tron::WkbBuilder
+ */
+// ======================================================================
+
+#include "Edge.h"
+#include "FlipSet.h"
+#include "Traits.h"
+#include "WkbBuilder.h"
+#include <regression/tframe.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//! Protection against conflicts with global functions
+namespace WkbBuilderTest
+{
+typedef Tron::Traits<double, double> MyTraits;
+typedef Tron::Edge<MyTraits> MyEdge;
+typedef Tron::FlipSet<MyEdge> MyFlipSet;
+
+// Hex encode binary output for readable comparisons
+string tohex(const string& theData)
+{
+  const char* digits = "0123456789ABCDEF";
+  string ret;
+  for (unsigned char c : theData)
+  {
+    ret += digits[c >> 4];
+    ret += digits[c & 0xF];
+  }
+  return ret;
+}
+
+// Add a closed clockwise square with the given corners, or a counter clockwise one
+void square(MyFlipSet& theFlipSet, double x1, double y1, double x2, double y2, bool cw)
+{
+  if (cw)
+  {
+    theFlipSet.flip(MyEdge(x1, y1, x1, y2));
+    theFlipSet.flip(MyEdge(x1, y2, x2, y2));
+    theFlipSet.flip(MyEdge(x2, y2, x2, y1));
+    theFlipSet.flip(MyEdge(x2, y1, x1, y1));
+  }
+  else
+  {
+    theFlipSet.flip(MyEdge(x1, y1, x2, y1));
+    theFlipSet.flip(MyEdge(x2, y1, x2, y2));
+    theFlipSet.flip(MyEdge(x2, y2, x1, y2));
+    theFlipSet.flip(MyEdge(x1, y2, x1, y1));
+  }
+}
+
+string build(MyFlipSet& theFlipSet, bool fillmode, Tron::WkbBuilder::Format theFormat)
+{
+  theFlipSet.prepare();
+  Tron::WkbBuilder builder(theFormat, 0);
+  builder.build<MyTraits>(theFlipSet.edges(), fillmode);
+  return tohex(builder.result());
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test WKB output
+ */
+// ----------------------------------------------------------------------
+
+void wkb()
+{
+  const auto format = Tron::WkbBuilder::Format::WKB;
+
+  {
+    MyFlipSet flipset;
+    string result = build(flipset, true, format);
+    string ok = "010700000000000000";
+    if (result != ok) TEST_FAILED("Empty result: expected " + ok + " got " + result);
+  }
+
+  {
+    MyFlipSet flipset;
+    square(flipset, 0, 0, 1, 1, true);
+    string result = build(flipset, true, format);
+    string ok =
+        "01030000000100000005000000"
+        "00000000000000000000000000000000"
+        "0000000000000000000000000000F03F"
+        "000000000000F03F000000000000F03F"
+        "000000000000F03F0000000000000000"
+        "00000000000000000000000000000000";
+    if (result != ok) TEST_FAILED("Square: expected " + ok + " got " + result);
+  }
+
+  {
+    MyFlipSet flipset;
+    square(flipset, 0, 0, 1, 1, true);
+    square(flipset, 2, 0, 3, 1, true);
+    string result = build(flipset, true, format);
+    if (result.substr(0, 18) != "010600000002000000")
+      TEST_FAILED("Expected a multipolygon with 2 parts, got " + result);
+    if (result.substr(18, 18) != "010300000001000000")
+      TEST_FAILED("Expected the first part to be a polygon, got " + result);
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test TWKB output
+ */
+// ----------------------------------------------------------------------
+
+void twkb()
+{
+  const auto format = Tron::WkbBuilder::Format::TWKB;
+
+  {
+    MyFlipSet flipset;
+    string result = build(flipset, true, format);
+    string ok = "0710";
+    if (result != ok) TEST_FAILED("Empty result: expected " + ok + " got " + result);
+  }
+
+  {
+    MyFlipSet flipset;
+    square(flipset, 0, 0, 1, 1, true);
+    string result = build(flipset, true, format);
+    string ok = "0300010500000002020000010100";
+    if (result != ok) TEST_FAILED("Square: expected " + ok + " got " + result);
+  }
+
+  {
+    // Shell 0,0 ... 3,3 with the hole 1,1 ... 2,2
+    MyFlipSet flipset;
+    square(flipset, 0, 0, 3, 3, true);
+    square(flipset, 1, 1, 2, 2, false);
+    string result = build(flipset, true, format);
+    string ok = "03000205000000060600000505000502020200000201000001";
+    if (result != ok) TEST_FAILED("Polygon with hole: expected " + ok + " got " + result);
+  }
+
+  {
+    MyFlipSet flipset;
+    flipset.flip(MyEdge(0, 0, 1, 0));
+    flipset.flip(MyEdge(1, 0, 2, 1));
+    string result = build(flipset, false, format);
+    string ok = "020003000002000202";
+    if (result != ok) TEST_FAILED("Line: expected " + ok + " got " + result);
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test(void)
+  {
+    TEST(wkb);
+    TEST(twkb);
+  }
+};
+
+}  // namespace WkbBuilderTest
+
+//! The main program
+int main(void)
+{
+  using namespace std;
+  cout << endl << "WkbBuilder" << endl << "==========" << endl;
+  WkbBuilderTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
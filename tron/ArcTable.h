@@ -0,0 +1,478 @@
+// ======================================================================
+/*!
+ * \brief Table of arcs shared by the rings of adjacent isobands
+ *
+ * Each boundary between two isobands is an isoline, and is built twice
+ * when the bands are contoured separately, once in each direction.
+ * The arc table splits the rings at junctions and stores each arc only
+ * once, so that the arcs can be simplified and output once per
+ * boundary. Rings refer to the arcs TopoJSON style: arc index i means
+ * the arc in its stored direction, ~i the arc reversed.
+ *
+ * A junction is a vertex which appears with different neighbours in
+ * different rings, for example where an isoline meets the grid boundary
+ * or where rings of the same band touch. The rings are also split where
+ * they join or leave the bounding box of all the vertices, and at the
+ * corners of the box. For rectilinear grids this anchors the grid
+ * boundary even when only a single band is built. Closed rings without
+ * such vertices form a single arc starting from the lexicographically
+ * smallest vertex, hence the same ring is found regardless of which
+ * band it came from.
+ *
+ * Usage:
+ *
+ *   ArcTable<Traits> table;
+ *   for (ring : rings) table.add_vertices(ring);
+ *   for (ring : rings) ringarcs.push_back(table.split(ring));
+ *   table.simplify(tolerance, ringarcs);
+ *   Ring<Traits> ring = table.ring(ringarcs[0]);
+ *
+ * Only closed rings are supported.
+ */
+// ======================================================================
+
+#pragma once
+
+#include "Ring.h"
+#include "Simplify.h"
+#include <boost/functional/hash.hpp>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Tron
+{
+template <typename Traits>
+class ArcTable
+{
+ public:
+  using Point = typename Ring<Traits>::value_type;
+  using Points = std::vector<Point>;
+  using ArcRef = long;
+  using RingArcs = std::vector<ArcRef>;
+
+  void add_vertices(const Ring<Traits> &theRing);
+  RingArcs split(const Ring<Traits> &theRing);
+
+  std::size_t size() const { return itsArcs.size(); }
+  const Points &arc(std::size_t theIndex) const { return itsArcs[theIndex]; }
+
+  // Index of the arc referred to, and whether it is reversed
+  static std::size_t index(ArcRef theRef) { return theRef >= 0 ? theRef : ~theRef; }
+  static bool reversed(ArcRef theRef) { return theRef < 0; }
+
+  Ring<Traits> ring(const RingArcs &theArcs) const;
+
+  std::size_t simplify(double theTolerance, const std::vector<RingArcs> &theRings);
+
+ private:
+  struct PointHash
+  {
+    std::size_t operator()(const Point &p) const
+    {
+      std::size_t hash = boost::hash_value(p.first);
+      boost::hash_combine(hash, boost::hash_value(p.second));
+      return hash;
+    }
+  };
+
+  struct EdgeHash
+  {
+    std::size_t operator()(const std::pair<Point, Point> &e) const
+    {
+      PointHash hasher;
+      std::size_t hash = hasher(e.first);
+      boost::hash_combine(hash, hasher(e.second));
+      return hash;
+    }
+  };
+
+  // Neighbours of the first occurrence of a vertex
+  struct Vertex
+  {
+    Point prev;
+    Point next;
+    bool junction;
+  };
+
+  using coord_type = typename Point::first_type;
+
+  static Points assemble(const std::vector<Points> &theArcs, const RingArcs &theRefs);
+
+  bool on_box_side(const Point &p1, const Point &p2) const;
+  bool is_anchor(const Point &prev, const Point &point, const Point &next) const;
+
+  ArcRef find_or_add(Points &&theArc);
+
+  bool restore_crossings(const std::vector<Points> &theOriginals, std::vector<char> &theSimplified);
+  bool restore_moved(const std::vector<Points> &theOriginals,
+                     std::vector<char> &theSimplified,
+                     const std::vector<RingArcs> &theRings);
+
+  std::vector<Points> itsArcs;
+  std::unordered_map<Point, Vertex, PointHash> itsVertices;
+
+  // Bounding box of all the vertices
+  coord_type itsXmin = std::numeric_limits<coord_type>::max();
+  coord_type itsYmin = std::numeric_limits<coord_type>::max();
+  coord_type itsXmax = std::numeric_limits<coord_type>::lowest();
+  coord_type itsYmax = std::numeric_limits<coord_type>::lowest();
+
+  // First directed edge of each arc, and reversed last edge of each arc
+  std::unordered_map<std::pair<Point, Point>, ArcRef, EdgeHash> itsEdges;
+
+};  // class ArcTable
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Register the vertices of a ring for finding the junctions
+ *
+ * All rings must be registered before any of them are split.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+void ArcTable<Traits>::add_vertices(const Ring<Traits> &theRing)
+{
+  if (!theRing.closed())
+    throw std::runtime_error("ArcTable accepts only closed rings");
+
+  Points points(theRing.begin(), theRing.end());
+  points.pop_back();
+  const std::size_t n = points.size();
+
+  for (std::size_t i = 0; i < n; i++)
+  {
+    itsXmin = std::min(itsXmin, points[i].first);
+    itsXmax = std::max(itsXmax, points[i].first);
+    itsYmin = std::min(itsYmin, points[i].second);
+    itsYmax = std::max(itsYmax, points[i].second);
+
+    const Point &prev = points[(i + n - 1) % n];
+    const Point &next = points[(i + 1) % n];
+    auto result = itsVertices.insert(std::make_pair(points[i], Vertex{prev, next, false}));
+    if (!result.second)
+    {
+      Vertex &vertex = result.first->second;
+      if (!((vertex.prev == prev && vertex.next == next) ||
+            (vertex.prev == next && vertex.next == prev)))
+        vertex.junction = true;
+    }
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test whether the segment lies on a side of the bounding box
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+bool ArcTable<Traits>::on_box_side(const Point &p1, const Point &p2) const
+{
+  return ((p1.first == p2.first && (p1.first == itsXmin || p1.first == itsXmax)) ||
+          (p1.second == p2.second && (p1.second == itsYmin || p1.second == itsYmax)));
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test whether the ring must be split at a vertex which is not a junction
+ *
+ * The vertex only depends on its neighbours, which are the same in all
+ * the rings since the vertex is not a junction. Hence all the bands
+ * split their shared arcs identically.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+bool ArcTable<Traits>::is_anchor(const Point &prev, const Point &point, const Point &next) const
+{
+  const bool before = on_box_side(prev, point);
+  const bool after = on_box_side(point, next);
+  if (before != after)
+    return true;
+  return (before && (point.first == itsXmin || point.first == itsXmax) &&
+          (point.second == itsYmin || point.second == itsYmax));
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Find an existing arc in either direction or add a new one
+ *
+ * Arcs cannot share their first directed edge unless they are equal,
+ * since the arcs contain no junctions or anchors except at their end
+ * points.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+typename ArcTable<Traits>::ArcRef ArcTable<Traits>::find_or_add(Points &&theArc)
+{
+  const std::size_t n = theArc.size();
+  auto pos = itsEdges.find(std::make_pair(theArc[0], theArc[1]));
+  if (pos != itsEdges.end())
+    return pos->second;
+
+  const auto index = static_cast<ArcRef>(itsArcs.size());
+  itsEdges[std::make_pair(theArc[0], theArc[1])] = index;
+  itsEdges[std::make_pair(theArc[n - 1], theArc[n - 2])] = ~index;
+  itsArcs.push_back(std::move(theArc));
+  return index;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Split a ring into arcs at the junctions and the anchors
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+typename ArcTable<Traits>::RingArcs ArcTable<Traits>::split(const Ring<Traits> &theRing)
+{
+  if (!theRing.closed())
+    throw std::runtime_error("ArcTable accepts only closed rings");
+
+  Points points(theRing.begin(), theRing.end());
+  points.pop_back();
+  const std::size_t n = points.size();
+
+  std::vector<std::size_t> splits;
+  for (std::size_t i = 0; i < n; i++)
+  {
+    auto pos = itsVertices.find(points[i]);
+    if (pos == itsVertices.end())
+      throw std::runtime_error("ArcTable: vertices of the ring have not been added");
+    if (pos->second.junction || is_anchor(points[(i + n - 1) % n], points[i], points[(i + 1) % n]))
+      splits.push_back(i);
+  }
+
+  // Start from the first split, or from the smallest vertex if there are none
+
+  std::size_t start = 0;
+  if (!splits.empty())
+    start = splits[0];
+  else
+    start = std::min_element(points.begin(), points.end()) - points.begin();
+
+  std::rotate(points.begin(), points.begin() + start, points.end());
+  points.push_back(points.front());
+  for (auto &split : splits)
+    split -= start;
+
+  RingArcs arcs;
+
+  if (splits.size() <= 1)
+  {
+    arcs.push_back(find_or_add(std::move(points)));
+    return arcs;
+  }
+
+  splits.push_back(n);
+  for (std::size_t k = 0; k + 1 < splits.size(); k++)
+    arcs.push_back(
+        find_or_add(Points(points.begin() + splits[k], points.begin() + splits[k + 1] + 1)));
+
+  return arcs;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Concatenate arcs into a closed sequence of points
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+typename ArcTable<Traits>::Points ArcTable<Traits>::assemble(const std::vector<Points> &theArcs,
+                                                             const RingArcs &theRefs)
+{
+  Points points;
+  for (auto ref : theRefs)
+  {
+    const Points &arc = theArcs[index(ref)];
+    // Skip the first point of all but the first arc, it is the same as the previous last point
+    const std::size_t skip = (points.empty() ? 0 : 1);
+    if (!reversed(ref))
+      points.insert(points.end(), arc.begin() + skip, arc.end());
+    else
+      points.insert(points.end(), arc.rbegin() + skip, arc.rend());
+  }
+  return points;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Materialize a ring from its arcs
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+Ring<Traits> ArcTable<Traits>::ring(const RingArcs &theArcs) const
+{
+  const Points points = assemble(itsArcs, theArcs);
+  Ring<Traits> ret;
+  ret.assign(points.begin(), points.end());
+  return ret;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Simplify all arcs, returns the number of simplified arcs
+ *
+ * Each arc is simplified once with fixed end points. If a ring built
+ * from the simplified arcs collapses below 4 points, changes its
+ * orientation or intersects itself, the arcs of the ring are restored
+ * in all the rings using them. A simplified arc crossing or touching
+ * another arc anywhere but at their shared end points is restored too,
+ * as are the simplified arcs of a ring which moved another ring to its
+ * other side, for example an island next to a band boundary.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+std::size_t ArcTable<Traits>::simplify(double theTolerance, const std::vector<RingArcs> &theRings)
+{
+  if (theTolerance <= 0)
+    return 0;
+
+  const std::vector<Points> originals = itsArcs;
+  std::vector<char> simplified(itsArcs.size(), 0);
+
+  const Simplifier<Traits> simplifier(theTolerance);
+  Ring<Traits> tmp;
+  for (std::size_t i = 0; i < itsArcs.size(); i++)
+  {
+    tmp.assign(itsArcs[i].begin(), itsArcs[i].end());
+    if (simplifier.simplify(tmp))
+    {
+      itsArcs[i].assign(tmp.begin(), tmp.end());
+      simplified[i] = 1;
+    }
+  }
+
+  // Restoring arcs may invalidate rings checked earlier, hence repeat until stable
+
+  bool restored = true;
+  while (restored)
+  {
+    restored = false;
+    for (const auto &refs : theRings)
+    {
+      bool modified = false;
+      for (auto ref : refs)
+        modified |= (simplified[index(ref)] != 0);
+      if (!modified)
+        continue;
+
+      const Points points = assemble(itsArcs, refs);
+      const double area = SimplifyDetail::signed_area(points);
+      const double oldarea = SimplifyDetail::signed_area(assemble(originals, refs));
+
+      if (points.size() < 4 || area == 0 || (area > 0) != (oldarea > 0) ||
+          !Simplifier<Traits>::is_simple(points, true))
+      {
+        for (auto ref : refs)
+        {
+          itsArcs[index(ref)] = originals[index(ref)];
+          simplified[index(ref)] = 0;
+        }
+        restored = true;
+      }
+    }
+    if (!restored)
+      restored = restore_crossings(originals, simplified);
+    if (!restored)
+      restored = restore_moved(originals, simplified, theRings);
+  }
+
+  return std::count(simplified.begin(), simplified.end(), 1);
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Restore the simplified arcs which intersect other arcs
+ *
+ * Arcs may only touch at their shared end points. Returns true if any
+ * arc was restored.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+bool ArcTable<Traits>::restore_crossings(const std::vector<Points> &theOriginals,
+                                         std::vector<char> &theSimplified)
+{
+  if (std::find(theSimplified.begin(), theSimplified.end(), 1) == theSimplified.end())
+    return false;
+
+  std::vector<SimplifyDetail::Segment<Point>> segments;
+  for (std::size_t i = 0; i < itsArcs.size(); i++)
+  {
+    const Points &arc = itsArcs[i];
+    for (std::size_t k = 0; k + 1 < arc.size(); k++)
+      segments.push_back(SimplifyDetail::Segment<Point>{arc[k], arc[k + 1], i});
+  }
+
+  const auto crossing = SimplifyDetail::crossings(segments, theSimplified);
+
+  bool restored = false;
+  for (std::size_t i = 0; i < itsArcs.size(); i++)
+  {
+    if (crossing[i] && theSimplified[i])
+    {
+      itsArcs[i] = theOriginals[i];
+      theSimplified[i] = 0;
+      restored = true;
+    }
+  }
+  return restored;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Restore the simplified arcs of rings which moved other rings across
+ *
+ * Done only when no arcs intersect, hence containment can be decided
+ * by single vertices. Returns true if any arc was restored.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+bool ArcTable<Traits>::restore_moved(const std::vector<Points> &theOriginals,
+                                     std::vector<char> &theSimplified,
+                                     const std::vector<RingArcs> &theRings)
+{
+  std::vector<Points> rings;
+  std::vector<Points> originals;
+  std::vector<char> candidates;
+  for (const auto &refs : theRings)
+  {
+    bool modified = false;
+    for (auto ref : refs)
+      modified |= (theSimplified[index(ref)] != 0);
+    rings.push_back(assemble(itsArcs, refs));
+    originals.push_back(modified ? assemble(theOriginals, refs) : Points());
+    candidates.push_back(modified);
+  }
+
+  const auto moved = SimplifyDetail::moved(rings, originals, candidates);
+
+  bool restored = false;
+  for (std::size_t i = 0; i < theRings.size(); i++)
+  {
+    if (!moved[i])
+      continue;
+    for (auto ref : theRings[i])
+    {
+      itsArcs[index(ref)] = theOriginals[index(ref)];
+      theSimplified[index(ref)] = 0;
+    }
+    restored = true;
+  }
+  return restored;
+}
+
+}  // namespace Tron
+
+// ======================================================================
@@ -0,0 +1,314 @@
+// ======================================================================
+/*!
+ * \brief Clipping contour edges to a bounding box
+ *
+ * Used by Contourer::fill_clipped and Contourer::line_clipped for the
+ * grid cells which straddle the bounding box. Cells completely inside
+ * the box are contoured as usual, cells completely outside are skipped.
+ *
+ * For a straddling cell the edges of the cell are first collected into
+ * a separate flipset. In fill mode the edges form closed clockwise
+ * rings, and the clipped result consists of
+ *
+ *  - the parts of the edges inside the box
+ *  - the parts of the box sides inside the rings, in clockwise order
+ *
+ * Intersections are always calculated with the segment end points in
+ * lexicographic order, hence an edge shared by two cells is clipped
+ * identically in both and the edges still cancel each other in the
+ * flipset.
+ */
+// ======================================================================
+
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace Tron
+{
+template <typename Traits>
+class BoxClipper
+{
+ public:
+  using coord_type = typename Traits::coord_type;
+
+  enum Placement
+  {
+    Outside,
+    Inside,
+    Partial
+  };
+
+  BoxClipper(coord_type theXmin, coord_type theYmin, coord_type theXmax, coord_type theYmax)
+      : itsXmin(theXmin), itsYmin(theYmin), itsXmax(theXmax), itsYmax(theYmax)
+  {
+    if (!(theXmin < theXmax) || !(theYmin < theYmax))
+      throw std::runtime_error("Invalid clipping rectangle");
+  }
+
+  // Placement of a bounding box, usually that of a grid cell. A cell merely touching
+  // the box is outside, its side on the box would cancel that of the inside neighbour.
+  Placement placement(coord_type x1, coord_type y1, coord_type x2, coord_type y2) const
+  {
+    if (x2 <= itsXmin || x1 >= itsXmax || y2 <= itsYmin || y1 >= itsYmax)
+      return Outside;
+    if (x1 >= itsXmin && x2 <= itsXmax && y1 >= itsYmin && y2 <= itsYmax)
+      return Inside;
+    return Partial;
+  }
+
+  template <typename Edges, typename FlipSet>
+  void clip_lines(const Edges &theEdges, FlipSet &theFlipSet) const;
+
+  template <typename Edges, typename FlipSet>
+  void clip_fill(const Edges &theEdges, FlipSet &theFlipSet) const;
+
+ private:
+  using Point = std::pair<coord_type, coord_type>;
+
+  bool clip(Point p1, Point p2, Point &q1, Point &q2) const;
+
+  // Intersections of a segment with lines x=c and y=c, p1 < p2 lexicographically
+  static coord_type y_at(const Point &p1, const Point &p2, coord_type c)
+  {
+    return p1.second + (c - p1.first) * (p2.second - p1.second) / (p2.first - p1.first);
+  }
+  static coord_type x_at(const Point &p1, const Point &p2, coord_type c)
+  {
+    return p1.first + (c - p1.second) * (p2.first - p1.first) / (p2.second - p1.second);
+  }
+
+  template <typename Edges>
+  static bool inside(const Edges &theEdges, coord_type x, coord_type y);
+
+  coord_type itsXmin;
+  coord_type itsYmin;
+  coord_type itsXmax;
+  coord_type itsYmax;
+
+};  // class BoxClipper
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Liang-Barsky clipping of a segment, returns false if nothing remains
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+bool BoxClipper<Traits>::clip(Point p1, Point p2, Point &q1, Point &q2) const
+{
+  const bool swapped = (p2 < p1);
+  if (swapped)
+    std::swap(p1, p2);
+
+  const double dx = static_cast<double>(p2.first) - p1.first;
+  const double dy = static_cast<double>(p2.second) - p1.second;
+
+  // Entry and exit parameters and the boundaries producing them
+
+  double t0 = 0, t1 = 1;
+  int side0 = -1, side1 = -1;
+
+  const double p[4] = {-dx, dx, -dy, dy};
+  const double q[4] = {
+      p1.first - itsXmin, itsXmax - p1.first, p1.second - itsYmin, itsYmax - p1.second};
+
+  for (int k = 0; k < 4; k++)
+  {
+    if (p[k] == 0)
+    {
+      if (q[k] < 0)
+        return false;
+    }
+    else
+    {
+      const double t = q[k] / p[k];
+      if (p[k] < 0)
+      {
+        if (t > t1)
+          return false;
+        if (t > t0)
+        {
+          t0 = t;
+          side0 = k;
+        }
+      }
+      else
+      {
+        if (t < t0)
+          return false;
+        if (t < t1)
+        {
+          t1 = t;
+          side1 = k;
+        }
+      }
+    }
+  }
+
+  if (t0 >= t1)
+    return false;
+
+  auto point = [&](int side, const Point &endpoint) -> Point
+  {
+    switch (side)
+    {
+      case 0:
+        return Point(itsXmin, y_at(p1, p2, itsXmin));
+      case 1:
+        return Point(itsXmax, y_at(p1, p2, itsXmax));
+      case 2:
+        return Point(x_at(p1, p2, itsYmin), itsYmin);
+      case 3:
+        return Point(x_at(p1, p2, itsYmax), itsYmax);
+      default:
+        return endpoint;
+    }
+  };
+
+  q1 = point(side0, p1);
+  q2 = point(side1, p2);
+  if (swapped)
+    std::swap(q1, q2);
+  return true;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Crossing number test, points on the edges are not inside
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+template <typename Edges>
+bool BoxClipper<Traits>::inside(const Edges &theEdges, coord_type x, coord_type y)
+{
+  bool ret = false;
+  for (const auto &edge : theEdges)
+  {
+    const double x1 = edge.x1(), y1 = edge.y1(), x2 = edge.x2(), y2 = edge.y2();
+
+    // On the edge?
+    if ((x2 - x1) * (y - y1) == (y2 - y1) * (x - x1) && x >= std::min(x1, x2) &&
+        x <= std::max(x1, x2) && y >= std::min(y1, y2) && y <= std::max(y1, y2))
+      return false;
+
+    if ((y1 > y) != (y2 > y) && x < (x2 - x1) * (y - y1) / (y2 - y1) + x1)
+      ret = !ret;
+  }
+  return ret;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Clip isoline edges
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+template <typename Edges, typename FlipSet>
+void BoxClipper<Traits>::clip_lines(const Edges &theEdges, FlipSet &theFlipSet) const
+{
+  using Edge = typename FlipSet::value_type;
+  Point q1, q2;
+  for (const auto &edge : theEdges)
+    if (clip(Point(edge.x1(), edge.y1()), Point(edge.x2(), edge.y2()), q1, q2))
+      theFlipSet.eflip(Edge(q1.first, q1.second, q2.first, q2.second));
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Clip the closed rings of a single cell
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+template <typename Edges, typename FlipSet>
+void BoxClipper<Traits>::clip_fill(const Edges &theEdges, FlipSet &theFlipSet) const
+{
+  using Edge = typename FlipSet::value_type;
+
+  if (theEdges.empty())
+    return;
+
+  clip_lines(theEdges, theFlipSet);
+
+  // Split the box sides at the edge crossings and output the parts inside the rings
+
+  std::vector<coord_type> params;
+
+  for (int side = 0; side < 4; side++)
+  {
+    const bool vertical = (side < 2);
+    const coord_type c =
+        (side == 0 ? itsXmin : side == 1 ? itsXmax : side == 2 ? itsYmin : itsYmax);
+    const coord_type lo = (vertical ? itsYmin : itsXmin);
+    const coord_type hi = (vertical ? itsYmax : itsXmax);
+
+    params.clear();
+    params.push_back(lo);
+    params.push_back(hi);
+
+    for (const auto &edge : theEdges)
+    {
+      Point p1(edge.x1(), edge.y1());
+      Point p2(edge.x2(), edge.y2());
+      if (p2 < p1)
+        std::swap(p1, p2);
+
+      const coord_type a1 = (vertical ? p1.first : p1.second);
+      const coord_type a2 = (vertical ? p2.first : p2.second);
+      if (c < std::min(a1, a2) || c > std::max(a1, a2))
+        continue;
+
+      if (a1 == a2)
+      {
+        // The edge lies on the line
+        params.push_back(vertical ? p1.second : p1.first);
+        params.push_back(vertical ? p2.second : p2.first);
+      }
+      else
+        params.push_back(vertical ? y_at(p1, p2, c) : x_at(p1, p2, c));
+    }
+
+    std::sort(params.begin(), params.end());
+    params.erase(std::unique(params.begin(), params.end()), params.end());
+
+    for (std::size_t i = 1; i < params.size(); i++)
+    {
+      const coord_type a = params[i - 1];
+      const coord_type b = params[i];
+      if (a < lo || b > hi)
+        continue;
+
+      const coord_type mid = (a + b) / 2;
+      if (!(vertical ? inside(theEdges, c, mid) : inside(theEdges, mid, c)))
+        continue;
+
+      // Clockwise around the box: up the left side, right along the top,
+      // down the right side and left along the bottom
+      switch (side)
+      {
+        case 0:
+          theFlipSet.eflip(Edge(c, a, c, b));
+          break;
+        case 1:
+          theFlipSet.eflip(Edge(c, b, c, a));
+          break;
+        case 2:
+          theFlipSet.eflip(Edge(b, c, a, c));
+          break;
+        default:
+          theFlipSet.eflip(Edge(a, c, b, c));
+          break;
+      }
+    }
+  }
+}
+
+}  // namespace Tron
+
+// ======================================================================
@@ -0,0 +1,282 @@
+// ======================================================================
+/*!
+ * \brief Wide 2D smoothing with box and approximate Gaussian filters
+ *
+ * SavitzkyGolay2D is limited to small kernels since its cost grows with
+ * the kernel area. The filters here are separable and use running sums
+ * along rows and columns, hence the cost per pixel does not depend on
+ * the radius. A Gaussian is approximated by three successive box filters
+ * whose widths are chosen to match the requested standard deviation.
+ *
+ * The data is mirrored at the borders as in MirrorMatrix, so that the
+ * trend in the data is preserved and linear fields stay unchanged. Like
+ * MirrorMatrix, the mirroring does not extend beyond one grid width,
+ * hence the radius is limited to width-1 and height-1 in the respective
+ * directions.
+ *
+ * As in SavitzkyGolay2D, pixels whose window contains a NaN keep their
+ * original value. The row and column passes can be split between
+ * threads, the results do not depend on the number of threads.
+ */
+// ======================================================================
+
+#pragma once
+
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace Tron
+{
+namespace BoxFilter2D
+{
+namespace Detail
+{
+// Value at index k of a line of n values mirrored as in MirrorMatrix
+template <typename T>
+T mirror(const T* line, long n, long stride, long k)
+{
+  if (k < 0) return 2 * line[0] - line[-k * stride];
+  if (k >= n) return 2 * line[(n - 1) * stride] - line[(2 * n - k - 2) * stride];
+  return line[k * stride];
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Box filter rows j1...j2-1 with running sums
+ */
+// ----------------------------------------------------------------------
+
+template <typename T>
+void box_rows(
+    const std::vector<T>& input, std::vector<T>& output, long width, long radius, long j1, long j2)
+{
+  const T nan = std::numeric_limits<T>::quiet_NaN();
+  const double scale = 1.0 / (2 * radius + 1);
+
+  std::vector<T> line(width + 2 * radius);
+
+  for (long j = j1; j < j2; ++j)
+  {
+    const T* in = &input[j * width];
+    for (long k = -radius; k < width + radius; ++k)
+      line[k + radius] = mirror(in, width, 1, k);
+
+    double sum = 0;
+    long nans = 0;
+    for (long k = 0; k < 2 * radius + 1; ++k)
+    {
+      if (std::isnan(line[k]))
+        ++nans;
+      else
+        sum += line[k];
+    }
+
+    T* out = &output[j * width];
+    for (long i = 0; i < width; ++i)
+    {
+      out[i] = (nans > 0 ? nan : static_cast<T>(sum * scale));
+      if (i + 1 == width) break;
+
+      const T next = line[i + 2 * radius + 1];
+      const T prev = line[i];
+      if (std::isnan(next))
+        ++nans;
+      else
+        sum += next;
+      if (std::isnan(prev))
+        --nans;
+      else
+        sum -= prev;
+    }
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Box filter columns i1...i2-1 with running sums
+ *
+ * The columns are processed simultaneously one row at a time so that
+ * the memory is accessed sequentially.
+ */
+// ----------------------------------------------------------------------
+
+template <typename T>
+void box_columns(const std::vector<T>& input,
+                 std::vector<T>& output,
+                 long width,
+                 long height,
+                 long radius,
+                 long i1,
+                 long i2)
+{
+  const T nan = std::numeric_limits<T>::quiet_NaN();
+  const double scale = 1.0 / (2 * radius + 1);
+
+  std::vector<double> sums(i2 - i1, 0.0);
+  std::vector<long> nans(i2 - i1, 0);
+
+  auto add = [&](long k, int sign)
+  {
+    for (long i = i1; i < i2; ++i)
+    {
+      const T value = mirror(&input[i], height, width, k);
+      if (std::isnan(value))
+        nans[i - i1] += sign;
+      else
+        sums[i - i1] += sign * static_cast<double>(value);
+    }
+  };
+
+  for (long k = -radius; k <= radius; ++k)
+    add(k, 1);
+
+  for (long j = 0; j < height; ++j)
+  {
+    T* out = &output[j * width];
+    for (long i = i1; i < i2; ++i)
+      out[i] = (nans[i - i1] > 0 ? nan : static_cast<T>(sums[i - i1] * scale));
+
+    if (j + 1 < height)
+    {
+      add(j + radius + 1, 1);
+      add(j - radius, -1);
+    }
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Apply box filters with the given radii in succession
+ */
+// ----------------------------------------------------------------------
+
+template <typename Grid>
+void smooth_boxes(Grid& grid, const std::vector<std::size_t>& radii, unsigned int threads)
+{
+  typedef typename Grid::value_type value_type;
+
+  const long width = grid.width();
+  const long height = grid.height();
+  if (width == 0 || height == 0) return;
+
+  std::vector<value_type> data(width * height);
+  Parallel::for_rows(height,
+                     threads,
+                     [&](std::size_t j1, std::size_t j2)
+                     {
+                       for (std::size_t j = j1; j < j2; ++j)
+                         for (long i = 0; i < width; ++i)
+                           data[i + width * j] = grid(i, j);
+                     });
+
+  std::vector<value_type> tmp(width * height);
+
+  bool changed = false;
+  for (std::size_t radius : radii)
+  {
+    const long rx = std::min<long>(radius, width - 1);
+    const long ry = std::min<long>(radius, height - 1);
+
+    if (rx > 0)
+    {
+      Parallel::for_rows(height,
+                         threads,
+                         [&](std::size_t j1, std::size_t j2)
+                         { box_rows(data, tmp, width, rx, j1, j2); });
+      data.swap(tmp);
+      changed = true;
+    }
+
+    if (ry > 0)
+    {
+      Parallel::for_rows(width,
+                         threads,
+                         [&](std::size_t i1, std::size_t i2)
+                         { box_columns(data, tmp, width, height, ry, i1, i2); });
+      data.swap(tmp);
+      changed = true;
+    }
+  }
+
+  if (!changed) return;
+
+  // Pixels whose window contained a NaN keep their original value
+
+  Parallel::for_rows(height,
+                     threads,
+                     [&](std::size_t j1, std::size_t j2)
+                     {
+                       for (std::size_t j = j1; j < j2; ++j)
+                         for (long i = 0; i < width; ++i)
+                         {
+                           const value_type value = data[i + width * j];
+                           if (!std::isnan(value)) grid(i, j) = value;
+                         }
+                     });
+}
+
+}  // namespace Detail
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Box filter widths approximating a Gaussian
+ *
+ * The first m passes use the odd width wl and the rest width wl+2 so
+ * that the total variance matches, see Kovesi, "Fast Almost-Gaussian
+ * Filtering" (2010). Returns the radii (width-1)/2 of the passes. Since
+ * the widths are integers, small standard deviations are approximated
+ * only roughly.
+ */
+// ----------------------------------------------------------------------
+
+inline std::vector<std::size_t> gaussian_radii(double sigma, int passes = 3)
+{
+  std::vector<std::size_t> radii;
+  if (!(sigma > 0) || passes <= 0) return radii;
+
+  const double variance = 12 * sigma * sigma;
+  long wl = static_cast<long>(std::floor(std::sqrt(variance / passes + 1)));
+  if (wl % 2 == 0) --wl;
+  const long wu = wl + 2;
+  const long m = std::lround((variance - passes * wl * wl - 4 * passes * wl - 3 * passes) /
+                             (-4.0 * wl - 4));
+
+  for (int k = 0; k < passes; k++)
+    radii.push_back(((k < m ? wl : wu) - 1) / 2);
+  return radii;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Smoothen a matrix with a (2*radius+1)^2 box filter
+ */
+// ----------------------------------------------------------------------
+
+template <typename Grid>
+void box(Grid& grid, std::size_t radius, unsigned int threads = 1)
+{
+  if (radius == 0) return;
+  Detail::smooth_boxes(grid, std::vector<std::size_t>{radius}, threads);
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Smoothen a matrix with an approximate Gaussian filter
+ *
+ * The standard deviation is in grid cells.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Grid>
+void gaussian(Grid& grid, double sigma, unsigned int threads = 1)
+{
+  Detail::smooth_boxes(grid, gaussian_radii(sigma), threads);
+}
+
+}  // namespace BoxFilter2D
+}  // namespace Tron
+
+// ======================================================================
@@ -0,0 +1,30 @@
+// ======================================================================
+/*!
+ * \brief Optional post-processing done by the builders
+ *
+ * The defaults disable all processing, hence the output is the same
+ * as without options.
+ */
+// ======================================================================
+
+#pragma once
+
+#include <cstddef>
+
+namespace Tron
+{
+struct BuildOptions
+{
+  // Douglas-Peucker tolerance in output coordinate units, see Simplify.h
+  double tolerance = 0;
+
+  // Rings with a smaller absolute area are dropped, shells with their holes
+  double min_area = 0;
+
+  // Rings and polylines with fewer distinct vertices are dropped
+  std::size_t min_vertices = 0;
+};
+
+}  // namespace Tron
+
+// ======================================================================
@@ -0,0 +1,175 @@
+#include "CellMask.h"
+#include <stdexcept>
+
+using namespace std;
+
+namespace Tron
+{
+// ----------------------------------------------------------------------
+/*!
+ * \brief Constructor
+ */
+// ----------------------------------------------------------------------
+
+CellMask::CellMask(size_t width, size_t height, bool value)
+    : itsWidth(width),
+      itsHeight(height),
+      itsRowWords((width + 63) / 64),
+      itsBits(itsRowWords * height, value ? ~word_type(0) : word_type(0))
+{
+  if (width == 0 || height == 0)
+    throw runtime_error("CellMask width and height must be positive");
+  clear_padding();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Reset the unused bits at the end of each row
+ *
+ * Keeping them zero allows counting and combining whole words.
+ */
+// ----------------------------------------------------------------------
+
+void CellMask::clear_padding()
+{
+  const size_t used = itsWidth % 64;
+  if (used == 0)
+    return;
+  const word_type keep = (word_type(1) << used) - 1;
+  for (size_t j = 0; j < itsHeight; j++)
+    itsBits[(j + 1) * itsRowWords - 1] &= keep;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Set all bits
+ */
+// ----------------------------------------------------------------------
+
+void CellMask::fill(bool value)
+{
+  std::fill(itsBits.begin(), itsBits.end(), value ? ~word_type(0) : word_type(0));
+  clear_padding();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Number of cells in the mask
+ */
+// ----------------------------------------------------------------------
+
+size_t CellMask::count() const
+{
+  size_t n = 0;
+  for (auto word : itsBits)
+    n += __builtin_popcountll(word);
+  return n;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Intersection
+ */
+// ----------------------------------------------------------------------
+
+CellMask& CellMask::operator&=(const CellMask& other)
+{
+  if (itsWidth != other.itsWidth || itsHeight != other.itsHeight)
+    throw runtime_error("CellMask sizes do not match");
+  for (size_t k = 0; k < itsBits.size(); k++)
+    itsBits[k] &= other.itsBits[k];
+  return *this;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Union
+ */
+// ----------------------------------------------------------------------
+
+CellMask& CellMask::operator|=(const CellMask& other)
+{
+  if (itsWidth != other.itsWidth || itsHeight != other.itsHeight)
+    throw runtime_error("CellMask sizes do not match");
+  for (size_t k = 0; k < itsBits.size(); k++)
+    itsBits[k] |= other.itsBits[k];
+  return *this;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Get a cached mask or create it
+ *
+ * The first request for a key inserts a future and creates the mask
+ * without holding the mutex, later requests for the same key wait for
+ * the future. If the creator throws, the waiting requests get the same
+ * exception and the key is removed so that the next request retries.
+ */
+// ----------------------------------------------------------------------
+
+CellMaskCache::value_type CellMaskCache::get(size_t key, const function<CellMask()>& creator)
+{
+  shared_future<value_type> pending;
+  promise<value_type> result;
+  size_t id = 0;
+  {
+    lock_guard<mutex> lock(itsMutex);
+    auto pos = itsMasks.find(key);
+    if (pos != itsMasks.end())
+      pending = pos->second.mask;
+    else
+    {
+      id = itsNextId++;
+      itsMasks.insert(make_pair(key, Entry{result.get_future().share(), id}));
+    }
+  }
+
+  if (pending.valid())
+    return pending.get();
+
+  try
+  {
+    auto mask = make_shared<const CellMask>(creator());
+    result.set_value(mask);
+    return mask;
+  }
+  catch (...)
+  {
+    {
+      lock_guard<mutex> lock(itsMutex);
+      auto pos = itsMasks.find(key);
+      if (pos != itsMasks.end() && pos->second.id == id)
+        itsMasks.erase(pos);
+    }
+    result.set_exception(current_exception());
+    throw;
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Number of cached masks
+ */
+// ----------------------------------------------------------------------
+
+size_t CellMaskCache::size() const
+{
+  lock_guard<mutex> lock(itsMutex);
+  return itsMasks.size();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Remove all cached masks
+ */
+// ----------------------------------------------------------------------
+
+void CellMaskCache::clear()
+{
+  lock_guard<mutex> lock(itsMutex);
+  itsMasks.clear();
+}
+
+}  // namespace Tron
+
+// ======================================================================
@@ -0,0 +1,310 @@
+// ======================================================================
+/*!
+ * \brief A bitmap of grid cells to be contoured
+ *
+ * The contourer normally calls grid.valid(i,j) for every cell on every
+ * call, which may be expensive if the adapter checks the coordinates of
+ * the cell corners. A validity mask is built once per grid geometry and
+ * reused for all parameters and levels:
+ *
+ *   const Tron::CellMask valid = Tron::CellMask::validity(grid);
+ *   MyContourer::fill(builder, grid, lolimit, hilimit, valid);
+ *
+ * Runs of invalid cells are skipped a word at a time, which helps most
+ * with grids which have large invalid areas such as geostationary
+ * satellite grids.
+ *
+ * Products such as "precipitation over land" would otherwise contour
+ * the full grid and intersect the result with a large polygon. With a
+ * cell mask the polygon is rasterized once per grid geometry, and the
+ * contourer simply skips the cells outside the region:
+ *
+ *   auto creator = [&] { return Tron::CellMask::rasterize(grid, rings) &= valid; };
+ *   auto mask = cache.get(key, creator);
+ *   MyContourer::fill(builder, grid, lolimit, hilimit, *mask);
+ *
+ * The mask replaces grid.valid(i,j) completely, hence a region mask must
+ * be intersected with the validity mask unless all cells are valid.
+ *
+ * A cell is in the region if its center, the mean of its corner
+ * coordinates, is inside the rings using the even-odd rule. Hence holes
+ * and multipolygons need no special handling, and the region boundary
+ * follows the cell edges.
+ *
+ * The bits are packed in 64 bit words, each row starting at a new word.
+ */
+// ======================================================================
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Tron
+{
+class CellMask
+{
+ public:
+  using word_type = std::uint64_t;
+
+  CellMask(std::size_t theWidth, std::size_t theHeight, bool theValue = false);
+  CellMask() = delete;
+
+  // Size in cells
+  std::size_t width() const { return itsWidth; }
+  std::size_t height() const { return itsHeight; }
+
+  bool test(std::size_t i, std::size_t j) const
+  {
+    return (itsBits[j * itsRowWords + i / 64] >> (i % 64)) & 1;
+  }
+
+  void set(std::size_t i, std::size_t j, bool theValue = true)
+  {
+    const word_type bit = word_type(1) << (i % 64);
+    word_type& word = itsBits[j * itsRowWords + i / 64];
+    if (theValue)
+      word |= bit;
+    else
+      word &= ~bit;
+  }
+
+  void fill(bool theValue);
+  std::size_t count() const;
+
+  CellMask& operator&=(const CellMask& theOther);
+  CellMask& operator|=(const CellMask& theOther);
+
+  // Call f(i,j) for the cells x1 <= i < x2, y1 <= j < y2 in the mask, returns the count
+  template <typename Function>
+  std::size_t for_each(std::size_t x1,
+                       std::size_t y1,
+                       std::size_t x2,
+                       std::size_t y2,
+                       Function theFunction) const;
+
+  template <typename Grid>
+  static CellMask validity(const Grid& theGrid);
+
+  template <typename Grid, typename Rings>
+  static CellMask rasterize(const Grid& theGrid, const Rings& theRings);
+
+ private:
+  void clear_padding();
+
+  std::size_t itsWidth;
+  std::size_t itsHeight;
+  std::size_t itsRowWords;
+  std::vector<word_type> itsBits;
+
+};  // class CellMask
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Cache for masks which depend only on the grid geometry
+ *
+ * The key should identify both the grid geometry and the region, for
+ * example a hash of the projection and the region name. The mask is
+ * created only once even if requested simultaneously from several
+ * threads. The mask is created outside the lock, hence requests for
+ * other keys are not blocked, while requests for the same key wait
+ * for the first one to finish.
+ */
+// ----------------------------------------------------------------------
+
+class CellMaskCache
+{
+ public:
+  using value_type = std::shared_ptr<const CellMask>;
+
+  value_type get(std::size_t theKey, const std::function<CellMask()>& theCreator);
+
+  // Includes the masks being created
+  std::size_t size() const;
+  void clear();
+
+ private:
+  // A ready or an in-flight mask. The id identifies the creator for
+  // removing a failed entry which has not been replaced meanwhile.
+  struct Entry
+  {
+    std::shared_future<value_type> mask;
+    std::size_t id;
+  };
+
+  mutable std::mutex itsMutex;
+  std::map<std::size_t, Entry> itsMasks;
+  std::size_t itsNextId = 0;
+
+};  // class CellMaskCache
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Iterate over the cells in a rectangle
+ *
+ * Zero words are skipped entirely, and the set bits of the other words
+ * are found by counting trailing zeros.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Function>
+std::size_t CellMask::for_each(
+    std::size_t x1, std::size_t y1, std::size_t x2, std::size_t y2, Function f) const
+{
+  if (x1 >= x2 || y1 >= y2)
+    return 0;
+
+  const std::size_t w1 = x1 / 64;
+  const std::size_t w2 = (x2 - 1) / 64;
+  const word_type firstmask = ~word_type(0) << (x1 % 64);
+  const word_type lastmask = (x2 % 64 == 0 ? ~word_type(0) : (word_type(1) << (x2 % 64)) - 1);
+
+  std::size_t count = 0;
+  for (std::size_t j = y1; j < y2; j++)
+  {
+    const word_type* row = &itsBits[j * itsRowWords];
+    for (std::size_t w = w1; w <= w2; w++)
+    {
+      word_type word = row[w];
+      if (w == w1)
+        word &= firstmask;
+      if (w == w2)
+        word &= lastmask;
+      while (word != 0)
+      {
+        f(w * 64 + __builtin_ctzll(word), j);
+        ++count;
+        word &= word - 1;
+      }
+    }
+  }
+  return count;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Build a mask of the cells for which grid.valid(i,j) is true
+ */
+// ----------------------------------------------------------------------
+
+template <typename Grid>
+CellMask CellMask::validity(const Grid& grid)
+{
+  const std::size_t width = grid.width() - 1;
+  const std::size_t height = grid.height() - 1;
+  CellMask mask(width, height);
+
+  for (std::size_t j = 0; j < height; j++)
+  {
+    word_type* row = &mask.itsBits[j * mask.itsRowWords];
+    for (std::size_t i = 0; i < width; i++)
+      if (grid.valid(i, j))
+        row[i / 64] |= word_type(1) << (i % 64);
+  }
+  return mask;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Rasterize polygon rings into a mask for the cells of a grid
+ *
+ * The rings may be any containers of points with first and second
+ * members, for example Ring objects. The edges are bucketed by y so
+ * that each cell center is tested only against the edges near it.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Grid, typename Rings>
+CellMask CellMask::rasterize(const Grid& grid, const Rings& rings)
+{
+  const std::size_t width = grid.width() - 1;
+  const std::size_t height = grid.height() - 1;
+  CellMask mask(width, height);
+
+  struct Segment
+  {
+    double x1, y1, x2, y2;
+  };
+
+  std::vector<Segment> segments;
+  for (const auto& ring : rings)
+  {
+    auto it = ring.begin();
+    if (it == ring.end())
+      continue;
+    const auto first = *it;
+    auto prev = first;
+    for (++it; it != ring.end(); ++it)
+    {
+      segments.push_back(
+          Segment{double(prev.first), double(prev.second), double(it->first), double(it->second)});
+      prev = *it;
+    }
+    // Close the ring if necessary
+    if (prev != first)
+      segments.push_back(Segment{
+          double(prev.first), double(prev.second), double(first.first), double(first.second)});
+  }
+
+  if (segments.empty())
+    return mask;
+
+  double ymin = segments[0].y1;
+  double ymax = ymin;
+  for (const auto& s : segments)
+  {
+    ymin = std::min(ymin, std::min(s.y1, s.y2));
+    ymax = std::max(ymax, std::max(s.y1, s.y2));
+  }
+  if (!(ymax > ymin))
+    return mask;
+
+  const std::size_t nbins = std::max<std::size_t>(1, std::min<std::size_t>(segments.size(), 4096));
+  const double scale = nbins / (ymax - ymin);
+  auto bin = [&](double y)
+  { return std::min(nbins - 1, static_cast<std::size_t>(std::max(0.0, (y - ymin) * scale))); };
+
+  std::vector<std::vector<std::uint32_t>> bins(nbins);
+  for (std::size_t k = 0; k < segments.size(); k++)
+  {
+    const auto& s = segments[k];
+    if (s.y1 == s.y2)
+      continue;  // never crosses a horizontal ray
+    const std::size_t last = bin(std::max(s.y1, s.y2));
+    for (std::size_t b = bin(std::min(s.y1, s.y2)); b <= last; b++)
+      bins[b].push_back(static_cast<std::uint32_t>(k));
+  }
+
+  for (std::size_t j = 0; j < height; j++)
+    for (std::size_t i = 0; i < width; i++)
+    {
+      const double x =
+          (grid.x(i, j) + grid.x(i + 1, j) + grid.x(i, j + 1) + grid.x(i + 1, j + 1)) / 4;
+      const double y =
+          (grid.y(i, j) + grid.y(i + 1, j) + grid.y(i, j + 1) + grid.y(i + 1, j + 1)) / 4;
+      if (!(y >= ymin && y <= ymax))
+        continue;
+
+      bool inside = false;
+      for (auto k : bins[bin(y)])
+      {
+        const auto& s = segments[k];
+        if ((s.y1 > y) != (s.y2 > y) && x < (s.x2 - s.x1) * (y - s.y1) / (s.y2 - s.y1) + s.x1)
+          inside = !inside;
+      }
+      if (inside)
+        mask.set(i, j);
+    }
+
+  return mask;
+}
+
+}  // namespace Tron
+
+// ======================================================================
@@ -32,6 +32,11 @@
  *     void closepath();
  * }
  *
+ * Such an adapter can be driven with PathBuilder. The other builders
+ * are FmiBuilder (GEOS), WkbBuilder (WKB/TWKB), FlatBuilder (flat
+ * coordinate and offset arrays) and MultiBandBuilder (arcs shared by
+ * several bands, see also Coverage.h).
+ *
  * Note: We assume grid coordinates are upright so that increasing
  *       j in grid(i,j) implies increasing Y-coordinate.
  *
@@ -47,18 +52,42 @@
  *
  * Note: valid(i,j) may be a method which returns always true if the grid
  *       is known to be fully valid topologically.
+ *
+ * Note: The fill and line overloads taking a CellMask use the mask
+ *       instead of calling valid(i,j) for each cell. Build the mask once
+ *       per grid geometry with CellMask::validity, see CellMask.h.
+ *
+ * Note: Global grids which wrap around in longitude can be contoured
+ *       without a gap at the antimeridian using PeriodicGrid.h.
+ *
+ * Note: Smoothed data can be contoured without smoothing the full grid
+ *       first using SmoothedGridView.h and the overloads which take
+ *       only coordinate hints.
+ *
+ * Note: Grids whose coordinates are expensive to compute can take them
+ *       from a CoordinateCache shared by all parameters of the same
+ *       geometry, see CoordinateCache.h.
+ *
+ * All methods accept an optional Stats pointer as the last argument for
+ * collecting timing information and counters. See Stats.h for details.
  */
 // ======================================================================
 
 #pragma once
 
+#include "BoxClipper.h"
+#include "CellMask.h"
 #include "CoordinateHints.h"
 #include "Edge.h"
 #include "FlipGrid.h"
 #include "FlipSet.h"
 #include "Hints.h"
 #include "Missing.h"
+#include "Stats.h"
+#include <algorithm>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace Tron
 {
@@ -71,6 +100,7 @@ class Contourer : public Interpolation<Traits>
 {
  private:
   typedef FlipSet<Edge<Traits> > MyFlipSet;
+  typedef BoxClipper<Traits> MyClipper;
 
  public:
   typedef typename Traits::coord_type coord_type;
@@ -82,38 +112,24 @@ class Contourer : public Interpolation<Traits>
    * Calculate polygon surrounding the given value range.
    */
 
-  static void fill(PathAdapter& path, const Grid& grid, value_type lolimit, value_type hilimit)
+  static void fill(PathAdapter& path,
+                   const Grid& grid,
+                   value_type lolimit,
+                   value_type hilimit,
+                   Stats* stats = nullptr)
   {
     MyFlipSet flipset;
     FlipGrid flipgrid(grid.width(), grid.height());
 
-    for (typename Grid::size_type j = 0; j < grid.height() - 1; j++)
-      for (typename Grid::size_type i = 0; i < grid.width() - 1; i++)
-      {
-        if (grid.valid(i, j))
-          Contourer::rectangle(grid.x(i, j),
-                               grid.y(i, j),
-                               grid(i, j),
-                               grid.x(i, j + 1),
-                               grid.y(i, j + 1),
-                               grid(i, j + 1),
-                               grid.x(i + 1, j + 1),
-                               grid.y(i + 1, j + 1),
-                               grid(i + 1, j + 1),
-                               grid.x(i + 1, j),
-                               grid.y(i + 1, j),
-                               grid(i + 1, j),
-                               i,
-                               j,
-                               lolimit,
-                               hilimit,
-                               flipset,
-                               flipgrid);
-      }
+    {
+      StageTimer timer(stats, Stats::CellPass);
+      std::size_t cells = fill_cells(
+          grid, 0, 0, grid.width() - 1, grid.height() - 1, lolimit, hilimit, flipset, flipgrid);
+      if (stats)
+        stats->cells += cells;
+    }
 
-    flipgrid.copy(grid, flipset);
-    flipset.prepare();
-    Builder::fill<Traits>(flipset.edges(), path);
+    fill_finish(path, grid, flipset, flipgrid, stats);
   }
 
   /*
@@ -125,45 +141,29 @@ class Contourer : public Interpolation<Traits>
                    const Grid& grid,
                    value_type lolimit,
                    value_type hilimit,
-                   const hints_type& hints)
+                   const hints_type& hints,
+                   Stats* stats = nullptr)
   {
     typename hints_type::rectangles rects = hints.get_rectangles(lolimit, hilimit);
 
     MyFlipSet flipset;
     FlipGrid flipgrid(grid.width(), grid.height());
 
-    for (typename hints_type::rectangles::const_iterator it = rects.begin(), end = rects.end();
-         it != end;
-         ++it)
     {
-      for (typename Grid::size_type j = it->y1; j < it->y2; j++)
-        for (typename Grid::size_type i = it->x1; i < it->x2; i++)
-        {
-          if (grid.valid(i, j))
-            Contourer::rectangle(grid.x(i, j),
-                                 grid.y(i, j),
-                                 grid(i, j),
-                                 grid.x(i, j + 1),
-                                 grid.y(i, j + 1),
-                                 grid(i, j + 1),
-                                 grid.x(i + 1, j + 1),
-                                 grid.y(i + 1, j + 1),
-                                 grid(i + 1, j + 1),
-                                 grid.x(i + 1, j),
-                                 grid.y(i + 1, j),
-                                 grid(i + 1, j),
-                                 static_cast<int>(i),
-                                 static_cast<int>(j),
-                                 lolimit,
-                                 hilimit,
-                                 flipset,
-                                 flipgrid);
-        }
+      StageTimer timer(stats, Stats::CellPass);
+      std::size_t cells = 0;
+      for (typename hints_type::rectangles::const_iterator it = rects.begin(), end = rects.end();
+           it != end;
+           ++it)
+      {
+        cells +=
+            fill_cells(grid, it->x1, it->y1, it->x2, it->y2, lolimit, hilimit, flipset, flipgrid);
+      }
+      if (stats)
+        stats->cells += cells;
     }
 
-    flipgrid.copy(grid, flipset);
-    flipset.prepare();
-    Builder::fill<Traits>(flipset.edges(), path);
+    fill_finish(path, grid, flipset, flipgrid, stats);
   }
 
   /*
@@ -179,7 +179,8 @@ class Contourer : public Interpolation<Traits>
                    coord_type xmin,
                    coord_type ymin,
                    coord_type xmax,
-                   coord_type ymax)
+                   coord_type ymax,
+                   Stats* stats = nullptr)
   {
     typename hints_type::rectangles rects = hints.get_rectangles(lolimit, hilimit);
     typename coordinate_hints_type::rectangles crects =
@@ -190,81 +191,188 @@ class Contourer : public Interpolation<Traits>
 
     // Process only overlapping value/coordinate rectangles
 
-    for (typename hints_type::rectangles::const_iterator it = rects.begin(), iend = rects.end();
-         it != iend;
-         ++it)
     {
-      for (typename coordinate_hints_type::rectangles::const_iterator jt = crects.begin(),
-                                                                      jend = crects.end();
-           jt != jend;
-           ++jt)
+      StageTimer timer(stats, Stats::CellPass);
+      std::size_t cells = 0;
+      for (typename hints_type::rectangles::const_iterator it = rects.begin(), iend = rects.end();
+           it != iend;
+           ++it)
       {
-        // Overlapping area
-        typename Grid::size_type x1 = std::max(it->x1, jt->x1);
-        typename Grid::size_type y1 = std::max(it->y1, jt->y1);
-        typename Grid::size_type x2 = std::min(it->x2, jt->x2);
-        typename Grid::size_type y2 = std::min(it->y2, jt->y2);
-
-        if (x2 > x1 && y2 > y1)
+        for (typename coordinate_hints_type::rectangles::const_iterator jt = crects.begin(),
+                                                                        jend = crects.end();
+             jt != jend;
+             ++jt)
         {
-          for (typename Grid::size_type j = y1; j < y2; j++)
-            for (typename Grid::size_type i = x1; i < x2; i++)
-              if (grid.valid(i, j))
-                Contourer::rectangle(grid.x(i, j),
-                                     grid.y(i, j),
-                                     grid(i, j),
-                                     grid.x(i, j + 1),
-                                     grid.y(i, j + 1),
-                                     grid(i, j + 1),
-                                     grid.x(i + 1, j + 1),
-                                     grid.y(i + 1, j + 1),
-                                     grid(i + 1, j + 1),
-                                     grid.x(i + 1, j),
-                                     grid.y(i + 1, j),
-                                     grid(i + 1, j),
-                                     static_cast<int>(i),
-                                     static_cast<int>(j),
+          // Overlapping area
+          typename Grid::size_type x1 = std::max(it->x1, jt->x1);
+          typename Grid::size_type y1 = std::max(it->y1, jt->y1);
+          typename Grid::size_type x2 = std::min(it->x2, jt->x2);
+          typename Grid::size_type y2 = std::min(it->y2, jt->y2);
+
+          if (x2 > x1 && y2 > y1)
+            cells += fill_cells(grid, x1, y1, x2, y2, lolimit, hilimit, flipset, flipgrid);
+        }
+      }
+      if (stats)
+        stats->cells += cells;
+    }
+
+    fill_finish(path, grid, flipset, flipgrid, stats);
+  }
+
+  /*
+   * Calculate polygon surrounding the given value range in a specific area
+   * without value hints. Only the data values in the area are accessed.
+   */
+
+  static void fill(PathAdapter& path,
+                   const Grid& grid,
+                   value_type lolimit,
+                   value_type hilimit,
+                   const coordinate_hints_type& coordinate_hints,
+                   coord_type xmin,
+                   coord_type ymin,
+                   coord_type xmax,
+                   coord_type ymax,
+                   Stats* stats = nullptr)
+  {
+    typename coordinate_hints_type::rectangles crects =
+        coordinate_hints.get_rectangles(xmin, ymin, xmax, ymax);
+
+    MyFlipSet flipset;
+    FlipGrid flipgrid(grid.width(), grid.height());
+
+    {
+      StageTimer timer(stats, Stats::CellPass);
+      std::size_t cells = 0;
+      for (const auto& rect : crects)
+        cells += fill_cells(
+            grid, rect.x1, rect.y1, rect.x2, rect.y2, lolimit, hilimit, flipset, flipgrid);
+      if (stats)
+        stats->cells += cells;
+    }
+
+    fill_finish(path, grid, flipset, flipgrid, stats);
+  }
+
+  /*
+   * Calculate polygon surrounding the given value range using a precomputed
+   * cell mask instead of grid.valid(). The mask is usually built once per grid
+   * geometry with CellMask::validity, possibly restricted to a region.
+   */
+
+  static void fill(PathAdapter& path,
+                   const Grid& grid,
+                   value_type lolimit,
+                   value_type hilimit,
+                   const CellMask& mask,
+                   Stats* stats = nullptr)
+  {
+    check_mask(grid, mask);
+    MyFlipSet flipset;
+    FlipGrid flipgrid(grid.width(), grid.height());
+
+    {
+      StageTimer timer(stats, Stats::CellPass);
+      std::size_t cells = fill_cells(grid,
+                                     0,
+                                     0,
+                                     grid.width() - 1,
+                                     grid.height() - 1,
                                      lolimit,
                                      hilimit,
+                                     mask,
                                      flipset,
                                      flipgrid);
-        }
-      }
+      if (stats)
+        stats->cells += cells;
     }
 
-    flipgrid.copy(grid, flipset);
-    flipset.prepare();
-    Builder::fill<Traits>(flipset.edges(), path);
+    fill_finish(path, grid, flipset, flipgrid, stats);
+  }
+
+  /*
+   * Calculate polygon surrounding the given value range using both hints
+   * and a precomputed cell mask.
+   */
+
+  static void fill(PathAdapter& path,
+                   const Grid& grid,
+                   value_type lolimit,
+                   value_type hilimit,
+                   const hints_type& hints,
+                   const CellMask& mask,
+                   Stats* stats = nullptr)
+  {
+    check_mask(grid, mask);
+    typename hints_type::rectangles rects = hints.get_rectangles(lolimit, hilimit);
+
+    MyFlipSet flipset;
+    FlipGrid flipgrid(grid.width(), grid.height());
+
+    {
+      StageTimer timer(stats, Stats::CellPass);
+      std::size_t cells = 0;
+      for (const auto& rect : rects)
+        cells += fill_cells(
+            grid, rect.x1, rect.y1, rect.x2, rect.y2, lolimit, hilimit, mask, flipset, flipgrid);
+      if (stats)
+        stats->cells += cells;
+    }
+
+    fill_finish(path, grid, flipset, flipgrid, stats);
+  }
+
+  /*
+   * Calculate polygons for all the bands between consecutive limits.
+   * The limits must be increasing, missing values are allowed only
+   * at the ends and mean -inf and +inf. The builder is called once
+   * per band in order, hence this is intended for builders collecting
+   * several bands such as MultiBandBuilder and FlatBuilder.
+   *
+   * This is a convenience only, the work is the same as calling fill
+   * for each band: every band makes its own pass over the cells and
+   * builds the boundaries it shares with its neighbours. Only
+   * MultiBandBuilder merges the shared boundaries afterwards.
+   */
+
+  static void fill(PathAdapter& path,
+                   const Grid& grid,
+                   const std::vector<value_type>& limits,
+                   Stats* stats = nullptr)
+  {
+    // NaN acts as an open limit even if it is not a missing value for the traits
+    auto open = [](value_type value) { return Contourer::missing(value) || value != value; };
+
+    const std::size_t n = limits.size();
+    for (std::size_t i = 1; i + 1 < n; i++)
+      if (open(limits[i]))
+        throw std::runtime_error("Only the first and last contour limits may be missing");
+    for (std::size_t i = 1; i < n; i++)
+      if (!open(limits[i - 1]) && !open(limits[i]) && !(limits[i - 1] < limits[i]))
+        throw std::runtime_error("Contour limits must be in increasing order");
+
+    for (std::size_t i = 1; i < n; i++)
+      fill(path, grid, limits[i - 1], limits[i], stats);
   }
 
   /*
    * Calculate isoline for the given value
    */
 
-  static void line(PathAdapter& path, const Grid& grid, value_type value)
+  static void line(PathAdapter& path, const Grid& grid, value_type value, Stats* stats = nullptr)
   {
     MyFlipSet flipset;
 
-    for (typename Grid::size_type j = 0; j < grid.height() - 1; j++)
-      for (typename Grid::size_type i = 0; i < grid.width() - 1; i++)
-        if (grid.valid(i, j))
-          Contourer::rectangle(grid.x(i, j),
-                               grid.y(i, j),
-                               grid(i, j),
-                               grid.x(i, j + 1),
-                               grid.y(i, j + 1),
-                               grid(i, j + 1),
-                               grid.x(i + 1, j + 1),
-                               grid.y(i + 1, j + 1),
-                               grid(i + 1, j + 1),
-                               grid.x(i + 1, j),
-                               grid.y(i + 1, j),
-                               grid(i + 1, j),
-                               value,
-                               flipset);
-
-    flipset.prepare();
-    Builder::line<Traits>(flipset.edges(), path);
+    {
+      StageTimer timer(stats, Stats::CellPass);
+      std::size_t cells =
+          line_cells(grid, 0, 0, grid.width() - 1, grid.height() - 1, value, flipset);
+      if (stats)
+        stats->cells += cells;
+    }
+
+    line_finish(path, flipset, stats);
   }
 
   /*
@@ -272,37 +380,30 @@ class Contourer : public Interpolation<Traits>
    * data values to contour only areas of interest.
    */
 
-  static void line(PathAdapter& path, const Grid& grid, value_type value, const hints_type& hints)
+  static void line(PathAdapter& path,
+                   const Grid& grid,
+                   value_type value,
+                   const hints_type& hints,
+                   Stats* stats = nullptr)
   {
     typename hints_type::rectangles rects = hints.get_rectangles(value);
 
     MyFlipSet flipset;
 
-    for (typename hints_type::rectangles::const_iterator it = rects.begin(), end = rects.end();
-         it != end;
-         ++it)
     {
-      for (typename Grid::size_type j = it->y1; j < it->y2; j++)
-        for (typename Grid::size_type i = it->x1; i < it->x2; i++)
-          if (grid.valid(i, j))
-            Contourer::rectangle(grid.x(i, j),
-                                 grid.y(i, j),
-                                 grid(i, j),
-                                 grid.x(i, j + 1),
-                                 grid.y(i, j + 1),
-                                 grid(i, j + 1),
-                                 grid.x(i + 1, j + 1),
-                                 grid.y(i + 1, j + 1),
-                                 grid(i + 1, j + 1),
-                                 grid.x(i + 1, j),
-                                 grid.y(i + 1, j),
-                                 grid(i + 1, j),
-                                 value,
-                                 flipset);
+      StageTimer timer(stats, Stats::CellPass);
+      std::size_t cells = 0;
+      for (typename hints_type::rectangles::const_iterator it = rects.begin(), end = rects.end();
+           it != end;
+           ++it)
+      {
+        cells += line_cells(grid, it->x1, it->y1, it->x2, it->y2, value, flipset);
+      }
+      if (stats)
+        stats->cells += cells;
     }
 
-    flipset.prepare();
-    Builder::line<Traits>(flipset.edges(), path);
+    line_finish(path, flipset, stats);
   }
 
   /*
@@ -317,7 +418,8 @@ class Contourer : public Interpolation<Traits>
                    coord_type xmin,
                    coord_type ymin,
                    coord_type xmax,
-                   coord_type ymax)
+                   coord_type ymax,
+                   Stats* stats = nullptr)
 
   {
     typename hints_type::rectangles rects = hints.get_rectangles(value);
@@ -326,46 +428,623 @@ class Contourer : public Interpolation<Traits>
 
     MyFlipSet flipset;
 
-    for (typename hints_type::rectangles::const_iterator it = rects.begin(), iend = rects.end();
-         it != iend;
-         ++it)
     {
-      for (typename coordinate_hints_type::rectangles::const_iterator jt = crects.begin(),
-                                                                      jend = crects.end();
-           jt != jend;
-           ++jt)
+      StageTimer timer(stats, Stats::CellPass);
+      std::size_t cells = 0;
+      for (typename hints_type::rectangles::const_iterator it = rects.begin(), iend = rects.end();
+           it != iend;
+           ++it)
       {
-        // Overlapping area
-        typename Grid::size_type x1 = std::max(it->x1, jt->x1);
-        typename Grid::size_type y1 = std::max(it->y1, jt->y1);
-        typename Grid::size_type x2 = std::min(it->x2, jt->x2);
-        typename Grid::size_type y2 = std::min(it->y2, jt->y2);
+        for (typename coordinate_hints_type::rectangles::const_iterator jt = crects.begin(),
+                                                                        jend = crects.end();
+             jt != jend;
+             ++jt)
+        {
+          // Overlapping area
+          typename Grid::size_type x1 = std::max(it->x1, jt->x1);
+          typename Grid::size_type y1 = std::max(it->y1, jt->y1);
+          typename Grid::size_type x2 = std::min(it->x2, jt->x2);
+          typename Grid::size_type y2 = std::min(it->y2, jt->y2);
+
+          if (x2 > x1 && y2 > y1)
+            cells += line_cells(grid, x1, y1, x2, y2, value, flipset);
+        }
+      }
+      if (stats)
+        stats->cells += cells;
+    }
+
+    line_finish(path, flipset, stats);
+  }
+
+  /*
+   * Calculate an isoline in the given area without value hints.
+   */
+
+  static void line(PathAdapter& path,
+                   const Grid& grid,
+                   value_type value,
+                   const coordinate_hints_type& coordinate_hints,
+                   coord_type xmin,
+                   coord_type ymin,
+                   coord_type xmax,
+                   coord_type ymax,
+                   Stats* stats = nullptr)
+  {
+    typename coordinate_hints_type::rectangles crects =
+        coordinate_hints.get_rectangles(xmin, ymin, xmax, ymax);
+
+    MyFlipSet flipset;
+
+    {
+      StageTimer timer(stats, Stats::CellPass);
+      std::size_t cells = 0;
+      for (const auto& rect : crects)
+        cells += line_cells(grid, rect.x1, rect.y1, rect.x2, rect.y2, value, flipset);
+      if (stats)
+        stats->cells += cells;
+    }
+
+    line_finish(path, flipset, stats);
+  }
+
+  /*
+   * Calculate isoline for the given value using a precomputed cell mask.
+   */
 
-        if (x2 > x1 && y2 > y1)
+  static void line(PathAdapter& path,
+                   const Grid& grid,
+                   value_type value,
+                   const CellMask& mask,
+                   Stats* stats = nullptr)
+  {
+    check_mask(grid, mask);
+    MyFlipSet flipset;
+
+    {
+      StageTimer timer(stats, Stats::CellPass);
+      std::size_t cells =
+          line_cells(grid, 0, 0, grid.width() - 1, grid.height() - 1, value, mask, flipset);
+      if (stats)
+        stats->cells += cells;
+    }
+
+    line_finish(path, flipset, stats);
+  }
+
+  /*
+   * Calculate isoline for the given value using both hints and a
+   * precomputed cell mask.
+   */
+
+  static void line(PathAdapter& path,
+                   const Grid& grid,
+                   value_type value,
+                   const hints_type& hints,
+                   const CellMask& mask,
+                   Stats* stats = nullptr)
+  {
+    check_mask(grid, mask);
+    typename hints_type::rectangles rects = hints.get_rectangles(value);
+
+    MyFlipSet flipset;
+
+    {
+      StageTimer timer(stats, Stats::CellPass);
+      std::size_t cells = 0;
+      for (const auto& rect : rects)
+        cells += line_cells(grid, rect.x1, rect.y1, rect.x2, rect.y2, value, mask, flipset);
+      if (stats)
+        stats->cells += cells;
+    }
+
+    line_finish(path, flipset, stats);
+  }
+
+  /*
+   * Calculate polygons for the given value range clipped to the given area.
+   * Unlike the area limited fill above, the edges are cut at the bounding
+   * box in the cell pass, hence no geometry outside the box is produced.
+   */
+
+  static void fill_clipped(PathAdapter& path,
+                           const Grid& grid,
+                           value_type lolimit,
+                           value_type hilimit,
+                           coord_type xmin,
+                           coord_type ymin,
+                           coord_type xmax,
+                           coord_type ymax,
+                           Stats* stats = nullptr)
+  {
+    const MyClipper clipper(xmin, ymin, xmax, ymax);
+    MyFlipSet flipset;
+    FlipGrid flipgrid(grid.width(), grid.height());
+
+    {
+      StageTimer timer(stats, Stats::CellPass);
+      std::size_t cells = fill_cells_clipped(grid,
+                                             0,
+                                             0,
+                                             grid.width() - 1,
+                                             grid.height() - 1,
+                                             lolimit,
+                                             hilimit,
+                                             clipper,
+                                             flipset,
+                                             flipgrid);
+      if (stats)
+        stats->cells += cells;
+    }
+
+    fill_finish(path, grid, flipset, flipgrid, stats);
+  }
+
+  /*
+   * Calculate clipped polygons using hints to find the cells of interest.
+   */
+
+  static void fill_clipped(PathAdapter& path,
+                           const Grid& grid,
+                           value_type lolimit,
+                           value_type hilimit,
+                           const hints_type& hints,
+                           const coordinate_hints_type& coordinate_hints,
+                           coord_type xmin,
+                           coord_type ymin,
+                           coord_type xmax,
+                           coord_type ymax,
+                           Stats* stats = nullptr)
+  {
+    const MyClipper clipper(xmin, ymin, xmax, ymax);
+
+    typename hints_type::rectangles rects = hints.get_rectangles(lolimit, hilimit);
+    typename coordinate_hints_type::rectangles crects =
+        coordinate_hints.get_rectangles(xmin, ymin, xmax, ymax);
+
+    MyFlipSet flipset;
+    FlipGrid flipgrid(grid.width(), grid.height());
+
+    {
+      StageTimer timer(stats, Stats::CellPass);
+      std::size_t cells = 0;
+      for (const auto& rect : rects)
+        for (const auto& crect : crects)
+        {
+          typename Grid::size_type x1 = std::max(rect.x1, crect.x1);
+          typename Grid::size_type y1 = std::max(rect.y1, crect.y1);
+          typename Grid::size_type x2 = std::min(rect.x2, crect.x2);
+          typename Grid::size_type y2 = std::min(rect.y2, crect.y2);
+
+          if (x2 > x1 && y2 > y1)
+            cells += fill_cells_clipped(
+                grid, x1, y1, x2, y2, lolimit, hilimit, clipper, flipset, flipgrid);
+        }
+      if (stats)
+        stats->cells += cells;
+    }
+
+    fill_finish(path, grid, flipset, flipgrid, stats);
+  }
+
+  /*
+   * Calculate an isoline clipped to the given area.
+   */
+
+  static void line_clipped(PathAdapter& path,
+                           const Grid& grid,
+                           value_type value,
+                           coord_type xmin,
+                           coord_type ymin,
+                           coord_type xmax,
+                           coord_type ymax,
+                           Stats* stats = nullptr)
+  {
+    const MyClipper clipper(xmin, ymin, xmax, ymax);
+    MyFlipSet flipset;
+
+    {
+      StageTimer timer(stats, Stats::CellPass);
+      std::size_t cells = line_cells_clipped(
+          grid, 0, 0, grid.width() - 1, grid.height() - 1, value, clipper, flipset);
+      if (stats)
+        stats->cells += cells;
+    }
+
+    line_finish(path, flipset, stats);
+  }
+
+  /*
+   * Calculate a clipped isoline using hints to find the cells of interest.
+   */
+
+  static void line_clipped(PathAdapter& path,
+                           const Grid& grid,
+                           value_type value,
+                           const hints_type& hints,
+                           const coordinate_hints_type& coordinate_hints,
+                           coord_type xmin,
+                           coord_type ymin,
+                           coord_type xmax,
+                           coord_type ymax,
+                           Stats* stats = nullptr)
+  {
+    const MyClipper clipper(xmin, ymin, xmax, ymax);
+
+    typename hints_type::rectangles rects = hints.get_rectangles(value);
+    typename coordinate_hints_type::rectangles crects =
+        coordinate_hints.get_rectangles(xmin, ymin, xmax, ymax);
+
+    MyFlipSet flipset;
+
+    {
+      StageTimer timer(stats, Stats::CellPass);
+      std::size_t cells = 0;
+      for (const auto& rect : rects)
+        for (const auto& crect : crects)
+        {
+          typename Grid::size_type x1 = std::max(rect.x1, crect.x1);
+          typename Grid::size_type y1 = std::max(rect.y1, crect.y1);
+          typename Grid::size_type x2 = std::min(rect.x2, crect.x2);
+          typename Grid::size_type y2 = std::min(rect.y2, crect.y2);
+
+          if (x2 > x1 && y2 > y1)
+            cells += line_cells_clipped(grid, x1, y1, x2, y2, value, clipper, flipset);
+        }
+      if (stats)
+        stats->cells += cells;
+    }
+
+    line_finish(path, flipset, stats);
+  }
+
+ private:
+  /*
+   * Contour a single cell in fill mode
+   */
+
+  static void fill_cell(const Grid& grid,
+                        typename Grid::size_type i,
+                        typename Grid::size_type j,
+                        value_type lolimit,
+                        value_type hilimit,
+                        MyFlipSet& flipset,
+                        FlipGrid& flipgrid)
+  {
+    Contourer::rectangle(grid.x(i, j),
+                         grid.y(i, j),
+                         grid(i, j),
+                         grid.x(i, j + 1),
+                         grid.y(i, j + 1),
+                         grid(i, j + 1),
+                         grid.x(i + 1, j + 1),
+                         grid.y(i + 1, j + 1),
+                         grid(i + 1, j + 1),
+                         grid.x(i + 1, j),
+                         grid.y(i + 1, j),
+                         grid(i + 1, j),
+                         static_cast<int>(i),
+                         static_cast<int>(j),
+                         lolimit,
+                         hilimit,
+                         flipset,
+                         flipgrid);
+  }
+
+  /*
+   * Contour a single cell in line mode
+   */
+
+  static void line_cell(const Grid& grid,
+                        typename Grid::size_type i,
+                        typename Grid::size_type j,
+                        value_type value,
+                        MyFlipSet& flipset)
+  {
+    Contourer::rectangle(grid.x(i, j),
+                         grid.y(i, j),
+                         grid(i, j),
+                         grid.x(i, j + 1),
+                         grid.y(i, j + 1),
+                         grid(i, j + 1),
+                         grid.x(i + 1, j + 1),
+                         grid.y(i + 1, j + 1),
+                         grid(i + 1, j + 1),
+                         grid.x(i + 1, j),
+                         grid.y(i + 1, j),
+                         grid(i + 1, j),
+                         value,
+                         flipset);
+  }
+
+  /*
+   * Contour the valid cells x1 <= i < x2, y1 <= j < y2 in fill mode.
+   * Returns the number of cells processed.
+   */
+
+  static std::size_t fill_cells(const Grid& grid,
+                                typename Grid::size_type x1,
+                                typename Grid::size_type y1,
+                                typename Grid::size_type x2,
+                                typename Grid::size_type y2,
+                                value_type lolimit,
+                                value_type hilimit,
+                                MyFlipSet& flipset,
+                                FlipGrid& flipgrid)
+  {
+    std::size_t cells = 0;
+    for (typename Grid::size_type j = y1; j < y2; j++)
+      for (typename Grid::size_type i = x1; i < x2; i++)
+      {
+        if (grid.valid(i, j))
+        {
+          ++cells;
+          fill_cell(grid, i, j, lolimit, hilimit, flipset, flipgrid);
+        }
+      }
+    return cells;
+  }
+
+  /*
+   * Contour the cells x1 <= i < x2, y1 <= j < y2 in the mask in fill mode.
+   * Runs of cells outside the mask are skipped a word at a time.
+   */
+
+  static std::size_t fill_cells(const Grid& grid,
+                                typename Grid::size_type x1,
+                                typename Grid::size_type y1,
+                                typename Grid::size_type x2,
+                                typename Grid::size_type y2,
+                                value_type lolimit,
+                                value_type hilimit,
+                                const CellMask& mask,
+                                MyFlipSet& flipset,
+                                FlipGrid& flipgrid)
+  {
+    return mask.for_each(x1,
+                         y1,
+                         x2,
+                         y2,
+                         [&](std::size_t i, std::size_t j)
+                         { fill_cell(grid, i, j, lolimit, hilimit, flipset, flipgrid); });
+  }
+
+  /*
+   * Contour the valid cells x1 <= i < x2, y1 <= j < y2 in line mode.
+   * Returns the number of cells processed.
+   */
+
+  static std::size_t line_cells(const Grid& grid,
+                                typename Grid::size_type x1,
+                                typename Grid::size_type y1,
+                                typename Grid::size_type x2,
+                                typename Grid::size_type y2,
+                                value_type value,
+                                MyFlipSet& flipset)
+  {
+    std::size_t cells = 0;
+    for (typename Grid::size_type j = y1; j < y2; j++)
+      for (typename Grid::size_type i = x1; i < x2; i++)
+      {
+        if (grid.valid(i, j))
+        {
+          ++cells;
+          line_cell(grid, i, j, value, flipset);
+        }
+      }
+    return cells;
+  }
+
+  /*
+   * Contour the cells x1 <= i < x2, y1 <= j < y2 in the mask in line mode.
+   */
+
+  static std::size_t line_cells(const Grid& grid,
+                                typename Grid::size_type x1,
+                                typename Grid::size_type y1,
+                                typename Grid::size_type x2,
+                                typename Grid::size_type y2,
+                                value_type value,
+                                const CellMask& mask,
+                                MyFlipSet& flipset)
+  {
+    return mask.for_each(x1,
+                         y1,
+                         x2,
+                         y2,
+                         [&](std::size_t i, std::size_t j)
+                         { line_cell(grid, i, j, value, flipset); });
+  }
+
+  static void check_mask(const Grid& grid, const CellMask& mask)
+  {
+    if (mask.width() + 1 != static_cast<std::size_t>(grid.width()) ||
+        mask.height() + 1 != static_cast<std::size_t>(grid.height()))
+      throw std::runtime_error("Cell mask size does not match the grid");
+  }
+
+  /*
+   * Corner coordinates of a cell as a 2x2 grid for FlipGrid::copy
+   */
+
+  class CellView
+  {
+   public:
+    CellView(const Grid& grid, typename Grid::size_type i, typename Grid::size_type j)
+        : itsGrid(grid), itsI(i), itsJ(j)
+    {
+    }
+    coord_type x(std::size_t i, std::size_t j) const { return itsGrid.x(itsI + i, itsJ + j); }
+    coord_type y(std::size_t i, std::size_t j) const { return itsGrid.y(itsI + i, itsJ + j); }
+
+   private:
+    const Grid& itsGrid;
+    typename Grid::size_type itsI;
+    typename Grid::size_type itsJ;
+  };
+
+  /*
+   * Placement of a cell with respect to the clipping box
+   */
+
+  static typename MyClipper::Placement cell_placement(const Grid& grid,
+                                                      typename Grid::size_type i,
+                                                      typename Grid::size_type j,
+                                                      const MyClipper& clipper)
+  {
+    const coord_type xs[4] = {
+        grid.x(i, j), grid.x(i, j + 1), grid.x(i + 1, j + 1), grid.x(i + 1, j)};
+    const coord_type ys[4] = {
+        grid.y(i, j), grid.y(i, j + 1), grid.y(i + 1, j + 1), grid.y(i + 1, j)};
+    const auto xr = std::minmax_element(xs, xs + 4);
+    const auto yr = std::minmax_element(ys, ys + 4);
+    return clipper.placement(*xr.first, *yr.first, *xr.second, *yr.second);
+  }
+
+  /*
+   * Contour the valid cells x1 <= i < x2, y1 <= j < y2 in fill mode
+   * clipping the cells which straddle the box. Cells outside the box
+   * are not counted as processed.
+   */
+
+  static std::size_t fill_cells_clipped(const Grid& grid,
+                                        typename Grid::size_type x1,
+                                        typename Grid::size_type y1,
+                                        typename Grid::size_type x2,
+                                        typename Grid::size_type y2,
+                                        value_type lolimit,
+                                        value_type hilimit,
+                                        const MyClipper& clipper,
+                                        MyFlipSet& flipset,
+                                        FlipGrid& flipgrid)
+  {
+    std::size_t cells = 0;
+    for (typename Grid::size_type j = y1; j < y2; j++)
+      for (typename Grid::size_type i = x1; i < x2; i++)
+      {
+        if (!grid.valid(i, j))
+          continue;
+
+        const auto place = cell_placement(grid, i, j, clipper);
+        if (place == MyClipper::Outside)
+          continue;
+
+        ++cells;
+        if (place == MyClipper::Inside)
         {
-          for (typename Grid::size_type j = it->y1; j < it->y2; j++)
-            for (typename Grid::size_type i = it->x1; i < it->x2; i++)
-              if (grid.valid(i, j))
-                Contourer::rectangle(grid.x(i, j),
-                                     grid.y(i, j),
-                                     grid(i, j),
-                                     grid.x(i, j + 1),
-                                     grid.y(i, j + 1),
-                                     grid(i, j + 1),
-                                     grid.x(i + 1, j + 1),
-                                     grid.y(i + 1, j + 1),
-                                     grid(i + 1, j + 1),
-                                     grid.x(i + 1, j),
-                                     grid.y(i + 1, j),
-                                     grid(i + 1, j),
-                                     value,
-                                     flipset);
+          fill_cell(grid, i, j, lolimit, hilimit, flipset, flipgrid);
+          continue;
         }
+
+        // Contour the cell separately and clip the result
+        MyFlipSet cellset;
+        FlipGrid cellgrid(2, 2);
+        Contourer::rectangle(grid.x(i, j),
+                             grid.y(i, j),
+                             grid(i, j),
+                             grid.x(i, j + 1),
+                             grid.y(i, j + 1),
+                             grid(i, j + 1),
+                             grid.x(i + 1, j + 1),
+                             grid.y(i + 1, j + 1),
+                             grid(i + 1, j + 1),
+                             grid.x(i + 1, j),
+                             grid.y(i + 1, j),
+                             grid(i + 1, j),
+                             0,
+                             0,
+                             lolimit,
+                             hilimit,
+                             cellset,
+                             cellgrid);
+        cellgrid.copy(CellView(grid, i, j), cellset);
+        cellset.prepare();
+        clipper.clip_fill(cellset.edges(), flipset);
       }
+    return cells;
+  }
+
+  /*
+   * Contour the valid cells x1 <= i < x2, y1 <= j < y2 in line mode
+   * clipping the cells which straddle the box.
+   */
+
+  static std::size_t line_cells_clipped(const Grid& grid,
+                                        typename Grid::size_type x1,
+                                        typename Grid::size_type y1,
+                                        typename Grid::size_type x2,
+                                        typename Grid::size_type y2,
+                                        value_type value,
+                                        const MyClipper& clipper,
+                                        MyFlipSet& flipset)
+  {
+    std::size_t cells = 0;
+    for (typename Grid::size_type j = y1; j < y2; j++)
+      for (typename Grid::size_type i = x1; i < x2; i++)
+      {
+        if (!grid.valid(i, j))
+          continue;
+
+        const auto place = cell_placement(grid, i, j, clipper);
+        if (place == MyClipper::Outside)
+          continue;
+
+        ++cells;
+        if (place == MyClipper::Inside)
+        {
+          line_cell(grid, i, j, value, flipset);
+          continue;
+        }
+
+        MyFlipSet cellset;
+        line_cell(grid, i, j, value, cellset);
+        cellset.prepare();
+        clipper.clip_lines(cellset.edges(), flipset);
+      }
+    return cells;
+  }
+
+  /*
+   * Collect the fill edges and pass them to the builder
+   */
+
+  static void fill_finish(
+      PathAdapter& path, const Grid& grid, MyFlipSet& flipset, FlipGrid& flipgrid, Stats* stats)
+  {
+    {
+      StageTimer timer(stats, Stats::FlipGridCopy);
+      flipgrid.copy(grid, flipset);
+    }
+    {
+      StageTimer timer(stats, Stats::FlipSetPrepare);
+      flipset.prepare();
     }
+    update_stats(flipset, stats);
+    Builder::fill<Traits>(flipset.edges(), path, stats);
+  }
+
+  /*
+   * Collect the isoline edges and pass them to the builder
+   */
+
+  static void line_finish(PathAdapter& path, MyFlipSet& flipset, Stats* stats)
+  {
+    {
+      StageTimer timer(stats, Stats::FlipSetPrepare);
+      flipset.prepare();
+    }
+    update_stats(flipset, stats);
+    Builder::line<Traits>(flipset.edges(), path, stats);
+  }
 
-    flipset.prepare();
-    Builder::line<Traits>(flipset.edges(), path);
+  static void update_stats(const MyFlipSet& flipset, Stats* stats)
+  {
+    if (!stats)
+      return;
+    ++stats->calls;
+    stats->flips += flipset.flips();
+    stats->edges += flipset.size();
+    stats->load_factor = std::max(stats->load_factor, flipset.load_factor());
   }
 
 };  // class Contourer
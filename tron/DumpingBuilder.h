@@ -0,0 +1,177 @@
+// ======================================================================
+/*!
+ * \brief Builder wrapper dumping the edge jobs of another builder
+ *
+ * Capturing jobs with the JobDump functions requires changes to the
+ * code calling the contourer. This wrapper instead only changes the
+ * builder type: the edges passed to the wrapped builder are dumped
+ * for every N'th call as determined by the sampler, and always when
+ * the wrapped builder throws.
+ *
+ *   Tron::JobDump::Sampler sampler(1000);
+ *   Tron::FmiBuilder builder(factory);
+ *   Tron::DumpingBuilder<Tron::FmiBuilder> dumper(builder, sampler, "/tmp/tron-");
+ *   MyContourer::fill(dumper, grid, lo, hi);
+ *   auto result = builder.result();
+ *
+ * The dumps are named prefix + sequence number + ".dump", where the
+ * sequence number is unique within the process. Failing to write a
+ * dump does not fail the contouring job, nor replace the exception
+ * thrown by the wrapped builder. Instead the reason is available from
+ * last_error() until the next dump succeeds.
+ *
+ * This header must be included after the header of the wrapped builder,
+ * and before Tron.h like the other builders.
+ */
+// ======================================================================
+
+#pragma once
+
+#include "JobDump.h"
+#include "Stats.h"
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace Tron
+{
+template <typename Wrapped>
+class DumpingBuilder
+{
+ public:
+  DumpingBuilder(Wrapped& theBuilder,
+                 JobDump::Sampler& theSampler,
+                 std::string thePrefix,
+                 bool theDumpOnError = true)
+      : itsBuilder(theBuilder),
+        itsSampler(theSampler),
+        itsPrefix(std::move(thePrefix)),
+        itsDumpOnError(theDumpOnError)
+  {
+  }
+
+  DumpingBuilder() = delete;
+  DumpingBuilder(const DumpingBuilder& theOther) = delete;
+  DumpingBuilder& operator=(const DumpingBuilder& theOther) = delete;
+
+  Wrapped& builder() { return itsBuilder; }
+
+  // Name of the last dump written, empty if none
+  const std::string& last_dump() const { return itsLastDump; }
+
+  // Reason the last dump attempt failed, empty if it succeeded
+  const std::string& last_error() const { return itsLastError; }
+
+  template <typename Traits, typename Edges, typename Function>
+  void run(const Edges& theEdges, JobDump::Mode theMode, Function theFunction);
+
+ private:
+  template <typename Traits, typename Edges>
+  bool dump(const Edges& theEdges, JobDump::Mode theMode);
+
+  Wrapped& itsBuilder;
+  JobDump::Sampler& itsSampler;
+  const std::string itsPrefix;
+  const bool itsDumpOnError;
+  std::string itsLastDump;
+  std::string itsLastError;
+
+};  // class DumpingBuilder
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Run the wrapped builder, dumping the edges when requested
+ *
+ * Dump failures are only recorded, the exception thrown by the wrapped
+ * builder is always passed on unchanged.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Wrapped>
+template <typename Traits, typename Edges, typename Function>
+void DumpingBuilder<Wrapped>::run(const Edges& theEdges,
+                                  JobDump::Mode theMode,
+                                  Function theFunction)
+{
+  const bool dumped = itsSampler.sample() && dump<Traits>(theEdges, theMode);
+
+  try
+  {
+    theFunction();
+  }
+  catch (...)
+  {
+    if (itsDumpOnError && !dumped)
+      dump<Traits>(theEdges, theMode);
+    throw;
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Write the edges into a new dump file, returns false on failure
+ */
+// ----------------------------------------------------------------------
+
+template <typename Wrapped>
+template <typename Traits, typename Edges>
+bool DumpingBuilder<Wrapped>::dump(const Edges& theEdges, JobDump::Mode theMode)
+{
+  try
+  {
+    const std::string filename = itsPrefix + std::to_string(JobDump::sequence()) + ".dump";
+    std::ofstream output(filename, std::ios::out | std::ios::binary);
+    if (!output)
+      throw std::runtime_error("Failed to open '" + filename + "' for writing");
+    JobDump::write_edges<Traits>(output, theEdges, theMode);
+    output.close();
+    if (!output)
+      throw std::runtime_error("Failed to write contouring job dump '" + filename + "'");
+    itsLastDump = filename;
+    itsLastError.clear();
+    return true;
+  }
+  catch (const std::exception& e)
+  {
+    itsLastError = e.what();
+  }
+  catch (...)
+  {
+    itsLastError = "Failed to write contouring job dump";
+  }
+  return false;
+}
+
+namespace Builder
+{
+// ----------------------------------------------------------------------
+/*
+ * \brief Dumping builder for polygons
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits, typename Edges, typename Wrapped>
+void fill(const Edges& theEdges, DumpingBuilder<Wrapped>& theAdapter, Stats* theStats = nullptr)
+{
+  auto build = [&]() { Builder::fill<Traits>(theEdges, theAdapter.builder(), theStats); };
+  theAdapter.template run<Traits>(theEdges, JobDump::Mode::Fill, build);
+}
+
+// ----------------------------------------------------------------------
+/*
+ * \brief Dumping builder for lines
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits, typename Edges, typename Wrapped>
+void line(const Edges& theEdges, DumpingBuilder<Wrapped>& theAdapter, Stats* theStats = nullptr)
+{
+  auto build = [&]() { Builder::line<Traits>(theEdges, theAdapter.builder(), theStats); };
+  theAdapter.template run<Traits>(theEdges, JobDump::Mode::Line, build);
+}
+}  // namespace Builder
+
+}  // namespace Tron
+
+// ======================================================================
@@ -77,9 +77,13 @@ class Edge
     return itsY1 < theCoord.second;
   }
 
+  // Computed in double precision so that float edges produce the same
+  // angles as Ring::endAngle for the same segment
   double angle() const
   {
-    return atan2(itsY2 - itsY1, itsX2 - itsX1) * boost::math::double_constants::radian;
+    const double dx = static_cast<double>(itsX2) - itsX1;
+    const double dy = static_cast<double>(itsY2) - itsY1;
+    return atan2(dy, dx) * boost::math::double_constants::radian;
   }
 
  private:
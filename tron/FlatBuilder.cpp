@@ -0,0 +1,87 @@
+#include "FlatBuilder.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace Tron
+{
+namespace
+{
+// Grow geometrically so that adding many bands does not copy the data repeatedly
+template <typename T>
+void grow(std::vector<T> &theVector, std::size_t theExtraSize)
+{
+  const std::size_t size = theVector.size() + theExtraSize;
+  if (size > theVector.capacity())
+    theVector.reserve(std::max(size, 2 * theVector.capacity()));
+}
+}  // namespace
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Constructor
+ */
+// ----------------------------------------------------------------------
+
+FlatBuilder::FlatBuilder()
+{
+  clear();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Remove all bands
+ */
+// ----------------------------------------------------------------------
+
+void FlatBuilder::clear()
+{
+  itsCoords.clear();
+  itsRingOffsets.assign(1, 0);
+  itsPolygonOffsets.assign(1, 0);
+  itsBandOffsets.assign(1, 0);
+  itsMode = 0;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Make sure fills and lines are not mixed
+ */
+// ----------------------------------------------------------------------
+
+void FlatBuilder::set_mode(bool fillmode)
+{
+  const int mode = (fillmode ? 1 : 2);
+  if (itsMode != 0 && itsMode != mode)
+    throw std::runtime_error("FlatBuilder cannot mix polygons and lines");
+  itsMode = mode;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Reserve space for the next band
+ */
+// ----------------------------------------------------------------------
+
+void FlatBuilder::reserve(std::size_t thePoints, std::size_t theRings)
+{
+  grow(itsCoords, 2 * thePoints);
+  grow(itsRingOffsets, theRings);
+  if (itsMode == 1)
+    grow(itsPolygonOffsets, theRings);
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Convert a size to an offset, throws on overflow
+ */
+// ----------------------------------------------------------------------
+
+FlatBuilder::offset_type FlatBuilder::offset(std::size_t theSize) const
+{
+  if (theSize > static_cast<std::size_t>(std::numeric_limits<offset_type>::max()))
+    throw std::runtime_error("FlatBuilder offset overflow");
+  return static_cast<offset_type>(theSize);
+}
+
+}  // namespace Tron
@@ -0,0 +1,188 @@
+// ======================================================================
+/*!
+ * \brief Builder producing flat columnar geometry arrays
+ *
+ * The output follows the GeoArrow native encoding: all coordinates are
+ * stored in a single interleaved x,y array, and the structure is given
+ * by offset arrays, each one element longer than the number of items:
+ *
+ * Fill mode (one MultiPolygon per band):
+ *
+ *   coords()          x0,y0,x1,y1,...
+ *   ring_offsets()    ring -> first point in coords
+ *   polygon_offsets() polygon -> first ring, the shell followed by its holes
+ *   band_offsets()    band -> first polygon
+ *
+ * Line mode (one MultiLineString per isoline value):
+ *
+ *   coords()          x0,y0,x1,y1,...
+ *   ring_offsets()    linestring -> first point in coords
+ *   band_offsets()    band -> first linestring
+ *
+ * Each fill or line call appends a new band, hence the same builder
+ * can collect all the bands of a single product. A builder must be
+ * used either for fills or lines, not both.
+ *
+ * The arrays are reserved based on the number of edges before each
+ * band is added and grown geometrically.
+ */
+// ======================================================================
+
+#pragma once
+
+#include "RingBuilder.h"
+#include "Stats.h"
+#include <boost/utility.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace Tron
+{
+class FlatBuilder : private boost::noncopyable
+{
+ public:
+  using offset_type = std::int32_t;
+  using Coordinates = std::vector<double>;
+  using Offsets = std::vector<offset_type>;
+
+  ~FlatBuilder() = default;
+  FlatBuilder(const FlatBuilder &other) = delete;
+  FlatBuilder &operator=(const FlatBuilder &other) = delete;
+  FlatBuilder(FlatBuilder &&other) = delete;
+  FlatBuilder &operator=(FlatBuilder &&other) = delete;
+
+  FlatBuilder();
+
+  std::size_t bands() const { return itsBandOffsets.size() - 1; }
+  const Coordinates &coords() const { return itsCoords; }
+  const Offsets &ring_offsets() const { return itsRingOffsets; }
+  const Offsets &polygon_offsets() const { return itsPolygonOffsets; }
+  const Offsets &band_offsets() const { return itsBandOffsets; }
+
+  void clear();
+
+  template <typename Traits, typename Edges>
+  void build(const Edges &theEdges, bool fillmode, Stats *theStats = nullptr);
+
+ private:
+  void set_mode(bool fillmode);
+  void reserve(std::size_t thePoints, std::size_t theRings);
+  offset_type offset(std::size_t theSize) const;
+
+  template <typename Traits>
+  void add_ring(const Ring<Traits> &theRing);
+
+  Coordinates itsCoords;
+  Offsets itsRingOffsets;
+  Offsets itsPolygonOffsets;
+  Offsets itsBandOffsets;
+
+  // 0 = not decided yet, 1 = fill, 2 = line
+  int itsMode = 0;
+
+};  // class FlatBuilder
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Append a ring or linestring
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+inline void FlatBuilder::add_ring(const Ring<Traits> &theRing)
+{
+  for (const auto &point : theRing)
+  {
+    itsCoords.push_back(point.first);
+    itsCoords.push_back(point.second);
+  }
+  itsRingOffsets.push_back(offset(itsCoords.size() / 2));
+}
+
+// ----------------------------------------------------------------------
+/*
+ * \brief Build polygons or polylines from the given edges as a new band
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits, typename Edges>
+inline void FlatBuilder::build(const Edges &edges, bool fillmode, Stats *stats)
+{
+  set_mode(fillmode);
+
+  RingAssembly<Traits> assembly;
+  const auto &polylines = assembly.polylines;
+
+  StageTimer buildtimer(stats, Stats::BuildRings);
+  build_rings(edges, assembly);
+  buildtimer.stop();
+
+  if (stats)
+    stats->rings += polylines.size();
+
+  // Each ring has one more point than it has edges
+  reserve(edges.size() + polylines.size(), polylines.size());
+
+  if (!fillmode)
+  {
+    StageTimer outputtimer(stats, Stats::GeosConversion);
+    for (const auto &polyline : polylines)
+      add_ring(polyline);
+    itsBandOffsets.push_back(offset(itsRingOffsets.size() - 1));
+    return;
+  }
+
+  StageTimer findtimer(stats, Stats::FindShell);
+  const HoleShells holeshells = assign_holes(edges, assembly);
+  findtimer.stop();
+
+  StageTimer outputtimer(stats, Stats::GeosConversion);
+
+  const PolygonList parts = collect_polygons(polylines, holeshells);
+
+  if (stats)
+  {
+    stats->shells += parts.size();
+    stats->holes += holeshells.size();
+  }
+
+  for (const auto &part : parts)
+  {
+    add_ring(polylines[part.shell]);
+    for (auto hole : part.holes)
+      add_ring(polylines[hole]);
+    itsPolygonOffsets.push_back(offset(itsRingOffsets.size() - 1));
+  }
+  itsBandOffsets.push_back(offset(itsPolygonOffsets.size() - 1));
+}
+
+namespace Builder
+{
+// ----------------------------------------------------------------------
+/*
+ * \brief Flat builder for polygons
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits, typename Edges>
+void fill(const Edges &theEdges, FlatBuilder &theAdapter, Stats *theStats = nullptr)
+{
+  theAdapter.build<Traits>(theEdges, true, theStats);
+}
+
+// ----------------------------------------------------------------------
+/*
+ * \brief Flat builder for lines
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits, typename Edges>
+void line(const Edges &theEdges, FlatBuilder &theAdapter, Stats *theStats = nullptr)
+{
+  theAdapter.build<Traits>(theEdges, false, theStats);
+}
+}  // namespace Builder
+
+}  // namespace Tron
+
+// ======================================================================
@@ -36,6 +36,9 @@ class FlipGrid
   FlipGrid(std::size_t width, std::size_t height);
   FlipGrid() = delete;
 
+  // Number of edges currently in the grid
+  std::size_t size() const { return itsSize; }
+
   void flipTop(std::size_t i, std::size_t j);
   void flipRight(std::size_t i, std::size_t j);
   void flipBottom(std::size_t i, std::size_t j);
@@ -67,11 +67,20 @@ class FlipSet
   size_type size() const { return itsValues.size(); }
   bool empty() const { return itsValues.empty(); }
   void clear() { itsValues.clear(); }
+  // Number of flips performed so far, for statistics. Each cancelled pair took
+  // two flips and each remaining edge one, so only the erase path counts.
+  std::size_t flips() const { return itsFlipValues.size() + 2 * itsCancelled; }
+  // Load factor of the hash table used for flipping
+  float load_factor() const { return itsFlipValues.load_factor(); }
+
   void flip(const value_type& theValue)
   {
     std::pair<typename internal_type::iterator, bool> ret = itsFlipValues.insert(theValue);
     if (!ret.second)
+    {
       itsFlipValues.erase(ret.first);
+      ++itsCancelled;
+    }
   }
 
   void eflip(const value_type& theValue)
@@ -91,6 +100,7 @@ class FlipSet
  private:
   storage_type itsValues;
   internal_type itsFlipValues;
+  std::size_t itsCancelled = 0;
 
 };  // class FlipSet
 
@@ -40,6 +40,18 @@ FmiBuilder::FmiBuilder(const geos::geom::GeometryFactory &theFactory)
 {
 }
 
+// ----------------------------------------------------------------------
+/*!
+ * \brief Constructor with optional simplification etc
+ */
+// ----------------------------------------------------------------------
+
+FmiBuilder::FmiBuilder(const geos::geom::GeometryFactory &theFactory,
+                       const BuildOptions &theOptions)
+    : itsResult(), itsFactory(theFactory), itsOptions(theOptions)
+{
+}
+
 // ----------------------------------------------------------------------
 /*!
  * \brief Return the final result
@@ -35,15 +35,23 @@ l* Building utility for FMI.
  *         the polygon with the edge and mark it used.
  *      e) If there are multiple free edges, pick the one that turns most clockwise..
  *
+ * Rings smaller than the minimum area or vertex count given in
+ * BuildOptions are dropped right after they have been built, before
+ * holes are assigned to shells. If a simplification tolerance is
+ * given, the rings are simplified after the holes have been assigned to shells and before
+ * the GEOS geometries are created, see Simplify.h. Rings whose simplified versions would
+ * intersect other rings of the band are kept unsimplified. Each band is simplified on its
+ * own, hence adjacent bands may not match exactly. Use MultiBandBuilder for sharing the
+ * simplified boundaries.
  */
 // ======================================================================
 
 #pragma once
 
-#include "Ring.h"
-#include "SmallVector.h"
-#include <optional>
-#include <boost/numeric/conversion/cast.hpp>
+#include "BuildOptions.h"
+#include "RingBuilder.h"
+#include "Simplify.h"
+#include "Stats.h"
 #include <boost/utility.hpp>
 #include <geos/algorithm/CGAlgorithmsDD.h>
 #include <geos/geom/GeometryFactory.h>
@@ -52,6 +60,7 @@ l* Building utility for FMI.
 #include <geos/geom/Polygon.h>
 #include <geos/io/WKTWriter.h>
 #include <geos/operation/valid/IsValidOp.h>
+#include <algorithm>
 #include <cmath>
 #include <map>
 #include <memory>
@@ -69,28 +78,26 @@ class FmiBuilder : private boost::noncopyable
   FmiBuilder &operator=(FmiBuilder &&other) = delete;
 
   FmiBuilder(const geos::geom::GeometryFactory &theFactory);
+  FmiBuilder(const geos::geom::GeometryFactory &theFactory, const BuildOptions &theOptions);
 
   std::unique_ptr<geos::geom::Geometry> result();
 
   template <typename Traits, typename Edges>
-  void build(const Edges &theEdges, bool fillmode);
+  void build(const Edges &theEdges, bool fillmode, Stats *theStats = nullptr);
 
  private:
+  template <typename Traits>
+  std::unique_ptr<geos::geom::LinearRing> create_ring(const Ring<Traits> &theRing) const;
+
   // The final result
   std::unique_ptr<geos::geom::Geometry> itsResult;
 
   // Used while building:
   const geos::geom::GeometryFactory &itsFactory;
+  BuildOptions itsOptions;
 
 };  // class FmiBuilder
 
-// To which polyline is an edge assigned to
-using Targets = std::vector<int>;
-
-// Representative non-vertical edge from a polyline
-
-using EdgeFromRing = std::vector<std::size_t>;
-
 // ----------------------------------------------------------------------
 /*!
  * \brief Validate a geometry
@@ -125,368 +132,25 @@ inline void validate(const std::unique_ptr<geos::geom::Geometry> &geom)
 
 // ----------------------------------------------------------------------
 /*!
- * \brief Find maximum edge width
- */
-// ----------------------------------------------------------------------
-
-template <typename Edges>
-double find_maximum_edge_width(const Edges &edges)
-{
-  double maxwidth = -1;
-  std::size_t nedges = edges.size();
-  for (std::size_t i = 0; i < nedges; i++)
-  {
-    double width = std::abs(edges[i].x1() - edges[i].x2());
-    maxwidth = std::max(maxwidth, width);
-  }
-  return maxwidth;
-}
-
-// ----------------------------------------------------------------------
-/*!
- * \brief Pick the next free edge, or return -1 if none are available
- */
-// ----------------------------------------------------------------------
-
-inline long pick_free_edge(const Targets &targets, long index)
-{
-  const auto ntargets = targets.size();
-  auto i = static_cast<std::size_t>(index);
-  for (; i < ntargets; ++i)
-  {
-    if (targets[i] < 0)
-      return i;
-  }
-  return -1;
-}
-
-// ----------------------------------------------------------------------
-/*!
- * \brief Find the next edge for the polyline, or return -1 if there is none.
- */
-// ----------------------------------------------------------------------
-
-template <typename Polyline, typename Edges>
-long find_first_match(const Polyline &polyline, const Edges &edges, long pos, long lastpos)
-{
-  const long nedges = boost::numeric_cast<long>(edges.size());
-
-  // Last coordinate of the polyline
-  const typename Polyline::value_type &endcoordinate = polyline.back();
-
-  // A better guess than the last chosen edge is that we must skip roughly the same amount of edges
-  // again
-
-  pos += pos - lastpos;
-  if (pos < 0)
-    pos = 0;
-  if (pos >= nedges)
-    pos = nedges - 1;
-
-  // Note: The last coordinate can never be the same as the start coordinate at the hint,
-  // that would mean there was a 0-length edge.
-
-  if (!(edges[pos] < endcoordinate))
-  {
-    // Search left for smaller coordinate, then test whether the next one was a match.
-
-    for (--pos;; --pos)
-    {
-      if (pos < 0 || edges[pos] < endcoordinate)
-      {
-        if (edges[++pos] == endcoordinate)
-          return pos;
-        return -1;
-      }
-    }
-  }
-  else
-  {
-    // Search right for the first match or a greater coordinate
-    for (++pos; pos < nedges; ++pos)
-    {
-      if (edges[pos] < endcoordinate)
-      {
-        // This is the most likely case and hence we test it first for speed
-      }
-      else if (edges[pos] == endcoordinate)
-        return pos;
-      else
-        return -1;
-    }
-  }
-  return -1;
-}
-
-// ----------------------------------------------------------------------
-/*!
- * \brief Pick best edge to continue with, or return -1 if there is none.
- */
-// ----------------------------------------------------------------------
-
-template <typename Polylines, typename Polyline, typename Edges>
-long pick_best_match(const Polylines &polylines,
-                     const Polyline &polyline,
-                     const Edges &edges,
-                     const Targets &targets,
-                     long pos,
-                     long polylineindex,
-                     bool *self_touch,
-                     bool *isoline_extension)
-{
-  // Not touching itself
-  *self_touch = false;
-
-  // Now extending old isoline
-  *isoline_extension = false;
-
-  // Return no choice if there is nothing to choose from
-  if (pos < 0)
-    return pos;
-
-  // Last coordinate of the polyline
-  const typename Polyline::value_type &endcoordinate = polyline.back();
-
-  // Handle quickly the most common case of exactly one match
-
-  const long npolylines = boost::numeric_cast<long>(polylines.size());
-  const long nedges = boost::numeric_cast<long>(edges.size());
-
-#ifdef OPTIMIZE_ONE_CHOICE
-  // This optimization is not robust for polylines
-
-  if (pos + 1 == nedges || !(edges[pos + 1] == endcoordinate))
-  {
-    // No best pick if the edge is already taken. Could happen with polylines, not with polygons.
-
-    if (targets[pos] < 0)
-      return pos;
-
-    if (targets[pos] == polylineindex)
-      *self_touch = true;
-
-    else if (targets[pos] >= npolylines)
-      throw std::runtime_error(
-          "Internal error trying to build a valid geometry, target polygon number overflow");
-
-    else if (polylines[targets[pos]].closed())
-      return -1;
-
-    // There is a previous polyline we can extend.
-    return pos;
-  }
-#endif
-
-  // There must be multiple matches then, but perhaps not all are taken.
-  // Also, if any of the matches has already been selected for the current polygon,
-  // we have built a self-touching polyline, and need to extract the ring we have now
-  // built. Note that there may be several edges leaving the same point, we actually
-  // have to search the last node with the same coordinate to cut the ring.
-
-  SmallVector<long, 10> available;
-
-  for (long i = pos; i < nedges; i++)
-  {
-    if (!(edges[i] == endcoordinate))
-      break;
-    if (targets[i] == polylineindex)
-      *self_touch = true;
-    // // Non-closed polylines are viable candidates for continuation
-    else if (targets[i] < 0 || !polylines[targets[i]].closed())
-      available.push_back(i);
-  }
-
-  // Nothing available?
-  if (available.empty())
-    return -1;
-
-  // No need to calculate angles if there is only one choice remaining
-
-  std::size_t bestpos = 0;
-
-  if (available.size() == 1)
-    bestpos = available[0];
-
-  else
-  {
-    // Pick the edge that turns most clockwise with respect to the end of the polyline.
-    // (most negative turn in range -180...+180)
-
-    double bestangle = +999;
-    double alpha1 = polyline.endAngle();
-
-    for (std::size_t i = 0; i < available.size(); i++)
-    {
-      double alpha2 = edges[available[i]].angle();
-      // The extra +360 makes sure the fmod argument is positive
-      // The +180 and -180 make the result -180...+180
-      double angle = fmod(alpha2 - alpha1 + 180 + 360, 360.0) - 180;  // symmetric modulo
-
-      if (angle < bestangle)
-      {
-        bestangle = angle;
-        bestpos = available[i];
-      }
-    }
-  }
-
-  // We're extending an old isoline if the best match is not closed. We also know it
-  // will never be closed, otherwise the algorithm would have closed it already.
-
-  if (targets[bestpos] >= 0 && targets[bestpos] < npolylines)
-  {
-    *isoline_extension = !polylines[targets[bestpos]].closed();
-  }
-
-  return bestpos;
-}
-
-// ----------------------------------------------------------------------
-/*!
- * \brief Assign a new index for the given edges
+ * \brief Create a GEOS linear ring from a closed ring
  */
 // ----------------------------------------------------------------------
 
-template <typename EdgeIndexes>
-void reindex_edges(Targets &targets, const EdgeIndexes &edgeindexes, long newindex)
+template <typename Traits>
+inline std::unique_ptr<geos::geom::LinearRing> FmiBuilder::create_ring(
+    const Ring<Traits> &theRing) const
 {
-  for (std::size_t i = 0; i < edgeindexes.size(); i++)
-    targets[edgeindexes[i]] = newindex;
-}
-
-// ----------------------------------------------------------------------
-/*!
- * \brief Find a non-vertical edge backwards from the given indexes
- */
-// ----------------------------------------------------------------------
-
-template <typename Edges, typename EdgeIndexes>
-std::size_t representative_edge(const Edges &edges, const EdgeIndexes &edgeindexes)
-{
-  for (std::size_t i = edgeindexes.size() - 1; i > 0; i--)
-  {
-    std::size_t idx = edgeindexes[i];
-    if (edges[idx].x1() != edges[idx].x2())
-      return idx;
-  }
-
-  // Should never happen for polygons, just return zero to keep the compiler happy
-  return 0;
-}
-
-// ----------------------------------------------------------------------
-/*!
- * \brief Find the shell containing the hole which uses edges[edgeindex]
- *
- * holeindex is the polygon index assigned to the hole itself
- */
-// ----------------------------------------------------------------------
-
-template <typename Edges>
-std::optional<std::size_t> find_shell(const Targets &targets,
-                                        const Edges &edges,
-                                        std::size_t edgeindex,
-                                        std::size_t holeindex,
-                                        double maxedgewidth)
-{
-  // Pick the center of the edge chosen for the hole as the
-  // start point of the vertical sweep. We choose the middle since
-  // the polygons are guaranteed not to touch there, and hence a strict
-  // ordering is guaranteed.
-
-  const double x = (edges[edgeindex].x1() + edges[edgeindex].x2()) / 2;
-  const double y = (edges[edgeindex].y1() + edges[edgeindex].y2()) / 2;
-
-  // TODO: We actually know for a fact that due to lexicographic sorting of the
-  // edges the shell is most likely to be at position edgeindex+1, unless there
-  // is another adjacent hole or a shell inside the same shell we're looking for.
-  // However, utilizing that guess seems to be quite hard.
-
-  // Look for the last edge which cannot have an intersection.
-
-  std::size_t pos = edgeindex + 1;
-  while (pos < edges.size() && edges[pos].x1() - maxedgewidth <= x)
-    ++pos;
-
-  // Now we scan backwards until edge.x1 < x-maxwidth, looking for intersections
-  // Note that we use x1+width <= x < x2, not twice with <=.
-
-  // The number of intersections for a polygon index
-  std::map<std::size_t, std::size_t> counts;
-
-  // The intersection-coordinates
-  std::multimap<double, std::size_t> intersections;
-
-  while (pos > 0)
-  {
-    --pos;
-
-    // Look for an intersection
-
-    const typename Edges::value_type &edge = edges[pos];
-
-    const double y1 = edge.y1();
-    const double y2 = edge.y2();
-    const double x1 = edge.x1();
-    const double x2 = edge.x2();
-
-    // We could also ignore holes below, might not give much of a speedup though.
-
-    if (x1 + maxedgewidth < x)
-    {
-      // Done if the edges can no longer reach x. Note the positioning of the test
-      // to speed up the more likely cases above. Cannot place it below the next
-      // "to the left" case though, or the loop may continue until pos=0
-      break;
-    }
-
-    if (y1 < y && y2 < y)
-    {
-      // std::cout << "\tbelow\n";
-    }
-    else if (x1 >= x && x2 >= x)
-    {
-      // std::cout << "\tto the right\n";
-    }
-    else if (x1 < x && x2 < x)
-    {
-      // std::cout << "\tto the left\n";
-    }
-    else if (static_cast<std::size_t>(targets[pos]) == holeindex)
-    {
-      // std::cout << "\titself\n";
-    }
-    else if (x1 == x2)
-    {
-      // std::cout << "\tvertical\n";
-    }
-    else
-    {
-      // Standard line intersection formula with y = alpha * x + beta.
-      // Vertical lines are disallowed above.
-      const double alpha = (y2 - y1) / (x2 - x1);
-      const double ysect = alpha * (x - x1) + y1;
-      if (y < ysect)
-      {
-        const std::size_t polyline = targets[pos];
-        counts[polyline]++;
-        intersections.insert(std::make_pair(ysect, polyline));
-      }
-    }
-  }
+  namespace gg = geos::geom;
 
-  // Now select the polygon with the smallest intersection coordinate and an odd number of
-  // intersections
+  std::vector<gg::Coordinate> points;
+  points.reserve(theRing.size());
+  for (typename Ring<Traits>::const_iterator it = theRing.begin(); it != theRing.end(); ++it)
+    points.emplace_back(gg::Coordinate(it->first, it->second));
 
-  for (const auto &intersection : intersections)
-  {
-    auto polyline = intersection.second;
-    if (counts[polyline] % 2 != 0)
-      return polyline;
-  }
+  std::unique_ptr<gg::CoordinateSequence> cl(new gg::CoordinateSequence());
+  cl->setPoints(points);
 
-  return {};
-  // throw std::runtime_error("Failed to assign hole to a shell");
+  return itsFactory.createLinearRing(std::move(cl));
 }
 
 // ----------------------------------------------------------------------
@@ -498,162 +162,45 @@ std::optional<std::size_t> find_shell(const Targets &targets,
 // In fill-mode we build only polygons, otherwise only linestrings.
 
 template <typename Traits, typename Edges>
-inline void FmiBuilder::build(const Edges &edges, bool fillmode)
+inline void FmiBuilder::build(const Edges &edges, bool fillmode, Stats *stats)
 {
   namespace gg = geos::geom;
 
   using Polyline = Ring<Traits>;
-  using Polylines = std::vector<Polyline>;
-
-  // Objects to be created are closed rings and polylines,
-  // but for now we do not separate them so we'll get the
-  // indexing right.
-  Polylines polylines;
 
-  // Current polygon being created
-  long polylineindex = -1;
-
-  // The edge picked first for a new polyline/ring
-  long edgeindex = -1;
-
-  // Edge assignments to polygons, nothing assigned yet
-  Targets targets(edges.size(), -1);
-
-  // A non-vertical edge from each ring
-  EdgeFromRing ringedge;
+  RingAssembly<Traits> assembly;
+  const auto &polylines = assembly.polylines;
 
   // Build the polygons
-  while (true)
-  {
-    // Find next free edge. Done if everything has been processed.
-    edgeindex = pick_free_edge(targets, ++edgeindex);
-    if (edgeindex < 0)
-      break;
-
-    // Start a new polyline from the chosen edge
-    const typename Edges::value_type &edge = edges[edgeindex];
-    Polyline polyline(edge.x1(), edge.y1(), edge.x2(), edge.y2());
-    targets[edgeindex] = ++polylineindex;
-
-    // Keep a record of selected edges since we may have to reindex them
-    // when a self-touch occurs.
+  StageTimer buildtimer(stats, Stats::BuildRings);
+  build_rings(edges, assembly);
+  buildtimer.stop();
 
-    std::vector<long> edgeindexes = {edgeindex};
+  if (stats)
+    stats->rings += polylines.size();
 
-    // Edge index while we jump round the edges finding matches
-    long index = edgeindex;
+  // Drop speckles before any further work is done on them
 
-    // We remember the last index to make a better guess on how much to
-    // move to the next guess (index-lastindex).
-    long lastindex = index;
-
-    // Find continuation, if there is one, using last edge position as hint
-    while (true)
-    {
-      // Find the best match available
-      bool self_touch = false;
-      bool isoline_extension = false;
-
-      std::size_t tmp = index;
-      index = find_first_match(polyline, edges, index, lastindex);
-      index = pick_best_match(polylines,
-                              polyline,
-                              edges,
-                              targets,
-                              index,
-                              polylineindex,
-                              &self_touch,
-                              &isoline_extension);
-      lastindex = tmp;
-
-      // End the polyline if there are no more matches
-      if (index < 0)
-      {
-        ringedge.push_back(0);
-        polylines.emplace_back();
-        std::swap(polylines.back(), polyline);
-        break;
-      }
-
-      // Extract ring from possible self-touch
-
-      if (self_touch)
-      {
-        Polyline newring = polyline.removeSelfTouch();
-        if (newring.signedArea() != 0)
-        {
-          polylines.emplace_back(newring);
-          ringedge.push_back(representative_edge(edges, edgeindexes));
-          edgeindexes.resize(polyline.size() - 1);  // nedges = nvertices-1
-          reindex_edges(targets, edgeindexes, ++polylineindex);
-        }
-        else
-          std::cout << "Warning: Discarding empty cut ring" << std::endl;
-      }
-
-      // The best edge found
-      const typename Edges::value_type &best = edges[index];
-
-      // Extend old polyline with current one if possible and begin a new one
-      if (isoline_extension)
-      {
-        if (polylines[targets[index]].extendStart(polyline))
-        {
-          // No need for this, the edge was already assigned
-          // edgeindexes.push_back(index);
-
-          // Assign current edges to the old polyline at polylines[index]
-          reindex_edges(targets, edgeindexes, targets[index]);
-
-          // Start a new polyline with the same index as before
-          --polylineindex;
-          break;
-        }
-
-        // Now we're touching an old polyline somewhere else beside its start point.
-        // Time to stop this polyline.
-        // We could also slice the self-touching part from the older polyline,
-        // this would make the algorithm always take the same right-turning choise
-        // as the isoband algorithm does. Does not seem to be worth the trouble though.
-        ringedge.push_back(representative_edge(edges, edgeindexes));
-        polylines.emplace_back();
-        std::swap(polylines.back(), polyline);
-        break;
-      }
-
-      if (targets[index] < 0)
-      {
-        if (!polyline.extendEnd(best.x1(), best.y1(), best.x2(), best.y2()))
-          throw std::runtime_error("Internal error while contouring, failed to extend polygon");
-        // Mark the found edge used
-        targets[index] = polylines.size();
-        edgeindexes.push_back(index);
-      }
-      else
-        throw std::runtime_error("Internal error, self touching isoline not handled properly");
-
-      // Terminate the polyline if it became closed
-      if (polyline.closed())
-      {
-#if 1
-        ringedge.push_back(representative_edge(edges, edgeindexes));
-        polylines.emplace_back();
-        std::swap(polylines.back(), polyline);
-#else
-        // Discard empty rings - should not happen unless coordinates are degenerate
-        std::cout << "Warning: Discarding empty ring created by contouring" << std::endl;
-        Polyline emptyline;
-        std::swap(emptyline, polyline);
-#endif
-        break;
-      }
-    }
+  if (itsOptions.min_area > 0 || itsOptions.min_vertices > 0)
+  {
+    StageTimer speckletimer(stats, Stats::BuildRings);
+    const auto count = remove_small_rings(assembly, itsOptions.min_area, itsOptions.min_vertices);
+    if (stats)
+      stats->dropped += count;
+
+    // Line mode has no indexes to preserve
+    if (!fillmode)
+      assembly.polylines.erase(std::remove_if(assembly.polylines.begin(),
+                                              assembly.polylines.end(),
+                                              [](const Polyline &p) { return p.empty(); }),
+                               assembly.polylines.end());
   }
 
   // Now we convert everything to GEOS geometry objects.
   // If we're not in fill mode, we can just create the output linestrings now.
+  // In fill mode the dropped rings are left empty, all of them may be gone.
 
-  if (polylines.empty())
+  if (std::all_of(polylines.begin(), polylines.end(), [](const Polyline &p) { return p.empty(); }))
   {
     itsResult = itsFactory.createEmptyGeometry();
     return;
@@ -661,6 +208,14 @@ inline void FmiBuilder::build(const Edges &edges, bool fillmode)
 
   if (!fillmode)
   {
+    if (itsOptions.tolerance > 0)
+    {
+      StageTimer simplifytimer(stats, Stats::Simplify);
+      Simplifier<Traits>(edges, itsOptions.tolerance).simplify(assembly.polylines);
+    }
+
+    StageTimer geostimer(stats, Stats::GeosConversion);
+
     std::vector<std::unique_ptr<gg::LineString>> lines;
 
     for (std::size_t i = 0; i < polylines.size(); i++)
@@ -691,6 +246,9 @@ inline void FmiBuilder::build(const Edges &edges, bool fillmode)
         parts.emplace_back(std::move(line));
       itsResult = std::move(itsFactory.createMultiLineString(std::move(parts)));
     }
+    geostimer.stop();
+
+    StageTimer normalizetimer(stats, Stats::Normalize);
     itsResult->normalize();
     validate(itsResult);
 
@@ -700,7 +258,7 @@ inline void FmiBuilder::build(const Edges &edges, bool fillmode)
   // Check that everything is closed
 
   for (std::size_t i = 0; i < polylines.size(); i++)
-    if (!polylines[i].closed())
+    if (!polylines[i].empty() && !polylines[i].closed())
     {
       std::cerr << "Warning: polyline " << i << "/" << polylines.size() << " is not closed\n";
       std::cout << "POLY " << i << "\t" << polylines[i].signedArea() << "\t"
@@ -708,117 +266,45 @@ inline void FmiBuilder::build(const Edges &edges, bool fillmode)
       // throw std::runtime_error("Failed to build a valid multipolygon, linestrings still remain");
     }
 
-  // Find the maximum width of an edge to bound the search for the right shell for each hole.
-
-  double maxedgewidth = find_maximum_edge_width(edges);
-
-  // Find all the shells
+  // Assign holes to shells.
 
-  // A mapping from polyline index to shell index
-  std::map<std::size_t, std::size_t> shellindexes;
+  StageTimer findtimer(stats, Stats::FindShell);
+  const HoleShells holeshells = assign_holes(edges, assembly);
+  findtimer.stop();
 
-  std::vector<std::unique_ptr<gg::LinearRing>> shells;
+  // Simplify only after the holes have been assigned, the search uses the original edges
 
-  for (std::size_t i = 0; i < polylines.size(); i++)
+  if (itsOptions.tolerance > 0)
   {
-#if 1
-    if (!polylines[i].closed())
-      continue;
-#endif
-    const Polyline &polyline = polylines[i];
-
-    // std::cout << "POLY " << i << "\t" << polyline.signedArea() << "\t" << polyline.asText(20) <<
-    // std::endl;
-
-    if (polyline.isClockWise())
-    {
-      std::vector<gg::Coordinate> points;
-      points.reserve(points.size());
-      for (typename Ring<Traits>::const_iterator it = polyline.begin(); it != polyline.end(); ++it)
-        points.emplace_back(gg::Coordinate(it->first, it->second));
-
-      std::unique_ptr<gg::CoordinateSequence> cl(new gg::CoordinateSequence());
-      cl->setPoints(points);
-
-      std::unique_ptr<gg::LinearRing> lr = std::move(itsFactory.createLinearRing(std::move(cl)));
-
-      shellindexes[i] = shells.size();
-      shells.emplace_back(std::move(lr));
-    }
+    StageTimer simplifytimer(stats, Stats::Simplify);
+    Simplifier<Traits>(edges, itsOptions.tolerance).simplify(assembly.polylines);
   }
 
-  // Assign holes to shells
+  StageTimer geostimer(stats, Stats::GeosConversion);
 
-  std::map<std::size_t, std::vector<std::size_t> > shellholes;
-  std::vector<std::unique_ptr<gg::LinearRing>> holes;
+  const PolygonList parts = collect_polygons(polylines, holeshells);
 
-  for (std::size_t i = 0; i < polylines.size(); i++)
+  std::vector<std::unique_ptr<gg::Geometry>> geom;
+
+  for (const auto &part : parts)
   {
-#if 1
-    if (!polylines[i].closed())
-      continue;
-#endif
-    const Polyline &polyline = polylines[i];
+    std::unique_ptr<gg::LinearRing> shell = create_ring(polylines[part.shell]);
 
-    if (!polyline.isClockWise())
+    if (part.holes.empty())
+      geom.emplace_back(itsFactory.createPolygon(std::move(shell)));
+    else
     {
-      // Polyline index
-      auto idx = find_shell(targets, edges, ringedge[i], i, maxedgewidth);
-
-      if (!idx)
-      {
-        // This may happen if the grid coordinates are not topologically sound.
-        // For example PROJ.4 may produce unexpected/duplicate coordinates for poles in some
-        // projections std::cout << "Warning: unassigned hole found\n";
-      }
-      else
-      {
-        // std::cout << "HOLE " << i << " HAS SHELL " << idx << std::endl;
-
-        // Append the hole index for the shell
-        shellholes[shellindexes[*idx]].push_back(holes.size());
-
-        std::vector<gg::Coordinate> points;
-        points.reserve(points.size());
-        for (typename Ring<Traits>::const_iterator it = polyline.begin(); it != polyline.end();
-             ++it)
-          points.emplace_back(gg::Coordinate(it->first, it->second));
-
-        std::unique_ptr<gg::CoordinateSequence> cl(new gg::CoordinateSequence());
-        cl->setPoints(points);
-
-        std::unique_ptr<gg::LinearRing> lr = std::move(itsFactory.createLinearRing(std::move(cl)));
-
-        holes.push_back(std::move(lr));
-      }
+      std::vector<std::unique_ptr<gg::LinearRing>> holes;
+      for (auto holeindex : part.holes)
+        holes.emplace_back(create_ring(polylines[holeindex]));
+      geom.emplace_back(itsFactory.createPolygon(std::move(shell), std::move(holes)));
     }
   }
 
-  // The built polygons
-
-  std::vector<std::unique_ptr<gg::Geometry>> geom;
-
-  if (holes.empty())
-  {
-    for (auto &shell : shells)
-      geom.emplace_back(std::move(itsFactory.createPolygon(std::move(shell))));
-  }
-  else
+  if (stats)
   {
-    for (std::size_t i = 0; i < shells.size(); i++)
-    {
-      std::vector<std::unique_ptr<gg::LinearRing>> holetransfer;
-
-      const std::vector<std::size_t> &holeindexes = shellholes[i];
-
-      for (auto holeindex : holeindexes)
-      {
-        holetransfer.emplace_back(std::move(holes[holeindex]));
-      }
-      std::unique_ptr<gg::Polygon> foo
-        = std::move(itsFactory.createPolygon(std::move(shells[i]), std::move(holetransfer)));
-      geom.emplace_back(std::move(foo));
-    }
+    stats->shells += parts.size();
+    stats->holes += holeshells.size();
   }
 
   // Create a MULTIPOLYGON if required
@@ -830,6 +316,9 @@ inline void FmiBuilder::build(const Edges &edges, bool fillmode)
   else
     multipolygon = std::move(itsFactory.createMultiPolygon(std::move(geom)));
 
+  geostimer.stop();
+
+  StageTimer normalizetimer(stats, Stats::Normalize);
   itsResult = std::move(multipolygon);
   itsResult->normalize();
   validate(itsResult);
@@ -844,9 +333,9 @@ namespace Builder
 // ----------------------------------------------------------------------
 
 template <typename Traits, typename Edges>
-void fill(const Edges &theEdges, FmiBuilder &theAdapter)
+void fill(const Edges &theEdges, FmiBuilder &theAdapter, Stats *theStats = nullptr)
 {
-  theAdapter.build<Traits>(theEdges, true);
+  theAdapter.build<Traits>(theEdges, true, theStats);
 }
 
 // ----------------------------------------------------------------------
@@ -856,9 +345,9 @@ void fill(const Edges &theEdges, FmiBuilder &theAdapter)
 // ----------------------------------------------------------------------
 
 template <typename Traits, typename Edges>
-void line(const Edges &theEdges, FmiBuilder &theAdapter)
+void line(const Edges &theEdges, FmiBuilder &theAdapter, Stats *theStats = nullptr)
 {
-  theAdapter.build<Traits>(theEdges, false);
+  theAdapter.build<Traits>(theEdges, false, theStats);
 }
 }  // namespace Builder
 
@@ -0,0 +1,208 @@
+#include "JobDump.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace Tron
+{
+namespace JobDump
+{
+namespace
+{
+const char magic[8] = "TRONJOB";
+const uint32_t version = 2;
+
+// Arrays are read in chunks of this many bytes so that the allocation
+// is bounded by the actual length of the stream
+const size_t chunk_size = 1 << 20;
+
+template <typename T>
+void write_raw(ostream &output, T value)
+{
+  output.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+T read_raw(istream &input)
+{
+  T value;
+  if (!input.read(reinterpret_cast<char *>(&value), sizeof(T)))
+    throw runtime_error("Unexpected end of contouring job dump");
+  return value;
+}
+
+template <typename T>
+void read_array(istream &input, vector<T> &values, uint64_t n)
+{
+  if (n > numeric_limits<size_t>::max() / sizeof(T))
+    throw runtime_error("Invalid array size in contouring job dump");
+
+  const size_t chunk = chunk_size / sizeof(T);
+  values.clear();
+  while (values.size() < n)
+  {
+    const size_t pos = values.size();
+    const size_t count = min<size_t>(chunk, n - pos);
+    values.resize(pos + count);
+    if (!input.read(reinterpret_cast<char *>(values.data() + pos), count * sizeof(T)))
+      throw runtime_error("Unexpected end of contouring job dump");
+  }
+}
+
+// Product of two sizes with overflow checking
+
+uint64_t multiply(uint64_t a, uint64_t b)
+{
+  if (a != 0 && b > numeric_limits<uint64_t>::max() / a)
+    throw runtime_error("Invalid array size in contouring job dump");
+  return a * b;
+}
+
+// Read an enumeration with the given number of values
+
+template <typename T>
+T read_enum(istream &input, uint32_t n, const char *name)
+{
+  const uint32_t value = read_raw<uint32_t>(input);
+  if (value >= n)
+    throw runtime_error(string("Invalid ") + name + " in contouring job dump");
+  return static_cast<T>(value);
+}
+
+}  // namespace
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Write the common header
+ */
+// ----------------------------------------------------------------------
+
+void write_header(ostream &theOutput, Kind theKind, Mode theMode, const Format &theFormat)
+{
+  theOutput.write(magic, sizeof(magic));
+  write_raw(theOutput, version);
+  write_raw(theOutput, static_cast<uint32_t>(theKind));
+  write_raw(theOutput, static_cast<uint32_t>(theMode));
+  write_raw(theOutput, static_cast<uint32_t>(theFormat.interpolation));
+  write_raw(theOutput, static_cast<uint32_t>(theFormat.missing));
+  write_raw(theOutput, static_cast<uint32_t>(theFormat.value));
+  write_raw(theOutput, static_cast<uint32_t>(theFormat.coord));
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Write a size
+ */
+// ----------------------------------------------------------------------
+
+void write_size(ostream &theOutput, uint64_t theSize)
+{
+  write_raw(theOutput, theSize);
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Write an array of doubles
+ */
+// ----------------------------------------------------------------------
+
+void write_values(ostream &theOutput, const vector<double> &theValues)
+{
+  theOutput.write(reinterpret_cast<const char *>(theValues.data()),
+                  theValues.size() * sizeof(double));
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Write the cell validity flags
+ */
+// ----------------------------------------------------------------------
+
+void write_valid(ostream &theOutput, const vector<uint8_t> &theValid)
+{
+  theOutput.write(reinterpret_cast<const char *>(theValid.data()), theValid.size());
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Next sequence number for naming dump files
+ */
+// ----------------------------------------------------------------------
+
+size_t sequence()
+{
+  static atomic<size_t> counter{0};
+  return counter.fetch_add(1, memory_order_relaxed);
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Read a job from a stream
+ */
+// ----------------------------------------------------------------------
+
+Job read(istream &theInput)
+{
+  char header[sizeof(magic)];
+  if (!theInput.read(header, sizeof(header)) || memcmp(header, magic, sizeof(magic)) != 0)
+    throw runtime_error("Not a contouring job dump");
+
+  if (read_raw<uint32_t>(theInput) != version)
+    throw runtime_error("Unsupported contouring job dump version");
+
+  Job job;
+  job.kind = read_enum<Kind>(theInput, 2, "job type");
+  job.mode = read_enum<Mode>(theInput, 2, "contouring mode");
+  job.format.interpolation = read_enum<Interpolation>(theInput, 4, "interpolation");
+  job.format.missing = read_enum<MissingPolicy>(theInput, 4, "missing value policy");
+  job.format.value = read_enum<Type>(theInput, 2, "value type");
+  job.format.coord = read_enum<Type>(theInput, 2, "coordinate type");
+
+  if (job.kind == Kind::Grid)
+  {
+    const uint64_t w = read_raw<uint64_t>(theInput);
+    const uint64_t h = read_raw<uint64_t>(theInput);
+    if (w < 2 || h < 2)
+      throw runtime_error("Invalid grid size in contouring job dump");
+    const uint64_t n = multiply(w, h);
+    job.width = w;
+    job.height = h;
+    job.lolimit = read_raw<double>(theInput);
+    job.hilimit = read_raw<double>(theInput);
+    read_array(theInput, job.values, n);
+    read_array(theInput, job.x, n);
+    read_array(theInput, job.y, n);
+    read_array(theInput, job.valid, multiply(w - 1, h - 1));
+  }
+  else
+  {
+    const uint64_t n = read_raw<uint64_t>(theInput);
+    read_array(theInput, job.edges, multiply(4, n));
+  }
+
+  return job;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Read a job from a file
+ */
+// ----------------------------------------------------------------------
+
+Job read(const string &theFilename)
+{
+  ifstream input(theFilename, ios::in | ios::binary);
+  if (!input)
+    throw runtime_error("Failed to open '" + theFilename + "' for reading");
+  return read(input);
+}
+
+}  // namespace JobDump
+}  // namespace Tron
@@ -0,0 +1,390 @@
+// ======================================================================
+/*!
+ * \brief Serialization of contouring jobs for offline replay
+ *
+ * When a particular model/parameter/level is slow to contour or the
+ * builder throws, the job can be dumped to a file and replayed outside
+ * the server, for example with the TronReplay program under perf.
+ *
+ * Two kinds of jobs can be dumped:
+ *
+ *  - a grid job: grid values, coordinates, cell validity and the limits
+ *  - an edge job: the prepared FlipSet edges passed to the builder
+ *
+ * The format is a native endian binary file:
+ *
+ *   char[8]   "TRONJOB" + '\0'
+ *   uint32    version
+ *   uint32    kind (Grid or Edges)
+ *   uint32    mode (Fill or Line)
+ *   uint32    interpolation (Linear, LogLinear, NearestNeighbour or Discrete)
+ *   uint32    missing value policy (NotMissing, NanMissing, InfMissing or FmiMissing)
+ *   uint32    value type (Double or Float)
+ *   uint32    coordinate type (Double or Float)
+ *
+ * followed for grid jobs by
+ *
+ *   uint64    width
+ *   uint64    height
+ *   double    lolimit (or the isovalue in line mode)
+ *   double    hilimit (NaN in line mode)
+ *   double    values[width*height]
+ *   double    x[width*height]
+ *   double    y[width*height]
+ *   uint8     valid[(width-1)*(height-1)]
+ *
+ * and for edge jobs by
+ *
+ *   uint64    count
+ *   double    x1,y1,x2,y2 [count]
+ *
+ * All arrays are stored with i running fastest. Float values and
+ * coordinates are stored widened to double, the types recorded in the
+ * header are used to narrow them back when the job is replayed. The
+ * interpolation and the missing value policy are irrelevant for edge
+ * jobs and are recorded as Linear and NanMissing.
+ *
+ * The sizes are validated while reading so that a truncated or corrupt
+ * dump cannot cause allocations larger than the stream itself.
+ *
+ * Grid jobs are written with the traits and the interpolation of the
+ * contourer being debugged:
+ *
+ *   Tron::JobDump::write<MyTraits, Tron::LinearInterpolation>(out, grid, mode, lo, hi);
+ *
+ * A Sampler can be used to dump only every N'th job so that the hook
+ * can be left enabled in production. DumpingBuilder.h provides a
+ * builder wrapper dumping the edge jobs of an existing builder.
+ */
+// ======================================================================
+
+#pragma once
+
+#include "Missing.h"
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace Tron
+{
+template <typename Traits>
+class LinearInterpolation;
+template <typename Traits>
+class LogLinearInterpolation;
+template <typename Traits>
+class NearestNeighbourInterpolation;
+template <typename Traits>
+class DiscreteInterpolation;
+
+namespace JobDump
+{
+enum class Kind : std::uint32_t
+{
+  Grid = 0,
+  Edges = 1
+};
+
+enum class Mode : std::uint32_t
+{
+  Fill = 0,
+  Line = 1
+};
+
+enum class Interpolation : std::uint32_t
+{
+  Linear = 0,
+  LogLinear = 1,
+  NearestNeighbour = 2,
+  Discrete = 3
+};
+
+enum class MissingPolicy : std::uint32_t
+{
+  NotMissing = 0,
+  NanMissing = 1,
+  InfMissing = 2,
+  FmiMissing = 3
+};
+
+enum class Type : std::uint32_t
+{
+  Double = 0,
+  Float = 1
+};
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief The template arguments of the dumped contourer
+ */
+// ----------------------------------------------------------------------
+
+struct Format
+{
+  Interpolation interpolation = Interpolation::Linear;
+  MissingPolicy missing = MissingPolicy::NanMissing;
+  Type value = Type::Double;
+  Type coord = Type::Double;
+};
+
+namespace Detail
+{
+template <template <typename> class I>
+struct InterpolationCode;
+
+template <>
+struct InterpolationCode<LinearInterpolation>
+{
+  static const Interpolation value = Interpolation::Linear;
+};
+
+template <>
+struct InterpolationCode<LogLinearInterpolation>
+{
+  static const Interpolation value = Interpolation::LogLinear;
+};
+
+template <>
+struct InterpolationCode<NearestNeighbourInterpolation>
+{
+  static const Interpolation value = Interpolation::NearestNeighbour;
+};
+
+template <>
+struct InterpolationCode<DiscreteInterpolation>
+{
+  static const Interpolation value = Interpolation::Discrete;
+};
+
+template <typename T>
+Type type_code()
+{
+  static_assert(std::is_same<T, float>::value || std::is_same<T, double>::value,
+                "JobDump supports only float and double values and coordinates");
+  return (std::is_same<T, float>::value ? Type::Float : Type::Double);
+}
+
+template <typename Traits>
+MissingPolicy missing_code()
+{
+  typedef typename Traits::value_type T;
+  if (std::is_base_of<Tron::NanMissing<T>, Traits>::value)
+    return MissingPolicy::NanMissing;
+  if (std::is_base_of<Tron::InfMissing<T>, Traits>::value)
+    return MissingPolicy::InfMissing;
+  if (std::is_base_of<Tron::FmiMissing<T>, Traits>::value)
+    return MissingPolicy::FmiMissing;
+  static_assert(std::is_base_of<Tron::NanMissing<T>, Traits>::value ||
+                    std::is_base_of<Tron::InfMissing<T>, Traits>::value ||
+                    std::is_base_of<Tron::FmiMissing<T>, Traits>::value ||
+                    std::is_base_of<Tron::NotMissing<T>, Traits>::value,
+                "JobDump supports only the missing value policies in Missing.h");
+  return MissingPolicy::NotMissing;
+}
+}  // namespace Detail
+
+// The format of a contourer with the given traits and interpolation
+template <typename Traits, template <typename> class Interpolation>
+Format format()
+{
+  Format ret;
+  ret.interpolation = Detail::InterpolationCode<Interpolation>::value;
+  ret.missing = Detail::missing_code<Traits>();
+  ret.value = Detail::type_code<typename Traits::value_type>();
+  ret.coord = Detail::type_code<typename Traits::coord_type>();
+  return ret;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief A job read back from a dump
+ */
+// ----------------------------------------------------------------------
+
+struct Job
+{
+  Kind kind = Kind::Grid;
+  Mode mode = Mode::Fill;
+  Format format;
+
+  // Grid jobs
+  std::size_t width = 0;
+  std::size_t height = 0;
+  double lolimit = std::numeric_limits<double>::quiet_NaN();
+  double hilimit = std::numeric_limits<double>::quiet_NaN();
+  std::vector<double> values;
+  std::vector<double> x;
+  std::vector<double> y;
+  std::vector<std::uint8_t> valid;
+
+  // Edge jobs, 4 coordinates per edge
+  std::vector<double> edges;
+};
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Grid adapter for replaying a grid job
+ *
+ * The values and coordinates are narrowed back to the given types,
+ * which should be those recorded in the job format.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Value = double, typename Coordinate = double>
+class Grid
+{
+ public:
+  typedef Value value_type;
+  typedef std::size_t size_type;
+  typedef Coordinate coord_type;
+
+  Grid(const Job& theJob)
+      : itsJob(theJob),
+        itsValues(theJob.values.begin(), theJob.values.end()),
+        itsX(theJob.x.begin(), theJob.x.end()),
+        itsY(theJob.y.begin(), theJob.y.end())
+  {
+  }
+  Grid() = delete;
+
+  size_type width() const { return itsJob.width; }
+  size_type height() const { return itsJob.height; }
+  const value_type& operator()(size_type i, size_type j) const
+  {
+    return itsValues[i + itsJob.width * j];
+  }
+  coord_type x(size_type i, size_type j) const { return itsX[i + itsJob.width * j]; }
+  coord_type y(size_type i, size_type j) const { return itsY[i + itsJob.width * j]; }
+  bool valid(size_type i, size_type j) const
+  {
+    return itsJob.valid[i + (itsJob.width - 1) * j] != 0;
+  }
+
+ private:
+  const Job& itsJob;
+  std::vector<value_type> itsValues;
+  std::vector<coord_type> itsX;
+  std::vector<coord_type> itsY;
+};
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Dump every N'th job. Thread safe and lock free.
+ *
+ * A period of zero disables dumping, a period of one dumps everything.
+ */
+// ----------------------------------------------------------------------
+
+class Sampler
+{
+ public:
+  explicit Sampler(std::size_t thePeriod = 0) : itsPeriod(thePeriod) {}
+
+  bool sample()
+  {
+    if (itsPeriod == 0)
+      return false;
+    return (itsCounter.fetch_add(1, std::memory_order_relaxed) % itsPeriod == 0);
+  }
+
+ private:
+  const std::size_t itsPeriod;
+  std::atomic<std::size_t> itsCounter{0};
+};
+
+// Low level output used by the templates below
+void write_header(std::ostream& theOutput, Kind theKind, Mode theMode, const Format& theFormat);
+void write_values(std::ostream& theOutput, const std::vector<double>& theValues);
+void write_size(std::ostream& theOutput, std::uint64_t theSize);
+void write_valid(std::ostream& theOutput, const std::vector<std::uint8_t>& theValid);
+
+// Process wide sequence number for naming dump files
+std::size_t sequence();
+
+// Read a job, throws on errors
+Job read(std::istream& theInput);
+Job read(const std::string& theFilename);
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Dump a grid job
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits, template <typename> class Interpolation, typename Grid>
+void write(std::ostream& theOutput,
+           const Grid& theGrid,
+           Mode theMode,
+           double theLoLimit,
+           double theHiLimit = std::numeric_limits<double>::quiet_NaN())
+{
+  const std::size_t w = theGrid.width();
+  const std::size_t h = theGrid.height();
+
+  write_header(theOutput, Kind::Grid, theMode, format<Traits, Interpolation>());
+  write_size(theOutput, w);
+  write_size(theOutput, h);
+  write_values(theOutput, {theLoLimit, theHiLimit});
+
+  std::vector<double> values;
+  values.reserve(w * h);
+
+  for (std::size_t j = 0; j < h; j++)
+    for (std::size_t i = 0; i < w; i++)
+      values.push_back(theGrid(i, j));
+  write_values(theOutput, values);
+
+  values.clear();
+  for (std::size_t j = 0; j < h; j++)
+    for (std::size_t i = 0; i < w; i++)
+      values.push_back(theGrid.x(i, j));
+  write_values(theOutput, values);
+
+  values.clear();
+  for (std::size_t j = 0; j < h; j++)
+    for (std::size_t i = 0; i < w; i++)
+      values.push_back(theGrid.y(i, j));
+  write_values(theOutput, values);
+
+  std::vector<std::uint8_t> valid;
+  valid.reserve((w - 1) * (h - 1));
+  for (std::size_t j = 0; j < h - 1; j++)
+    for (std::size_t i = 0; i < w - 1; i++)
+      valid.push_back(theGrid.valid(i, j) ? 1 : 0);
+  write_valid(theOutput, valid);
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Dump the prepared edges passed to a builder
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits, typename Edges>
+void write_edges(std::ostream& theOutput, const Edges& theEdges, Mode theMode)
+{
+  Format fmt;
+  fmt.value = Detail::type_code<typename Traits::value_type>();
+  fmt.coord = Detail::type_code<typename Traits::coord_type>();
+  write_header(theOutput, Kind::Edges, theMode, fmt);
+  write_size(theOutput, theEdges.size());
+
+  std::vector<double> values;
+  values.reserve(4 * theEdges.size());
+  for (const auto& edge : theEdges)
+  {
+    values.push_back(edge.x1());
+    values.push_back(edge.y1());
+    values.push_back(edge.x2());
+    values.push_back(edge.y2());
+  }
+  write_values(theOutput, values);
+}
+
+}  // namespace JobDump
+}  // namespace Tron
+
+// ======================================================================
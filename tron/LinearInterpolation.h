@@ -41,7 +41,7 @@ class LinearInterpolation : public Traits
   typedef Edge<Traits> MyEdge;
   typedef FlipSet<MyEdge> MyFlipSet;
 
- private:
+ protected:
   // Interpolate intersection coordinate. Note that we perform
   // the arithmetic with sorted coordinates to guarantee the
   // same results for adjacent triangles (this prevents mismatches
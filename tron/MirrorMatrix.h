@@ -21,6 +21,9 @@
  * for j.
  *
  * Warning: The mirroring does not extend beyond one grid width!
+ *
+ * PaddedMatrix.h materializes the same values into a padded buffer,
+ * which is faster for repeated stencil access and allows wider halos.
  */
 // ======================================================================
 
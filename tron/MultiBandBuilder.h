@@ -0,0 +1,230 @@
+// ======================================================================
+/*!
+ * \brief Builder collecting several isobands into a shared arc table
+ *
+ * Simplifying adjacent isobands independently produces gaps and
+ * overlaps between them, since the shared isoline is simplified
+ * differently in each band. The MultiBandBuilder instead collects all
+ * the bands first, splits the rings into arcs shared by the bands
+ * (see ArcTable.h), and simplifies each arc once. Hence the bands stay
+ * exactly adjacent after simplification and each boundary is output
+ * only once.
+ *
+ * Usage:
+ *
+ *   Tron::MultiBandBuilder<MyTraits> builder(tolerance);
+ *   for (band : bands)
+ *     MyContourer::fill(builder, grid, band.lolimit, band.hilimit);
+ *   builder.finish();
+ *
+ *   for (arc : builder.arcs()) ...                  output the arcs once
+ *   for (polygon : builder.polygons(band)) ...      arc references per band
+ *   Ring<MyTraits> ring = builder.ring(polygon.shell);
+ *
+ * The builder traits must match those used by the contourer. Only
+ * fill mode is supported, isolines are not shared between bands.
+ */
+// ======================================================================
+
+#pragma once
+
+#include "ArcTable.h"
+#include "RingBuilder.h"
+#include "Stats.h"
+#include <boost/utility.hpp>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace Tron
+{
+template <typename Traits>
+class MultiBandBuilder : private boost::noncopyable
+{
+ public:
+  using Table = ArcTable<Traits>;
+  using RingArcs = typename Table::RingArcs;
+
+  // A polygon as arc references
+  struct Polygon
+  {
+    RingArcs shell;
+    std::vector<RingArcs> holes;
+  };
+
+  using Polygons = std::vector<Polygon>;
+
+  ~MultiBandBuilder() = default;
+  MultiBandBuilder(const MultiBandBuilder &other) = delete;
+  MultiBandBuilder &operator=(const MultiBandBuilder &other) = delete;
+  MultiBandBuilder(MultiBandBuilder &&other) = delete;
+  MultiBandBuilder &operator=(MultiBandBuilder &&other) = delete;
+
+  explicit MultiBandBuilder(double theTolerance = 0) : itsTolerance(theTolerance) {}
+
+  template <typename Edges>
+  void build(const Edges &theEdges, bool fillmode, Stats *theStats = nullptr);
+
+  void finish(Stats *theStats = nullptr);
+
+  // Available after finish
+  std::size_t bands() const { return itsBands.size(); }
+  const Table &arcs() const { return itsTable; }
+  const Polygons &polygons(std::size_t theBand) const { return itsBands.at(theBand); }
+  Ring<Traits> ring(const RingArcs &theArcs) const { return itsTable.ring(theArcs); }
+
+  // Move the results out after finish, the builder is left empty
+  Table release_arcs() { return std::move(itsTable); }
+  std::vector<Polygons> release_polygons() { return std::move(itsBands); }
+
+ private:
+  struct RingPolygon
+  {
+    Ring<Traits> shell;
+    std::vector<Ring<Traits>> holes;
+  };
+
+  double itsTolerance;
+  bool itsFinished = false;
+
+  // Rings collected before finish
+  std::vector<std::vector<RingPolygon>> itsRings;
+
+  Table itsTable;
+  std::vector<Polygons> itsBands;
+
+};  // class MultiBandBuilder
+
+// ----------------------------------------------------------------------
+/*
+ * \brief Build the polygons of a new band
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+template <typename Edges>
+void MultiBandBuilder<Traits>::build(const Edges &edges, bool fillmode, Stats *stats)
+{
+  if (!fillmode)
+    throw std::runtime_error("MultiBandBuilder supports only isobands");
+  if (itsFinished)
+    throw std::runtime_error("MultiBandBuilder: cannot add bands after finish");
+
+  RingAssembly<Traits> assembly;
+  auto &polylines = assembly.polylines;
+
+  StageTimer buildtimer(stats, Stats::BuildRings);
+  build_rings(edges, assembly);
+  buildtimer.stop();
+
+  if (stats)
+    stats->rings += polylines.size();
+
+  StageTimer findtimer(stats, Stats::FindShell);
+  const HoleShells holeshells = assign_holes(edges, assembly);
+  findtimer.stop();
+
+  const PolygonList parts = collect_polygons(polylines, holeshells);
+
+  if (stats)
+  {
+    stats->shells += parts.size();
+    stats->holes += holeshells.size();
+  }
+
+  itsRings.emplace_back();
+  auto &band = itsRings.back();
+  band.reserve(parts.size());
+  for (const auto &part : parts)
+  {
+    band.emplace_back();
+    band.back().shell.swap(polylines[part.shell]);
+    for (auto hole : part.holes)
+    {
+      band.back().holes.emplace_back();
+      band.back().holes.back().swap(polylines[hole]);
+    }
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Build the shared arcs and simplify them
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+void MultiBandBuilder<Traits>::finish(Stats *stats)
+{
+  if (itsFinished)
+    return;
+  itsFinished = true;
+
+  StageTimer outputtimer(stats, Stats::GeosConversion);
+
+  for (const auto &band : itsRings)
+    for (const auto &polygon : band)
+    {
+      itsTable.add_vertices(polygon.shell);
+      for (const auto &hole : polygon.holes)
+        itsTable.add_vertices(hole);
+    }
+
+  // All the rings are needed for validating the simplified arcs
+  std::vector<RingArcs> allrings;
+
+  for (auto &band : itsRings)
+  {
+    itsBands.emplace_back();
+    auto &polygons = itsBands.back();
+    polygons.reserve(band.size());
+    for (const auto &polygon : band)
+    {
+      polygons.emplace_back();
+      polygons.back().shell = itsTable.split(polygon.shell);
+      allrings.push_back(polygons.back().shell);
+      for (const auto &hole : polygon.holes)
+      {
+        polygons.back().holes.push_back(itsTable.split(hole));
+        allrings.push_back(polygons.back().holes.back());
+      }
+    }
+    band.clear();
+  }
+  itsRings.clear();
+  outputtimer.stop();
+
+  StageTimer simplifytimer(stats, Stats::Simplify);
+  itsTable.simplify(itsTolerance, allrings);
+}
+
+namespace Builder
+{
+// ----------------------------------------------------------------------
+/*
+ * \brief Multiband builder for polygons
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits, typename Edges>
+void fill(const Edges &theEdges, MultiBandBuilder<Traits> &theAdapter, Stats *theStats = nullptr)
+{
+  theAdapter.build(theEdges, true, theStats);
+}
+
+// ----------------------------------------------------------------------
+/*
+ * \brief Multiband builder for lines, not supported
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits, typename Edges>
+void line(const Edges &theEdges, MultiBandBuilder<Traits> &theAdapter, Stats *theStats = nullptr)
+{
+  theAdapter.build(theEdges, false, theStats);
+}
+}  // namespace Builder
+
+}  // namespace Tron
+
+// ======================================================================
@@ -0,0 +1,121 @@
+// ======================================================================
+/*!
+ * \brief Matrix copy with a materialized mirror halo
+ *
+ * MirrorMatrix evaluates the reflection formulas on every access. This
+ * class instead copies the matrix once into a contiguous buffer with a
+ * halo of the given width on all sides, filled using the same formulas:
+ *
+ *   f(-k) = 2*f(0) - f(k)
+ *   f(w-1+k) = 2*f(w-1) - f(w-1-k)
+ *
+ * Stencils can then read any neighbour within the halo with plain
+ * pointer arithmetic:
+ *
+ *   Tron::PaddedMatrix<MyGrid> padded(grid, radius);
+ *   const auto* row = padded.data(i - radius, j);
+ *   for (int k = 0; k <= 2 * radius; k++) sum += row[k];
+ *
+ * Within one grid width the values are identical to those of MirrorMatrix.
+ * Since the halo is filled outwards from the grid, wider halos simply
+ * reflect the already reflected values, and linear trends continue
+ * indefinitely. A grid only one cell wide or high has no trend, its
+ * single value is then repeated instead.
+ */
+// ======================================================================
+
+#pragma once
+
+#include <vector>
+
+namespace Tron
+{
+template <typename T>
+class PaddedMatrix
+{
+ public:
+  typedef typename T::value_type value_type;
+  typedef long size_type;
+
+  PaddedMatrix(const T& theMatrix, size_type thePadding)
+      : itsWidth(theMatrix.width()),
+        itsHeight(theMatrix.height()),
+        itsPadding(thePadding),
+        itsStride(itsWidth + 2 * thePadding),
+        itsData(itsStride * (itsHeight + 2 * thePadding))
+  {
+    if (itsWidth == 0 || itsHeight == 0) return;
+
+    for (size_type j = 0; j < itsHeight; j++)
+    {
+      value_type* row = writable(0, j);
+      for (size_type i = 0; i < itsWidth; i++)
+        row[i] = theMatrix(i, j);
+    }
+
+    // Mirror the columns first and then the full padded rows, which
+    // evaluates the corners in the same order as MirrorMatrix
+
+    for (size_type i = 0; i < itsWidth; i++)
+      extend(writable(i, 0), itsHeight, itsStride);
+
+    for (size_type j = -itsPadding; j < itsHeight + itsPadding; j++)
+      extend(writable(0, j), itsWidth, 1);
+  }
+
+  // Size of the original matrix
+  size_type width() const { return itsWidth; }
+  size_type height() const { return itsHeight; }
+
+  size_type padding() const { return itsPadding; }
+
+  // Distance between rows in the buffer
+  size_type stride() const { return itsStride; }
+
+  // Unchecked access for -padding <= i < width+padding, and similarly for j
+  const value_type& operator()(size_type i, size_type j) const { return *data(i, j); }
+
+  const value_type* data(size_type i, size_type j) const
+  {
+    return &itsData[(j + itsPadding) * itsStride + i + itsPadding];
+  }
+
+ private:
+  PaddedMatrix();
+
+  value_type* writable(size_type i, size_type j)
+  {
+    return &itsData[(j + itsPadding) * itsStride + i + itsPadding];
+  }
+
+  // Fill the halo around n values at the given step outwards one layer at a time
+  void extend(value_type* line, size_type n, size_type step)
+  {
+    for (size_type k = 1; k <= itsPadding; k++)
+    {
+      value_type* before = line - k * step;
+      value_type* after = line + (n - 1 + k) * step;
+      if (n == 1)
+      {
+        *before = line[0];
+        *after = line[0];
+      }
+      else
+      {
+        *before = 2 * line[0] - line[k * step];
+        *after = 2 * line[(n - 1) * step] - line[(n - 1 - k) * step];
+      }
+    }
+  }
+
+  size_type itsWidth;
+  size_type itsHeight;
+  size_type itsPadding;
+  size_type itsStride;
+  std::vector<value_type> itsData;
+
+};  // class PaddedMatrix
+
+}  // namespace Tron
+
+// ======================================================================
@@ -0,0 +1,105 @@
+// ======================================================================
+/*!
+ * \brief Simple data parallelism by splitting rows between threads
+ *
+ * Parallel::for_rows(rows, threads, f) calls f(begin, end) for
+ * consecutive blocks of rows covering 0...rows-1. The blocks are
+ * processed by separate threads, the calling thread processing the
+ * first block. A thread count of zero means one thread per hardware
+ * thread, one means the work is done in the calling thread only.
+ *
+ * The first exception thrown by any of the threads is rethrown once
+ * all the threads have finished.
+ */
+// ======================================================================
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Tron
+{
+namespace Parallel
+{
+// ----------------------------------------------------------------------
+/*!
+ * \brief Resolve the actual number of threads to use
+ */
+// ----------------------------------------------------------------------
+
+inline unsigned int threads(unsigned int theThreads, std::size_t theRows)
+{
+  if (theThreads == 0)
+    theThreads = std::max(1U, std::thread::hardware_concurrency());
+  return static_cast<unsigned int>(std::min<std::size_t>(theThreads, std::max<std::size_t>(1, theRows)));
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Process rows in parallel
+ */
+// ----------------------------------------------------------------------
+
+template <typename Function>
+void for_rows(std::size_t theRows, unsigned int theThreads, Function &&theFunction)
+{
+  const unsigned int nthreads = threads(theThreads, theRows);
+
+  if (nthreads <= 1)
+  {
+    theFunction(std::size_t(0), theRows);
+    return;
+  }
+
+  std::exception_ptr error;
+  std::mutex mutex;
+
+  auto work = [&](std::size_t begin, std::size_t end)
+  {
+    try
+    {
+      theFunction(begin, end);
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!error)
+        error = std::current_exception();
+    }
+  };
+
+  // Distribute the remainder evenly to the first blocks
+  const std::size_t blocksize = theRows / nthreads;
+  const std::size_t remainder = theRows % nthreads;
+
+  std::vector<std::thread> workers;
+  workers.reserve(nthreads - 1);
+
+  std::size_t begin = blocksize + (remainder > 0 ? 1 : 0);
+  const std::size_t firstend = begin;
+
+  for (unsigned int i = 1; i < nthreads; i++)
+  {
+    const std::size_t end = begin + blocksize + (i < remainder ? 1 : 0);
+    workers.emplace_back(work, begin, end);
+    begin = end;
+  }
+
+  work(0, firstend);
+
+  for (auto &worker : workers)
+    worker.join();
+
+  if (error)
+    std::rethrow_exception(error);
+}
+
+}  // namespace Parallel
+}  // namespace Tron
+
+// ======================================================================
@@ -0,0 +1,172 @@
+// ======================================================================
+/*!
+ * \brief Builder driving a path sink with moveto/lineto/closepath
+ *
+ * The sink is expected to have the interface documented in Contourer.h:
+ *
+ * class Sink
+ * {
+ *   public:
+ *     void moveto(x,y);
+ *     void lineto(x,y);
+ *     void closepath();
+ * }
+ *
+ * which matches for example Cairo or AGG path storage with a small
+ * wrapper. This makes it possible to render contours without creating
+ * any GEOS geometries.
+ *
+ * In fill mode each polygon is output as its shell followed by its
+ * holes, each ring terminated by closepath. The shells are clockwise
+ * and the holes counter-clockwise, hence both the nonzero and evenodd
+ * fill rules work. The duplicate closing point of a ring is not passed
+ * to the sink.
+ *
+ * In line mode open isolines are output with moveto and lineto only,
+ * closed isolines are terminated by closepath so that the line joins
+ * are rendered properly.
+ *
+ * Usage:
+ *
+ *   MySink sink;
+ *   Tron::PathBuilder<MySink> builder(sink);
+ *   MyContourer::fill(builder, grid, lolimit, hilimit);
+ */
+// ======================================================================
+
+#pragma once
+
+#include "RingBuilder.h"
+#include "Stats.h"
+#include <boost/utility.hpp>
+
+namespace Tron
+{
+template <typename Sink>
+class PathBuilder : private boost::noncopyable
+{
+ public:
+  PathBuilder(Sink &theSink) : itsSink(theSink) {}
+  PathBuilder() = delete;
+
+  Sink &sink() { return itsSink; }
+
+  template <typename Traits, typename Edges>
+  void build(const Edges &theEdges, bool fillmode, Stats *theStats = nullptr);
+
+ private:
+  template <typename Traits>
+  void output(const Ring<Traits> &theRing);
+
+  Sink &itsSink;
+
+};  // class PathBuilder
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Output a single ring or polyline
+ */
+// ----------------------------------------------------------------------
+
+template <typename Sink>
+template <typename Traits>
+inline void PathBuilder<Sink>::output(const Ring<Traits> &theRing)
+{
+  if (theRing.empty())
+    return;
+
+  const bool closed = theRing.closed();
+
+  auto it = theRing.begin();
+  auto end = theRing.end();
+  if (closed)
+    --end;
+
+  itsSink.moveto(it->first, it->second);
+  for (++it; it != end; ++it)
+    itsSink.lineto(it->first, it->second);
+
+  if (closed)
+    itsSink.closepath();
+}
+
+// ----------------------------------------------------------------------
+/*
+ * \brief Build polygons or polylines from the given edges
+ */
+// ----------------------------------------------------------------------
+
+template <typename Sink>
+template <typename Traits, typename Edges>
+inline void PathBuilder<Sink>::build(const Edges &edges, bool fillmode, Stats *stats)
+{
+  RingAssembly<Traits> assembly;
+  const auto &polylines = assembly.polylines;
+
+  StageTimer buildtimer(stats, Stats::BuildRings);
+  build_rings(edges, assembly);
+  buildtimer.stop();
+
+  if (stats)
+    stats->rings += polylines.size();
+
+  if (!fillmode)
+  {
+    StageTimer outputtimer(stats, Stats::GeosConversion);
+    for (const auto &polyline : polylines)
+      output(polyline);
+    return;
+  }
+
+  StageTimer findtimer(stats, Stats::FindShell);
+  const HoleShells holeshells = assign_holes(edges, assembly);
+  findtimer.stop();
+
+  StageTimer outputtimer(stats, Stats::GeosConversion);
+
+  const PolygonList parts = collect_polygons(polylines, holeshells);
+
+  if (stats)
+  {
+    stats->shells += parts.size();
+    stats->holes += holeshells.size();
+  }
+
+  for (const auto &part : parts)
+  {
+    output(polylines[part.shell]);
+    for (auto hole : part.holes)
+      output(polylines[hole]);
+  }
+}
+
+namespace Builder
+{
+// ----------------------------------------------------------------------
+/*
+ * \brief Path builder for polygons
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits, typename Edges, typename Sink>
+void fill(const Edges &theEdges, PathBuilder<Sink> &theAdapter, Stats *theStats = nullptr)
+{
+  theAdapter.template build<Traits>(theEdges, true, theStats);
+}
+
+// ----------------------------------------------------------------------
+/*
+ * \brief Path builder for lines
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits, typename Edges, typename Sink>
+void line(const Edges &theEdges, PathBuilder<Sink> &theAdapter, Stats *theStats = nullptr)
+{
+  theAdapter.template build<Traits>(theEdges, false, theStats);
+}
+}  // namespace Builder
+
+}  // namespace Tron
+
+// ======================================================================
@@ -0,0 +1,103 @@
+// ======================================================================
+/*!
+ * \brief Grid adapter for global grids which wrap around in longitude
+ *
+ * A global lat/lon grid is normally contoured as an open rectangle,
+ * hence there is a one cell wide gap between the last and the first
+ * column, and every band is cut there. The adapter appends column 0
+ * once more after the last column, with the x-coordinate shifted by
+ * the period. The contourer then also processes the cells between
+ * columns w-1 and 0, and the bands continue seamlessly to the map
+ * edge without copying the grid or uniting the pieces afterwards:
+ *
+ *   Tron::PeriodicGrid<MyGrid> wrapped(grid, 360);
+ *   Tron::Contourer<Tron::PeriodicGrid<MyGrid>, ...>::fill(builder, wrapped, lo, hi);
+ *
+ * The grid must not already repeat the first column at the end. Hints,
+ * cell masks and the other grid based utilities work as usual on the
+ * adapter, since it simply appears one column wider.
+ *
+ * The underlying grid has no valid() for the wrap cells. By default a
+ * wrap cell is valid if the coordinates of its corners in the last and
+ * the first column are finite. The neighbouring cells cannot be used
+ * instead, since they depend on the second and the second to last
+ * columns too. Grids whose validity depends on something else should
+ * pass a predicate telling whether the wrap cell on row j is valid:
+ *
+ *   Tron::PeriodicGrid<MyGrid> wrapped(grid, 360, [&](int j) { return ...; });
+ */
+// ======================================================================
+
+#pragma once
+
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+namespace Tron
+{
+template <typename Grid>
+class PeriodicGrid
+{
+ public:
+  typedef typename Grid::value_type value_type;
+  typedef typename Grid::size_type size_type;
+  typedef typename Grid::coord_type coord_type;
+  typedef std::function<bool(size_type j)> validity_type;
+
+  PeriodicGrid(const Grid& theGrid,
+               coord_type thePeriod,
+               validity_type theWrapValidity = validity_type())
+      : itsGrid(theGrid),
+        itsWidth(theGrid.width()),
+        itsPeriod(thePeriod),
+        itsWrapValidity(std::move(theWrapValidity))
+  {
+    if (itsWidth < 2)
+      throw std::runtime_error("PeriodicGrid requires a grid at least 2 columns wide");
+  }
+
+  size_type width() const { return itsWidth + 1; }
+  size_type height() const { return itsGrid.height(); }
+
+  value_type operator()(size_type i, size_type j) const { return itsGrid(wrap(i), j); }
+
+  coord_type x(size_type i, size_type j) const
+  {
+    if (i == itsWidth)
+      return itsGrid.x(0, j) + itsPeriod;
+    return itsGrid.x(i, j);
+  }
+
+  coord_type y(size_type i, size_type j) const { return itsGrid.y(wrap(i), j); }
+
+  bool valid(size_type i, size_type j) const
+  {
+    if (i + 1 != itsWidth)
+      return itsGrid.valid(i, j);
+    if (itsWrapValidity)
+      return itsWrapValidity(j);
+    return (finite(i, j) && finite(i, j + 1) && finite(0, j) && finite(0, j + 1));
+  }
+
+ private:
+  PeriodicGrid();
+
+  size_type wrap(size_type i) const { return (i == itsWidth ? 0 : i); }
+
+  bool finite(size_type i, size_type j) const
+  {
+    return std::isfinite(itsGrid.x(i, j)) && std::isfinite(itsGrid.y(i, j));
+  }
+
+  const Grid& itsGrid;
+  size_type itsWidth;
+  coord_type itsPeriod;
+  validity_type itsWrapValidity;
+
+};  // class PeriodicGrid
+
+}  // namespace Tron
+
+// ======================================================================
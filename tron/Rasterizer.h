@@ -0,0 +1,330 @@
+// ======================================================================
+/*!
+ * \brief Direct rasterization of isobands into a class index image
+ *
+ * Rendering a classified image by contouring, building polygons and
+ * then rasterizing them is wasteful. The Rasterizer instead classifies
+ * each output pixel directly from the grid using the same semantics
+ * as LinearInterpolation in fill mode, so the pixels agree with the
+ * vector output:
+ *
+ *  - cells with one missing corner are handled as a triangle
+ *  - saddle cells are split into four triangles around the mean value
+ *  - inside triangles the value is interpolated linearly
+ *  - other cells use the band polygons formed by the interpolated
+ *    intersections along the cell edges
+ *
+ * The grid is the same as for Contourer, but only the values and
+ * cell validity are used: the transform maps the centre of each output
+ * pixel to fractional grid indexes (i,j). Hence the raster agrees with
+ * the vector output exactly when the grid coordinates are an affine
+ * function of the grid indexes in the output projection. Non-affine
+ * cases can be handled with a custom transform doing the reprojection
+ * and index lookup.
+ *
+ * The transform must be a thread safe functor with the signature
+ *
+ *   void operator()(double col, double row, double& i, double& j) const;
+ *
+ * The output image is row major with one byte per pixel. Zero means
+ * the pixel is not covered by any band, value k+1 means the pixel is
+ * in band k, that is limits[k] <= value < limits[k+1]. A missing
+ * limit means -inf or +inf as in Contourer::fill.
+ *
+ * Rows are processed in parallel, see Parallel.h for the thread count.
+ */
+// ======================================================================
+
+#pragma once
+
+#include "LinearInterpolation.h"
+#include "Parallel.h"
+#include "SmallVector.h"
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace Tron
+{
+// ----------------------------------------------------------------------
+/*!
+ * \brief Affine pixel to grid index transformation
+ *
+ * i = i0 + di_dcol * col + di_drow * row
+ * j = j0 + dj_dcol * col + dj_drow * row
+ */
+// ----------------------------------------------------------------------
+
+class AffineTransform
+{
+ public:
+  AffineTransform(
+      double theI0, double theDIDCol, double theDIDRow, double theJ0, double theDJDCol, double theDJDRow)
+      : itsI0(theI0),
+        itsDIDCol(theDIDCol),
+        itsDIDRow(theDIDRow),
+        itsJ0(theJ0),
+        itsDJDCol(theDJDCol),
+        itsDJDRow(theDJDRow)
+  {
+  }
+
+  void operator()(double col, double row, double& i, double& j) const
+  {
+    i = itsI0 + itsDIDCol * col + itsDIDRow * row;
+    j = itsJ0 + itsDJDCol * col + itsDJDRow * row;
+  }
+
+ private:
+  double itsI0, itsDIDCol, itsDIDRow;
+  double itsJ0, itsDJDCol, itsDJDRow;
+};
+
+template <typename Grid, typename Traits>
+class Rasterizer : public LinearInterpolation<Traits>
+{
+ public:
+  typedef LinearInterpolation<Traits> Interpolation;
+  typedef typename Traits::value_type value_type;
+  typedef typename Traits::coord_type coord_type;
+  typedef std::vector<value_type> Limits;
+  typedef std::vector<std::uint8_t> Image;
+
+  // ----------------------------------------------------------------------
+  /*!
+   * \brief Classify a width x height image
+   */
+  // ----------------------------------------------------------------------
+
+  template <typename Transform>
+  static Image fill(const Grid& grid,
+                    const Limits& limits,
+                    std::size_t width,
+                    std::size_t height,
+                    const Transform& transform,
+                    unsigned int threads = 0)
+  {
+    if (limits.size() < 2)
+      throw std::runtime_error("Rasterizer requires at least two limits");
+    if (limits.size() > 256)
+      throw std::runtime_error("Rasterizer supports at most 255 bands");
+
+    Image image(width * height, 0);
+
+    Parallel::for_rows(height,
+                       threads,
+                       [&](std::size_t begin, std::size_t end)
+                       {
+                         double i = 0, j = 0;
+                         for (std::size_t row = begin; row < end; row++)
+                         {
+                           std::uint8_t* out = &image[row * width];
+                           for (std::size_t col = 0; col < width; col++)
+                           {
+                             transform(col + 0.5, row + 0.5, i, j);
+                             out[col] = classify(grid, limits, i, j);
+                           }
+                         }
+                       });
+    return image;
+  }
+
+  // ----------------------------------------------------------------------
+  /*!
+   * \brief Classify a single point given in fractional grid indexes
+   */
+  // ----------------------------------------------------------------------
+
+  static std::uint8_t classify(const Grid& grid, const Limits& limits, double i, double j)
+  {
+    const double w = grid.width();
+    const double h = grid.height();
+
+    if (!(i >= 0 && j >= 0 && i <= w - 1 && j <= h - 1))
+      return 0;
+
+    // The last row and column belong to the previous cell
+    const auto ci = static_cast<typename Grid::size_type>(std::min(std::floor(i), w - 2));
+    const auto cj = static_cast<typename Grid::size_type>(std::min(std::floor(j), h - 2));
+
+    if (!grid.valid(ci, cj))
+      return 0;
+
+    // Corners in clockwise order, using grid indexes as coordinates
+
+    const coord_type x1 = ci, y1 = cj;
+    const coord_type x2 = ci, y2 = cj + 1;
+    const coord_type x3 = ci + 1, y3 = cj + 1;
+    const coord_type x4 = ci + 1, y4 = cj;
+
+    const value_type z1 = grid(ci, cj);
+    const value_type z2 = grid(ci, cj + 1);
+    const value_type z3 = grid(ci + 1, cj + 1);
+    const value_type z4 = grid(ci + 1, cj);
+
+    const bool m1 = Interpolation::missing(z1);
+    const bool m2 = Interpolation::missing(z2);
+    const bool m3 = Interpolation::missing(z3);
+    const bool m4 = Interpolation::missing(z4);
+
+    if (m1 + m2 + m3 + m4 > 1)
+      return 0;
+
+    if (m1)
+      return triangle(limits, i, j, x2, y2, z2, x3, y3, z3, x4, y4, z4);
+    if (m2)
+      return triangle(limits, i, j, x1, y1, z1, x3, y3, z3, x4, y4, z4);
+    if (m3)
+      return triangle(limits, i, j, x1, y1, z1, x2, y2, z2, x4, y4, z4);
+    if (m4)
+      return triangle(limits, i, j, x1, y1, z1, x2, y2, z2, x3, y3, z3);
+
+    // Quick exit if all corners are in the same band, or all are outside the
+    // bands on the same side. Corners below and above all the bands may still
+    // have bands between them.
+
+    const int b1 = band(limits, z1);
+    const int b2 = band(limits, z2);
+    const int b3 = band(limits, z3);
+    const int b4 = band(limits, z4);
+
+    if (b1 == b2 && b2 == b3 && b3 == b4)
+    {
+      if (b1 >= 0)
+        return static_cast<std::uint8_t>(b1 + 1);
+
+      const auto c1 = Interpolation::placement(z1, limits.front(), limits.back());
+      if (c1 == Interpolation::placement(z2, limits.front(), limits.back()) &&
+          c1 == Interpolation::placement(z3, limits.front(), limits.back()) &&
+          c1 == Interpolation::placement(z4, limits.front(), limits.back()))
+        return 0;
+    }
+
+    if (Interpolation::is_saddle(z1, z2, z3, z4))
+    {
+      const coord_type x0 = (x1 + x2 + x3 + x4) / 4;
+      const coord_type y0 = (y1 + y2 + y3 + y4) / 4;
+      const value_type z0 = (z1 + z2 + z3 + z4) / 4;
+
+      // Select the triangle by the diagonals of the cell
+      const double dx = i - x0;
+      const double dy = j - y0;
+      if (dy >= std::abs(dx))
+        return triangle(limits, i, j, x2, y2, z2, x3, y3, z3, x0, y0, z0);
+      if (dx >= std::abs(dy))
+        return triangle(limits, i, j, x3, y3, z3, x4, y4, z4, x0, y0, z0);
+      if (-dy >= std::abs(dx))
+        return triangle(limits, i, j, x4, y4, z4, x1, y1, z1, x0, y0, z0);
+      return triangle(limits, i, j, x1, y1, z1, x2, y2, z2, x0, y0, z0);
+    }
+
+    // Test the band polygons of all the bands the corners touch
+
+    const int nbands = static_cast<int>(limits.size()) - 1;
+    int lo = std::max(0, std::min({b1, b2, b3, b4}));
+    int hi = std::max({b1, b2, b3, b4});
+    if (b1 < 0 || b2 < 0 || b3 < 0 || b4 < 0)
+    {
+      // Corners outside all bands may be below or above all of them
+      lo = 0;
+      hi = nbands - 1;
+    }
+
+    for (int k = lo; k <= hi; k++)
+    {
+      const value_type lolimit = limits[k];
+      const value_type hilimit = limits[k + 1];
+
+      const auto c1 = Interpolation::placement(z1, lolimit, hilimit);
+      const auto c2 = Interpolation::placement(z2, lolimit, hilimit);
+      const auto c3 = Interpolation::placement(z3, lolimit, hilimit);
+      const auto c4 = Interpolation::placement(z4, lolimit, hilimit);
+
+      if (c1 == c2 && c2 == c3 && c3 == c4)
+        continue;
+
+      SmallVector<coord_type, 10U> x, y;
+      Interpolation::intersect(x, y, x1, y1, z1, c1, x2, y2, z2, c2, lolimit, hilimit);
+      Interpolation::intersect(x, y, x2, y2, z2, c2, x3, y3, z3, c3, lolimit, hilimit);
+      Interpolation::intersect(x, y, x3, y3, z3, c3, x4, y4, z4, c4, lolimit, hilimit);
+      Interpolation::intersect(x, y, x4, y4, z4, c4, x1, y1, z1, c1, lolimit, hilimit);
+
+      if (inside(x, y, i, j))
+        return static_cast<std::uint8_t>(k + 1);
+    }
+
+    // Outside all band polygons, or exactly at a band boundary. The corners
+    // may be on both sides of the bands, hence the value at the point decides.
+
+    const double u = i - ci;
+    const double v = j - cj;
+    const auto z = static_cast<value_type>((1 - u) * (1 - v) * z1 + (1 - u) * v * z2 +
+                                           u * v * z3 + u * (1 - v) * z4);
+    return static_cast<std::uint8_t>(band(limits, z) + 1);
+  }
+
+ private:
+  // Band index for a value, -1 if the value is not in any band
+
+  static int band(const Limits& limits, value_type value)
+  {
+    const int nbands = static_cast<int>(limits.size()) - 1;
+    for (int k = 0; k < nbands; k++)
+      if (Interpolation::placement(value, limits[k], limits[k + 1]) == Interpolation::Inside)
+        return k;
+    return -1;
+  }
+
+  // Classify a point using linear interpolation inside a triangle
+
+  static std::uint8_t triangle(const Limits& limits,
+                               double x,
+                               double y,
+                               double x1,
+                               double y1,
+                               value_type z1,
+                               double x2,
+                               double y2,
+                               value_type z2,
+                               double x3,
+                               double y3,
+                               value_type z3)
+  {
+    const double det = (y2 - y3) * (x1 - x3) + (x3 - x2) * (y1 - y3);
+    const double w1 = ((y2 - y3) * (x - x3) + (x3 - x2) * (y - y3)) / det;
+    const double w2 = ((y3 - y1) * (x - x3) + (x1 - x3) * (y - y3)) / det;
+    const double w3 = 1 - w1 - w2;
+
+    // Outside the triangle when a corner is missing
+    const double eps = -1e-12;
+    if (w1 < eps || w2 < eps || w3 < eps)
+      return 0;
+
+    const value_type z = static_cast<value_type>(w1 * z1 + w2 * z2 + w3 * z3);
+    return static_cast<std::uint8_t>(band(limits, z) + 1);
+  }
+
+  // Crossing number point in polygon test
+
+  template <typename VectorType>
+  static bool inside(const VectorType& x, const VectorType& y, double px, double py)
+  {
+    const std::size_t n = x.size();
+    if (n < 3)
+      return false;
+
+    bool ret = false;
+    for (std::size_t k = 0, m = n - 1; k < n; m = k++)
+    {
+      if ((y[k] > py) != (y[m] > py) &&
+          px < (x[m] - x[k]) * (py - y[k]) / (y[m] - y[k]) + x[k])
+        ret = !ret;
+    }
+    return ret;
+  }
+};
+
+}  // namespace Tron
+
+// ======================================================================
@@ -59,8 +59,9 @@ class Ring
   }
 
   // Note: This is intentionally not thread safe. You're not
-  // supposed to share Rings between threads.
-  coord_type signedArea() const
+  // supposed to share Rings between threads. The area is accumulated in
+  // double precision so that float rings are classified reliably.
+  double signedArea() const
   {
     if (itsAreaOK)
       return itsArea;
@@ -68,12 +69,13 @@ class Ring
     if (itsData.size() < 2)
       return 0;
 
-    coord_type area = 0;
+    double area = 0;
     const_iterator next = itsData.begin();
     const_iterator prev = next;
     for (const_iterator end = itsData.end(); ++next != end;)
     {
-      area += (next->first - prev->first) * (prev->second + next->second);
+      area += (static_cast<double>(next->first) - prev->first) *
+              (static_cast<double>(prev->second) + next->second);
       prev = next;
     }
     itsArea = area / 2;
@@ -175,13 +177,21 @@ class Ring
     return atan2(y2 - y1, x2 - x1) * boost::math::double_constants::radian;
   }
 
+  // Replace the points, for example with a simplified version
+  template <typename Iterator>
+  void assign(Iterator first, Iterator last)
+  {
+    itsData.assign(first, last);
+    itsAreaOK = false;
+  }
+
   // For speed
   void swap(Ring& other) { std::swap(itsData, other.itsData); }
 
  private:
   storage_type itsData;
   // The user won't see these changing
-  mutable coord_type itsArea;
+  mutable double itsArea;
   mutable bool itsAreaOK = false;
 
 };  // class Ring
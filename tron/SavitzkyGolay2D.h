@@ -2,58 +2,651 @@
 /*!
  * \brief 2D Savitzky-Golay smoothing
  *
+ * The grid is first copied into a flat row major buffer. Pixels whose
+ * whole kernel fits in the grid are then smoothed with a branch free
+ * loop over the raw rows. Each output row is processed in column tiles,
+ * accumulating one tap at a time over the tile, so that the inner loop
+ * vectorizes and the kernel rows stay in cache. Only the border pixels
+ * go through the MirrorMatrix boundary conditions.
+ *
+ * The length and degree are dispatched once to a template instance,
+ * whose weights are computed at compile time from the constexpr
+ * coefficient tables. The kernels are symmetric in both directions,
+ * hence the interior loop adds the four mirrored taps together and
+ * multiplies only once per quadrant tap.
+ *
+ * The output rows can be split between threads. Each pixel is computed
+ * the same way regardless of the split, hence the results are identical
+ * to the serial ones. The grid must allow writing different pixels
+ * from different threads simultaneously.
+ *
+ * smooth_rolling avoids the copy of the full grid by keeping only the
+ * 2*length+1 original rows needed by the current output row in a ring
+ * buffer, which matters when many large fields are smoothed at the same
+ * time. The rows are then necessarily processed in order in one thread.
+ *
+ * smooth() keeps the original value whenever the window contains a NaN,
+ * leaving unsmoothed halos around missing data. smooth_normalized uses
+ * normalized convolution instead: only the valid taps are summed, and
+ * the result is divided by the sum of their weights. Missing values are
+ * defined by a Missing.h policy and stay missing.
  */
 // ======================================================================
 
 #pragma once
 
 #include "MirrorMatrix.h"
+#include "Missing.h"
+#include "Parallel.h"
 #include "SavitzkyGolay2DCoefficients.h"
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <limits>
 #include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 namespace Tron
 {
 namespace SavitzkyGolay2D
 {
+namespace Detail
+{
+// Number of columns processed at a time in the interior
+const std::size_t tile_width = 256;
+
+// Test the coefficients for symmetry in both directions
+constexpr bool is_symmetric(const int* coeffs, int n)
+{
+  for (int j = 0; j < n; j++)
+    for (int i = 0; i < n; i++)
+      if (coeffs[j * n + i] != coeffs[j * n + n - 1 - i] ||
+          coeffs[j * n + i] != coeffs[(n - 1 - j) * n + i])
+        return false;
+  return true;
+}
+
 // ----------------------------------------------------------------------
 /*!
- * \brief Smoothen a matrix using a mirror matrix for boundary conditions
+ * \brief Weights of a smoother, computed at compile time
  *
- * Length is limited to range 0..6, degree to 0...5
+ * The folded weights cover the upper left quadrant including the
+ * center row and column.
  */
 // ----------------------------------------------------------------------
 
-template <typename Grid>
-void smooth(Grid& input, std::size_t length, std::size_t degree)
+template <typename T, int Length, int Degree>
+struct Kernel
 {
-  if (length == 0 || degree == 0) return;
+  static constexpr int n = 2 * Length + 1;
+  static constexpr int m = Length + 1;
+  static constexpr const int* coeffs = SavitzkyGolay2DCoefficients::coeffs[Length - 1][Degree - 1];
+  static constexpr int denom = SavitzkyGolay2DCoefficients::denoms[Length - 1][Degree - 1];
+
+  static_assert(is_symmetric(coeffs, n), "Savitzky-Golay kernels must be symmetric");
+
+  std::array<T, n * n> full{};
+  std::array<T, m * m> folded{};
+
+  constexpr Kernel()
+  {
+    for (int k = 0; k < n * n; k++)
+      full[k] = static_cast<T>(static_cast<double>(coeffs[k]) / denom);
+    for (int j = 0; j < m; j++)
+      for (int i = 0; i < m; i++)
+        folded[j * m + i] = full[j * n + i];
+  }
+};
+
+// Read only view to the flat copy of the full grid
+template <typename T>
+class FlatView
+{
+ public:
+  typedef T value_type;
+  typedef long size_type;
+
+  FlatView(const std::vector<T>& theData, long theWidth, long theHeight)
+      : itsData(theData), itsWidth(theWidth), itsHeight(theHeight)
+  {
+  }
+  size_type width() const { return itsWidth; }
+  size_type height() const { return itsHeight; }
+  const value_type& operator()(long i, long j) const { return itsData[i + itsWidth * j]; }
+  const value_type* data(long i, long j) const { return &itsData[i + itsWidth * j]; }
+
+ private:
+  const std::vector<T>& itsData;
+  long itsWidth;
+  long itsHeight;
+};
+
+// Writable view to a flat buffer
+template <typename T>
+class FlatOutput
+{
+ public:
+  FlatOutput(std::vector<T>& theData, long theWidth) : itsData(theData), itsWidth(theWidth) {}
+  T& operator()(long i, long j) { return itsData[i + itsWidth * j]; }
+
+ private:
+  std::vector<T>& itsData;
+  long itsWidth;
+};
+
+// Read only view to the original rows kept in a ring buffer
+template <typename T>
+class RingView
+{
+ public:
+  typedef T value_type;
+  typedef long size_type;
+
+  RingView(long theRows, long theWidth, long theHeight)
+      : itsData(theRows * theWidth), itsRows(theRows), itsWidth(theWidth), itsHeight(theHeight)
+  {
+  }
+  size_type width() const { return itsWidth; }
+  size_type height() const { return itsHeight; }
+  const value_type& operator()(long i, long j) const { return *data(i, j); }
+  const value_type* data(long i, long j) const { return &itsData[i + itsWidth * (j % itsRows)]; }
+
+  // Store the original row j, replacing row j - rows
+  template <typename Grid>
+  void load(const Grid& theGrid, long j)
+  {
+    value_type* out = &itsData[itsWidth * (j % itsRows)];
+    for (long i = 0; i < itsWidth; ++i)
+      out[i] = theGrid(i, j);
+  }
+
+ private:
+  std::vector<T> itsData;
+  long itsRows;
+  long itsWidth;
+  long itsHeight;
+};
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Smoothen the pixels in x1...x2-1, y1...y2-1 whose kernel fits in the grid
+ */
+// ----------------------------------------------------------------------
+
+template <int Length, int Degree, typename Grid, typename View>
+void smooth_interior(Grid& output, const View& input, long x1, long y1, long x2, long y2)
+{
+  typedef typename View::value_type T;
+  constexpr Kernel<T, Length, Degree> kernel;
+  constexpr int n = kernel.n;
+  constexpr int m = kernel.m;
+
+  const long width = input.width();
+  const long height = input.height();
+
+  T sums[tile_width];
+
+  const long imin = std::max<long>(x1, Length);
+  const long imax = std::min<long>(x2, width - Length);
+
+  for (long jj = std::max<long>(y1, Length); jj < std::min<long>(y2, height - Length); ++jj)
+    for (long i1 = imin; i1 < imax; i1 += tile_width)
+    {
+      const long count = std::min<long>(tile_width, imax - i1);
+      std::fill(sums, sums + count, T(0));
+
+      for (int j = 0; j < m; j++)
+      {
+        const T* top = input.data(i1 - Length, jj + j - Length);
+        const T* bottom = input.data(i1 - Length, jj + Length - j);
+        for (int i = 0; i < m; i++)
+        {
+          const T w = kernel.folded[j * m + i];
+          const T* a = top + i;
+          const T* b = top + n - 1 - i;
+          const T* c = bottom + i;
+          const T* d = bottom + n - 1 - i;
+
+          // The center row and column are not mirrored
+          if (j < Length && i < Length)
+            for (long t = 0; t < count; t++)
+              sums[t] += w * ((a[t] + b[t]) + (c[t] + d[t]));
+          else if (j < Length)
+            for (long t = 0; t < count; t++)
+              sums[t] += w * (a[t] + c[t]);
+          else if (i < Length)
+            for (long t = 0; t < count; t++)
+              sums[t] += w * (a[t] + b[t]);
+          else
+            for (long t = 0; t < count; t++)
+              sums[t] += w * a[t];
+        }
+      }
+
+      for (long t = 0; t < count; t++)
+        if (!std::isnan(sums[t]))
+          output(i1 + t, jj) = sums[t];
+    }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Smoothen the pixels in x1...x2-1, y1...y2-1 near the borders
+ *
+ * Everything is processed here if the grid is smaller than the kernel.
+ */
+// ----------------------------------------------------------------------
+
+template <int Length, int Degree, typename Grid, typename View>
+void smooth_border(Grid& output, const View& input, long x1, long y1, long x2, long y2)
+{
+  typedef typename View::value_type T;
+  constexpr Kernel<T, Length, Degree> kernel;
+  constexpr int n = kernel.n;
+
+  const long width = input.width();
+  const long height = input.height();
+
+  MirrorMatrix<View> mirror(input);
+
+  auto smooth_pixel = [&](long ii, long jj)
+  {
+    T sum = 0;
+    int k = 0;
+    for (int j = 0; j < n; j++)
+      for (int i = 0; i < n; i++)
+        sum += kernel.full[k++] * mirror(ii + i - Length, jj + j - Length);
+    if (!std::isnan(sum)) output(ii, jj) = sum;
+  };
+
+  const bool interior = (width > 2 * Length && height > 2 * Length);
+
+  for (long jj = y1; jj < y2; ++jj)
+  {
+    if (interior && jj >= Length && jj < height - Length)
+    {
+      // Only the left and right edges of the row
+      for (long ii = x1; ii < std::min<long>(x2, Length); ++ii)
+        smooth_pixel(ii, jj);
+      for (long ii = std::max<long>(x1, width - Length); ii < x2; ++ii)
+        smooth_pixel(ii, jj);
+    }
+    else
+    {
+      for (long ii = x1; ii < x2; ++ii)
+        smooth_pixel(ii, jj);
+    }
+  }
+}
+
+// Smaller weight sums of the valid taps leave the pixel unchanged
+const double normalized_min_weight = 0.5;
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Mirrored value as in MirrorMatrix, false if any source is missing
+ *
+ * The mask holds 1 for valid values and 0 for missing ones.
+ */
+// ----------------------------------------------------------------------
+
+template <typename T>
+bool mirror_value(const std::vector<T>& values,
+                  const std::vector<T>& mask,
+                  long width,
+                  long height,
+                  long i,
+                  long j,
+                  T& value)
+{
+  // Mirror in i on row jj of the grid
+  auto column = [&](long jj, T& result)
+  {
+    const long row = width * jj;
+    if (i < 0)
+    {
+      if (mask[row] == 0 || mask[row - i] == 0) return false;
+      result = 2 * values[row] - values[row - i];
+    }
+    else if (i >= width)
+    {
+      const long mirrored = row + 2 * width - i - 2;
+      if (mask[row + width - 1] == 0 || mask[mirrored] == 0) return false;
+      result = 2 * values[row + width - 1] - values[mirrored];
+    }
+    else
+    {
+      if (mask[row + i] == 0) return false;
+      result = values[row + i];
+    }
+    return true;
+  };
+
+  if (j >= 0 && j < height) return column(j, value);
+
+  T edge, mirrored;
+  if (j < 0)
+  {
+    if (!column(0, edge) || !column(-j, mirrored)) return false;
+  }
+  else
+  {
+    if (!column(height - 1, edge) || !column(2 * height - j - 2, mirrored)) return false;
+  }
+  value = 2 * edge - mirrored;
+  return true;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Weighted sums of the valid taps for border pixels of rows j1...j2-1
+ */
+// ----------------------------------------------------------------------
+
+template <int Length, int Degree, typename T>
+void weigh_border(std::vector<T>& sums,
+                  std::vector<T>& weights,
+                  const std::vector<T>& values,
+                  const std::vector<T>& mask,
+                  long width,
+                  long height,
+                  long j1,
+                  long j2)
+{
+  constexpr Kernel<T, Length, Degree> kernel;
+  constexpr int n = kernel.n;
+
+  auto weigh_pixel = [&](long ii, long jj)
+  {
+    T sum = 0;
+    T weight = 0;
+    int k = 0;
+    for (int j = 0; j < n; j++)
+      for (int i = 0; i < n; i++, k++)
+      {
+        T value;
+        if (mirror_value(values, mask, width, height, ii + i - Length, jj + j - Length, value))
+        {
+          sum += kernel.full[k] * value;
+          weight += kernel.full[k];
+        }
+      }
+    sums[ii + width * jj] = sum;
+    weights[ii + width * jj] = weight;
+  };
+
+  const bool interior = (width > 2 * Length && height > 2 * Length);
+
+  for (long jj = j1; jj < j2; ++jj)
+  {
+    if (interior && jj >= Length && jj < height - Length)
+    {
+      for (long ii = 0; ii < Length; ++ii)
+        weigh_pixel(ii, jj);
+      for (long ii = width - Length; ii < width; ++ii)
+        weigh_pixel(ii, jj);
+    }
+    else
+    {
+      for (long ii = 0; ii < width; ++ii)
+        weigh_pixel(ii, jj);
+    }
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Call f(Length,Degree) with compile time constants
+ *
+ * Nothing is called if there is no smoother for the combination.
+ */
+// ----------------------------------------------------------------------
+
+template <int Length, int Degree, typename Function>
+void dispatch_kernel(Function f)
+{
+  if constexpr (SavitzkyGolay2DCoefficients::coeffs[Length - 1][Degree - 1] != nullptr)
+    f(std::integral_constant<int, Length>(), std::integral_constant<int, Degree>());
+}
+
+template <int Length, typename Function>
+void dispatch_degree(std::size_t degree, Function f)
+{
+  switch (degree)
+  {
+    case 1:
+      return dispatch_kernel<Length, 1>(f);
+    case 2:
+      return dispatch_kernel<Length, 2>(f);
+    case 3:
+      return dispatch_kernel<Length, 3>(f);
+    case 4:
+      return dispatch_kernel<Length, 4>(f);
+    default:
+      return dispatch_kernel<Length, 5>(f);
+  }
+}
+
+template <typename Function>
+void dispatch(std::size_t length, std::size_t degree, Function f)
+{
+  switch (length)
+  {
+    case 1:
+      return dispatch_degree<1>(degree, f);
+    case 2:
+      return dispatch_degree<2>(degree, f);
+    case 3:
+      return dispatch_degree<3>(degree, f);
+    case 4:
+      return dispatch_degree<4>(degree, f);
+    case 5:
+      return dispatch_degree<5>(degree, f);
+    default:
+      return dispatch_degree<6>(degree, f);
+  }
+}
+
+// Clamp the length and degree, returns false if there is nothing to do
+inline bool normalize(std::size_t& length, std::size_t& degree)
+{
+  if (length == 0 || degree == 0) return false;
 
   if (length > 6) length = 6;
   if (degree > 5) degree = 5;
 
-  int* factor = SavitzkyGolay2DCoefficients::coeffs[length - 1][degree - 1];
-  if (factor == 0) return;
+  return (SavitzkyGolay2DCoefficients::coeffs[length - 1][degree - 1] != nullptr);
+}
+
+}  // namespace Detail
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Smoothen a matrix using a mirror matrix for boundary conditions
+ *
+ * Length is limited to range 0..6, degree to 0...5. The thread count
+ * is interpreted as in Parallel::for_rows, zero meaning one thread per
+ * hardware thread.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Grid>
+void smooth(Grid& input, std::size_t length, std::size_t degree, unsigned int threads = 1)
+{
+  if (!Detail::normalize(length, degree)) return;
 
   // Smoothen back to input from a copy of the original
 
-  auto grid = input;
-  MirrorMatrix<Grid> mirror(grid);
+  typedef typename Grid::value_type value_type;
 
-  int n = 2 * length + 1;
+  const long width = input.width();
+  const long height = input.height();
 
-  int denom = SavitzkyGolay2DCoefficients::denoms[length - 1][degree - 1];
+  std::vector<value_type> grid(width * height);
+  Parallel::for_rows(height,
+                     threads,
+                     [&](std::size_t j1, std::size_t j2)
+                     {
+                       for (std::size_t j = j1; j < j2; ++j)
+                         for (long i = 0; i < width; ++i)
+                           grid[i + width * j] = input(i, j);
+                     });
 
-  for (typename Grid::size_type jj = 0; jj < grid.height(); ++jj)
-    for (typename Grid::size_type ii = 0; ii < grid.width(); ++ii)
-    {
-      typename Grid::value_type sum = 0;
-      int k = 0;
-      for (int j = 0; j < n; j++)
-        for (int i = 0; i < n; i++)
-          sum += (factor[k++] * mirror(ii + i - length, jj + j - length));
-      if (!std::isnan(sum)) input(ii, jj) = sum / denom;
-    }
+  const Detail::FlatView<value_type> view(grid, width, height);
+
+  Detail::dispatch(length,
+                   degree,
+                   [&](auto l, auto d)
+                   {
+                     constexpr int L = decltype(l)::value;
+                     constexpr int D = decltype(d)::value;
+                     Parallel::for_rows(height,
+                                        threads,
+                                        [&](std::size_t j1, std::size_t j2)
+                                        {
+                                          Detail::smooth_interior<L, D>(
+                                              input, view, 0, j1, width, j2);
+                                          Detail::smooth_border<L, D>(
+                                              input, view, 0, j1, width, j2);
+                                        });
+                   });
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Smoothen a matrix in place using a rolling buffer of rows
+ *
+ * The results are identical to those of smooth(), but only 2*length+1
+ * rows of the original data are kept in memory at a time.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Grid>
+void smooth_rolling(Grid& input, std::size_t length, std::size_t degree)
+{
+  if (!Detail::normalize(length, degree)) return;
+
+  typedef typename Grid::value_type value_type;
+
+  const long width = input.width();
+  const long height = input.height();
+
+  // Output row j needs the original rows j-length...j+length, mirroring
+  // at the borders refers only to rows within the same range.
+
+  const long n = 2 * length + 1;
+  Detail::RingView<value_type> view(n, width, height);
+
+  long loaded = 0;
+  for (; loaded < std::min<long>(length, height); ++loaded)
+    view.load(input, loaded);
+
+  Detail::dispatch(length,
+                   degree,
+                   [&](auto l, auto d)
+                   {
+                     constexpr int L = decltype(l)::value;
+                     constexpr int D = decltype(d)::value;
+                     for (long j = 0; j < height; ++j)
+                     {
+                       if (loaded < height) view.load(input, loaded++);
+                       Detail::smooth_interior<L, D>(input, view, 0, j, width, j + 1);
+                       Detail::smooth_border<L, D>(input, view, 0, j, width, j + 1);
+                     }
+                   });
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Smoothen a matrix using only the valid values
+ *
+ * Each pixel becomes the weighted sum of the valid values in its window
+ * divided by the sum of their weights. The result equals smooth() up to
+ * rounding when there are no missing values nearby. Missing values stay
+ * missing, and pixels whose valid taps carry less than half of the
+ * kernel weight are left unchanged, since the remaining weights of the
+ * higher order kernels may be close to zero or even negative.
+ *
+ *   Tron::SavitzkyGolay2D::smooth_normalized(grid, 3, 2);
+ *   Tron::SavitzkyGolay2D::smooth_normalized<Tron::FmiMissing>(grid, 3, 2);
+ */
+// ----------------------------------------------------------------------
+
+template <template <typename> class Missing = NanMissing, typename Grid>
+void smooth_normalized(Grid& input,
+                       std::size_t length,
+                       std::size_t degree,
+                       unsigned int threads = 1)
+{
+  if (!Detail::normalize(length, degree)) return;
+
+  typedef typename Grid::value_type value_type;
+
+  const long width = input.width();
+  const long height = input.height();
+
+  // Missing values are replaced by zero and masked out. The interior
+  // sums are then plain convolutions of the values and the mask.
+
+  std::vector<value_type> values(width * height);
+  std::vector<value_type> mask(width * height);
+  Parallel::for_rows(height,
+                     threads,
+                     [&](std::size_t j1, std::size_t j2)
+                     {
+                       for (std::size_t j = j1; j < j2; ++j)
+                         for (long i = 0; i < width; ++i)
+                         {
+                           const value_type value = input(i, j);
+                           const bool missing = Missing<value_type>::missing(value);
+                           values[i + width * j] = (missing ? 0 : value);
+                           mask[i + width * j] = (missing ? 0 : 1);
+                         }
+                     });
+
+  // NaN values with a NotMissing policy leave NaN sums unwritten
+  std::vector<value_type> sums(width * height, std::numeric_limits<value_type>::quiet_NaN());
+  std::vector<value_type> weights(width * height, 0);
+
+  const Detail::FlatView<value_type> valueview(values, width, height);
+  const Detail::FlatView<value_type> maskview(mask, width, height);
+  Detail::FlatOutput<value_type> sumoutput(sums, width);
+  Detail::FlatOutput<value_type> weightoutput(weights, width);
+
+  Detail::dispatch(
+      length,
+      degree,
+      [&](auto l, auto d)
+      {
+        constexpr int L = decltype(l)::value;
+        constexpr int D = decltype(d)::value;
+        Parallel::for_rows(
+            height,
+            threads,
+            [&](std::size_t j1, std::size_t j2)
+            {
+              Detail::smooth_interior<L, D>(sumoutput, valueview, 0, j1, width, j2);
+              Detail::smooth_interior<L, D>(weightoutput, maskview, 0, j1, width, j2);
+              Detail::weigh_border<L, D>(sums, weights, values, mask, width, height, j1, j2);
+            });
+      });
+
+  Parallel::for_rows(height,
+                     threads,
+                     [&](std::size_t j1, std::size_t j2)
+                     {
+                       for (std::size_t j = j1; j < j2; ++j)
+                         for (long i = 0; i < width; ++i)
+                         {
+                           const long k = i + width * j;
+                           if (mask[k] == 0 || !(weights[k] >= Detail::normalized_min_weight))
+                             continue;
+                           const value_type value = sums[k] / weights[k];
+                           if (!std::isnan(value)) input(i, j) = value;
+                         }
+                     });
 }
+
 }  // namespace SavitzkyGolay2D
 }  // namespace Tron
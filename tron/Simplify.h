@@ -0,0 +1,829 @@
+// ======================================================================
+/*!
+ * \brief Douglas-Peucker simplification of rings and polylines
+ *
+ * Simplification is done while the rings are still in Ring form so
+ * that no second pass over GEOS geometries is needed. The rules are:
+ *
+ *  - Closed rings keep at least 3 distinct points (4 with the closing
+ *    point) and their orientation, and remain free of self
+ *    intersections. If the simplified ring would violate this the
+ *    tolerance is halved a few times before giving up and keeping the
+ *    original ring.
+ *  - Open polylines keep their end points.
+ *  - Anchor vertices are never removed. These are the vertices where
+ *    the ring joins or leaves a segment lying on the bounding box of
+ *    the edges, which for rectilinear grids is the grid boundary, and
+ *    the vertices where two rings of the same band touch.
+ *
+ * The chains between the anchors are simplified in a direction
+ * independent manner, hence the isoline shared by two adjacent bands
+ * is simplified identically in both as long as the chain endpoints
+ * are the same. Closed rings without anchors start from the
+ * lexicographically smallest vertex for the same reason.
+ *
+ * When a set of rings or polylines is simplified, the simplified ones
+ * intersecting any other member of the set or moving another member
+ * to their other side are restored, hence shells and holes remain
+ * valid. The simplification is done per band: the isoline shared by
+ * two adjacent bands is simplified separately in each, and the bands
+ * may still have gaps or overlaps between them if their anchors
+ * differ. Use MultiBandBuilder to simplify the shared boundaries only
+ * once.
+ */
+// ======================================================================
+
+#pragma once
+
+#include "Ring.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace Tron
+{
+template <typename Traits>
+class Simplifier
+{
+ public:
+  using coord_type = typename Traits::coord_type;
+  using Point = typename Ring<Traits>::value_type;
+  using Points = std::vector<Point>;
+
+  // Without edges only the end points of polylines are anchored
+  explicit Simplifier(double theTolerance) : itsTolerance(theTolerance) {}
+
+  template <typename Edges>
+  Simplifier(const Edges &theEdges, double theTolerance);
+
+  bool simplify(Ring<Traits> &theRing) const;
+
+  // Simplified points of a ring or a polyline, returns false if nothing was removed
+  bool simplify(const Ring<Traits> &theRing, Points &theResult) const;
+
+  // Simplify all rings and polylines, returns the number of modified ones
+  template <typename Polylines>
+  std::size_t simplify(Polylines &thePolylines) const;
+
+  static bool is_simple(const Points &thePoints, bool closed);
+
+ private:
+  bool is_anchor(const Point &prev, const Point &point, const Point &next) const;
+  bool on_box_side(const Point &p1, const Point &p2) const;
+
+  void reduce(const Points &thePoints,
+              const std::vector<std::size_t> &theAnchors,
+              double theTolerance,
+              std::vector<char> &theKeep) const;
+
+  double itsTolerance;
+  coord_type itsXmin = std::numeric_limits<coord_type>::max();
+  coord_type itsYmin = std::numeric_limits<coord_type>::max();
+  coord_type itsXmax = std::numeric_limits<coord_type>::lowest();
+  coord_type itsYmax = std::numeric_limits<coord_type>::lowest();
+
+  // Vertices where more than one edge starts, sorted
+  Points itsJunctions;
+
+};  // class Simplifier
+
+namespace SimplifyDetail
+{
+// Squared distance of a point from a segment. The segment is oriented
+// canonically so that the result does not depend on its direction.
+
+template <typename Point>
+double distance2(const Point &p, Point a, Point b)
+{
+  if (b < a)
+    std::swap(a, b);
+  const double dx = static_cast<double>(b.first) - a.first;
+  const double dy = static_cast<double>(b.second) - a.second;
+  const double px = static_cast<double>(p.first) - a.first;
+  const double py = static_cast<double>(p.second) - a.second;
+  const double len2 = dx * dx + dy * dy;
+  if (len2 == 0)
+    return px * px + py * py;
+  const double t = std::max(0.0, std::min(1.0, (px * dx + py * dy) / len2));
+  const double ex = px - t * dx;
+  const double ey = py - t * dy;
+  return ex * ex + ey * ey;
+}
+
+template <typename Point>
+int orientation(const Point &a, const Point &b, const Point &c)
+{
+  const double cross =
+      (static_cast<double>(b.first) - a.first) * (static_cast<double>(c.second) - a.second) -
+      (static_cast<double>(b.second) - a.second) * (static_cast<double>(c.first) - a.first);
+  return (cross > 0) - (cross < 0);
+}
+
+// Dot product of the vectors a-b and a-c
+template <typename Point>
+double dot(const Point &a, const Point &b, const Point &c)
+{
+  return (static_cast<double>(b.first) - a.first) * (static_cast<double>(c.first) - a.first) +
+         (static_cast<double>(b.second) - a.second) * (static_cast<double>(c.second) - a.second);
+}
+
+// Is c on segment a-b given that the three are collinear
+template <typename Point>
+bool on_segment(const Point &a, const Point &b, const Point &c)
+{
+  return (c.first >= std::min(a.first, b.first) && c.first <= std::max(a.first, b.first) &&
+          c.second >= std::min(a.second, b.second) && c.second <= std::max(a.second, b.second));
+}
+
+template <typename Point>
+bool intersects(const Point &p1, const Point &p2, const Point &p3, const Point &p4)
+{
+  const int o1 = orientation(p1, p2, p3);
+  const int o2 = orientation(p1, p2, p4);
+  const int o3 = orientation(p3, p4, p1);
+  const int o4 = orientation(p3, p4, p2);
+
+  if (o1 != o2 && o3 != o4)
+    return true;
+  return ((o1 == 0 && on_segment(p1, p2, p3)) || (o2 == 0 && on_segment(p1, p2, p4)) ||
+          (o3 == 0 && on_segment(p3, p4, p1)) || (o4 == 0 && on_segment(p3, p4, p2)));
+}
+
+// A segment of a polyline for finding intersections between polylines
+template <typename Point>
+struct Segment
+{
+  Point p1;
+  Point p2;
+  std::size_t line;
+};
+
+// Mark the lines with segments intersecting segments of other lines. Only pairs
+// involving a candidate line are tested. Segments of different lines may share
+// an end point, but may not overlap even then. The segments are sorted by their
+// minimum x coordinate, and each pair with overlapping x-ranges is found from the
+// segment which comes first: candidate segments are compared with all the segments
+// following them, other segments only with the candidate segments following them.
+
+template <typename Point>
+std::vector<char> crossings(std::vector<Segment<Point>> &theSegments,
+                            const std::vector<char> &theCandidates)
+{
+  auto xmin = [](const Segment<Point> &s) { return std::min(s.p1.first, s.p2.first); };
+  auto xmax = [](const Segment<Point> &s) { return std::max(s.p1.first, s.p2.first); };
+
+  std::sort(theSegments.begin(),
+            theSegments.end(),
+            [&](const Segment<Point> &a, const Segment<Point> &b) { return xmin(a) < xmin(b); });
+
+  std::vector<std::size_t> candidates;
+  for (std::size_t i = 0; i < theSegments.size(); i++)
+    if (theCandidates[theSegments[i].line])
+      candidates.push_back(i);
+
+  std::vector<char> crossing(theCandidates.size(), 0);
+
+  auto check = [&crossing](const Segment<Point> &s1, const Segment<Point> &s2)
+  {
+    if (s1.line == s2.line)
+      return;
+
+    const Point &p1 = s1.p1;
+    const Point &p2 = s1.p2;
+    const Point &p3 = s2.p1;
+    const Point &p4 = s2.p2;
+
+    bool intersects = false;
+    const int shared = (p1 == p3 || p1 == p4) + (p2 == p3 || p2 == p4);
+    if (shared == 0)
+      intersects = SimplifyDetail::intersects(p1, p2, p3, p4);
+    else if (shared == 1)
+    {
+      // Segments sharing a vertex overlap only if they leave it in the same direction
+      const Point &vertex = (p1 == p3 || p1 == p4 ? p1 : p2);
+      const Point &u = (p1 == vertex ? p2 : p1);
+      const Point &v = (p3 == vertex ? p4 : p3);
+      intersects = (orientation(vertex, u, v) == 0 && dot(vertex, u, v) > 0);
+    }
+    else
+      intersects = true;
+
+    if (intersects)
+    {
+      crossing[s1.line] = 1;
+      crossing[s2.line] = 1;
+    }
+  };
+
+  std::size_t next = 0;  // first candidate after the current segment
+  for (std::size_t a = 0; a < theSegments.size(); a++)
+  {
+    const Segment<Point> &s1 = theSegments[a];
+    const auto limit = xmax(s1);
+    while (next < candidates.size() && candidates[next] <= a)
+      ++next;
+
+    if (theCandidates[s1.line])
+    {
+      for (std::size_t b = a + 1; b < theSegments.size() && xmin(theSegments[b]) <= limit; b++)
+        check(s1, theSegments[b]);
+    }
+    else
+    {
+      for (std::size_t c = next; c < candidates.size() && xmin(theSegments[candidates[c]]) <= limit;
+           c++)
+        check(s1, theSegments[candidates[c]]);
+    }
+  }
+
+  return crossing;
+}
+
+// The region between a removed chain of original segments and the segment replacing it
+
+template <typename Point>
+struct Region
+{
+  std::vector<std::pair<Point, Point>> segments;
+  Point min;  // bounding box corners
+  Point max;
+};
+
+// Regions between a closed ring and its simplified version, whose points must be a
+// subsequence of the original ones. A point is on different sides of the rings if
+// and only if it is inside an odd number of the regions. Returns false if the points
+// cannot be matched, for example when the ring visits the starting vertex twice.
+
+template <typename Point>
+bool regions(const std::vector<Point> &theOriginal,
+             const std::vector<Point> &theSimplified,
+             std::vector<Region<Point>> &theRegions)
+{
+  theRegions.clear();
+  if (theOriginal.size() < 2 || theSimplified.size() < 2)
+    return false;
+
+  const std::size_t n = theOriginal.size() - 1;
+  const std::size_t m = theSimplified.size() - 1;
+  auto original = [&](std::size_t k) -> const Point & { return theOriginal[k % n]; };
+
+  const std::size_t start =
+      std::find(theOriginal.begin(), theOriginal.end() - 1, theSimplified[0]) - theOriginal.begin();
+  if (start == n)
+    return false;
+
+  std::size_t pos = 0;
+  for (std::size_t k = 0; k < m; k++)
+  {
+    const std::size_t from = pos++;
+    while (pos <= n && original(start + pos) != theSimplified[k + 1])
+      ++pos;
+    if (pos > n)
+      return false;
+    if (pos - from == 1)
+      continue;
+
+    Region<Point> region;
+    region.segments.emplace_back(theSimplified[k + 1], theSimplified[k]);
+    region.min = region.max = theSimplified[k];
+    for (std::size_t t = from; t < pos; t++)
+    {
+      const Point &p = original(start + t + 1);
+      region.segments.emplace_back(original(start + t), p);
+      region.min.first = std::min(region.min.first, p.first);
+      region.min.second = std::min(region.min.second, p.second);
+      region.max.first = std::max(region.max.first, p.first);
+      region.max.second = std::max(region.max.second, p.second);
+    }
+    theRegions.push_back(std::move(region));
+  }
+  return (pos == n);
+}
+
+// Parity of the ray crossings of the segments, -1 if the point is on a segment
+
+template <typename Point>
+int parity(const std::vector<std::pair<Point, Point>> &theSegments, const Point &p)
+{
+  int ret = 0;
+  for (const auto &segment : theSegments)
+  {
+    const Point &a = segment.first;
+    const Point &b = segment.second;
+    if (orientation(a, b, p) == 0 && on_segment(a, b, p))
+      return -1;
+    if ((a.second > p.second) != (b.second > p.second))
+    {
+      const double x = a.first + (static_cast<double>(p.second) - a.second) *
+                                     (static_cast<double>(b.first) - a.first) /
+                                     (static_cast<double>(b.second) - a.second);
+      if (p.first < x)
+        ret ^= 1;
+    }
+  }
+  return ret;
+}
+
+// Mark the simplified closed rings which moved any other ring or polyline to their
+// other side. Only candidate rings are tested. The rings may not intersect each
+// other, hence a single vertex of the other ring not on the region boundaries
+// decides, and only the rings with their first vertex inside the bounding box of
+// some region can be affected. Rings which cannot be matched with their originals
+// are marked too.
+
+template <typename Rings, typename Originals>
+std::vector<char> moved(const Rings &theRings,
+                        const Originals &theOriginals,
+                        const std::vector<char> &theCandidates)
+{
+  using Point = typename Rings::value_type::value_type;
+
+  std::vector<std::pair<Point, std::size_t>> firsts;
+  for (std::size_t j = 0; j < theRings.size(); j++)
+    if (!theRings[j].empty())
+      firsts.emplace_back(*theRings[j].begin(), j);
+  std::sort(firsts.begin(), firsts.end());
+
+  std::vector<char> ret(theRings.size(), 0);
+  std::vector<Region<Point>> areas;
+
+  auto inside = [](const Region<Point> &region, const Point &p)
+  {
+    return (p.first >= region.min.first && p.first <= region.max.first &&
+            p.second >= region.min.second && p.second <= region.max.second);
+  };
+
+  // Parity with respect to all the regions, -1 if on the boundary of any of them
+  auto side = [&](const Point &p)
+  {
+    int sum = 0;
+    for (const auto &region : areas)
+      if (inside(region, p))
+      {
+        const int value = parity(region.segments, p);
+        if (value < 0)
+          return -1;
+        sum ^= value;
+      }
+    return sum;
+  };
+
+  for (std::size_t i = 0; i < theRings.size(); i++)
+  {
+    const std::vector<Point> original(theOriginals[i].begin(), theOriginals[i].end());
+    if (!theCandidates[i] || original.size() < 4 || original.front() != original.back())
+      continue;
+
+    const std::vector<Point> simplified(theRings[i].begin(), theRings[i].end());
+    if (!regions(original, simplified, areas))
+    {
+      ret[i] = 1;
+      continue;
+    }
+
+    for (std::size_t r = 0; r < areas.size() && !ret[i]; r++)
+    {
+      const auto &region = areas[r];
+      auto pos = std::lower_bound(firsts.begin(),
+                                  firsts.end(),
+                                  std::make_pair(region.min, std::size_t(0)));
+      for (; pos != firsts.end() && pos->first.first <= region.max.first && !ret[i]; ++pos)
+      {
+        const std::size_t j = pos->second;
+        if (j == i || !inside(region, pos->first))
+          continue;
+        for (const auto &vertex : theRings[j])
+        {
+          const int value = side(vertex);
+          if (value >= 0)
+          {
+            ret[i] = static_cast<char>(value);
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  return ret;
+}
+
+template <typename Points>
+double signed_area(const Points &points)
+{
+  double area = 0;
+  for (std::size_t i = 1; i < points.size(); i++)
+    area += (static_cast<double>(points[i].first) - points[i - 1].first) *
+            (static_cast<double>(points[i - 1].second) + points[i].second);
+  return area / 2;
+}
+
+}  // namespace SimplifyDetail
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Constructor
+ *
+ * The edges are those the rings were built from, they are used for
+ * finding the anchor vertices.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+template <typename Edges>
+Simplifier<Traits>::Simplifier(const Edges &theEdges, double theTolerance)
+    : itsTolerance(theTolerance)
+{
+  const std::size_t n = theEdges.size();
+  for (std::size_t i = 0; i < n; i++)
+  {
+    const auto &edge = theEdges[i];
+    itsXmin = std::min({itsXmin, edge.x1(), edge.x2()});
+    itsXmax = std::max({itsXmax, edge.x1(), edge.x2()});
+    itsYmin = std::min({itsYmin, edge.y1(), edge.y2()});
+    itsYmax = std::max({itsYmax, edge.y1(), edge.y2()});
+
+    // The edges are sorted lexicographically, hence edges with the same start are consecutive
+    if (i + 1 < n && edge.x1() == theEdges[i + 1].x1() && edge.y1() == theEdges[i + 1].y1())
+    {
+      Point point(edge.x1(), edge.y1());
+      if (itsJunctions.empty() || itsJunctions.back() != point)
+        itsJunctions.push_back(point);
+    }
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test whether the segment lies on a side of the bounding box
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+bool Simplifier<Traits>::on_box_side(const Point &p1, const Point &p2) const
+{
+  return ((p1.first == p2.first && (p1.first == itsXmin || p1.first == itsXmax)) ||
+          (p1.second == p2.second && (p1.second == itsYmin || p1.second == itsYmax)));
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test whether a vertex must be kept
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+bool Simplifier<Traits>::is_anchor(const Point &prev, const Point &point, const Point &next) const
+{
+  if (on_box_side(prev, point) || on_box_side(point, next))
+    return true;
+  return std::binary_search(itsJunctions.begin(), itsJunctions.end(), point);
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Douglas-Peucker between consecutive anchors
+ *
+ * Ties in the distances are resolved by the coordinates instead of the
+ * positions so that the result does not depend on the direction.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+void Simplifier<Traits>::reduce(const Points &thePoints,
+                                const std::vector<std::size_t> &theAnchors,
+                                double theTolerance,
+                                std::vector<char> &theKeep) const
+{
+  const double tolerance2 = theTolerance * theTolerance;
+  const std::size_t none = std::numeric_limits<std::size_t>::max();
+
+  theKeep.assign(thePoints.size(), 0);
+  for (auto anchor : theAnchors)
+    theKeep[anchor] = 1;
+
+  std::vector<std::pair<std::size_t, std::size_t>> stack;
+
+  for (std::size_t a = 0; a + 1 < theAnchors.size(); a++)
+  {
+    stack.emplace_back(theAnchors[a], theAnchors[a + 1]);
+    while (!stack.empty())
+    {
+      const auto first = stack.back().first;
+      const auto last = stack.back().second;
+      stack.pop_back();
+
+      std::size_t best = none;
+      double bestdist = tolerance2;
+      for (std::size_t k = first + 1; k < last; k++)
+      {
+        const double dist =
+            SimplifyDetail::distance2(thePoints[k], thePoints[first], thePoints[last]);
+        if (dist > tolerance2 && (best == none || dist > bestdist ||
+                                  (dist == bestdist && thePoints[k] < thePoints[best])))
+        {
+          best = k;
+          bestdist = dist;
+        }
+      }
+
+      if (best != none)
+      {
+        theKeep[best] = 1;
+        stack.emplace_back(first, best);
+        stack.emplace_back(best, last);
+      }
+    }
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Simplify a ring or a polyline, returns true if it was modified
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+bool Simplifier<Traits>::simplify(Ring<Traits> &theRing) const
+{
+  Points result;
+  if (!simplify(theRing, result))
+    return false;
+  theRing.assign(result.begin(), result.end());
+  return true;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Simplified points of a ring or a polyline
+ *
+ * Returns false and leaves the result unspecified if the ring cannot
+ * be simplified.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+bool Simplifier<Traits>::simplify(const Ring<Traits> &theRing, Points &theResult) const
+{
+  if (itsTolerance <= 0)
+    return false;
+
+  const bool closed = theRing.closed();
+
+  Points points(theRing.begin(), theRing.end());
+  if (closed)
+    points.pop_back();
+
+  const std::size_t n = points.size();
+
+  // Nothing can be removed from triangles or single segments
+  if (n < (closed ? 4U : 3U))
+    return false;
+
+  // Select the anchors and the start position for closed rings
+
+  std::vector<std::size_t> anchors;
+  std::size_t start = 0;
+
+  if (!closed)
+  {
+    anchors.push_back(0);
+    for (std::size_t i = 1; i + 1 < n; i++)
+      if (is_anchor(points[i - 1], points[i], points[i + 1]))
+        anchors.push_back(i);
+    anchors.push_back(n - 1);
+  }
+  else
+  {
+    for (std::size_t i = 0; i < n; i++)
+      if (is_anchor(points[(i + n - 1) % n], points[i], points[(i + 1) % n]))
+        anchors.push_back(i);
+
+    if (anchors.empty())
+      anchors.push_back(std::min_element(points.begin(), points.end()) - points.begin());
+
+    // A single anchor is not enough to split the ring into chains
+    if (anchors.size() == 1)
+    {
+      const Point &origin = points[anchors[0]];
+      std::size_t far = anchors[0];
+      double fardist = -1;
+      for (std::size_t i = 0; i < n; i++)
+      {
+        const double dx = static_cast<double>(points[i].first) - origin.first;
+        const double dy = static_cast<double>(points[i].second) - origin.second;
+        const double dist = dx * dx + dy * dy;
+        if (dist > fardist || (dist == fardist && points[i] < points[far]))
+        {
+          far = i;
+          fardist = dist;
+        }
+      }
+      anchors.push_back(far);
+      std::sort(anchors.begin(), anchors.end());
+    }
+
+    // Rotate so that the first anchor is first, and close the sequence
+
+    start = anchors[0];
+    std::rotate(points.begin(), points.begin() + start, points.end());
+    points.push_back(points.front());
+    for (auto &anchor : anchors)
+      anchor -= start;
+    anchors.push_back(n);
+  }
+
+  std::vector<char> keep;
+  Points &result = theResult;
+
+  double tolerance = itsTolerance;
+  for (int attempt = 0; attempt < 4; attempt++, tolerance /= 2)
+  {
+    reduce(points, anchors, tolerance, keep);
+
+    const auto count = std::count(keep.begin(), keep.end(), 1);
+    if (count == static_cast<long>(points.size()))
+      return false;
+
+    result.clear();
+    if (!closed)
+    {
+      for (std::size_t i = 0; i < n; i++)
+        if (keep[i])
+          result.push_back(points[i]);
+      if (is_simple(result, false))
+        return true;
+    }
+    else
+    {
+      // Distinct points, the closing point is marked too
+      if (count - 1 < 3)
+        continue;
+
+      // Restore the original starting point if it was kept
+      for (std::size_t k = 0; k < n; k++)
+      {
+        const std::size_t i = (k + n - start) % n;
+        if (keep[i])
+          result.push_back(points[i]);
+      }
+      result.push_back(result.front());
+
+      const double area = SimplifyDetail::signed_area(result);
+      const bool cw = theRing.isClockWise();
+      if (area != 0 && (area > 0) == cw && is_simple(result, true))
+        return true;
+    }
+  }
+
+  return false;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Simplify all rings and polylines, returns the number of modified ones
+ *
+ * Simplified rings and polylines intersecting any other member of the
+ * set are restored until no intersections remain. Simplified rings
+ * which moved another member of the set to their other side, for
+ * example a hole outside its shell, are restored too.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+template <typename Polylines>
+std::size_t Simplifier<Traits>::simplify(Polylines &thePolylines) const
+{
+  using Polyline = typename Polylines::value_type;
+
+  const std::size_t n = thePolylines.size();
+  std::vector<char> modified(n, 0);
+  std::vector<Polyline> originals(n);
+
+  Points result;
+  for (std::size_t i = 0; i < n; i++)
+  {
+    if (simplify(thePolylines[i], result))
+    {
+      modified[i] = 1;
+      originals[i] = std::move(thePolylines[i]);
+      thePolylines[i].assign(result.begin(), result.end());
+    }
+  }
+
+  // Restoring a line may expose intersections with other simplified lines
+
+  // Only the lines restored in the previous round need to be checked for intersections
+
+  std::vector<char> candidates = modified;
+  std::vector<SimplifyDetail::Segment<Point>> segments;
+  while (std::find(modified.begin(), modified.end(), 1) != modified.end())
+  {
+    segments.clear();
+    for (std::size_t i = 0; i < n; i++)
+    {
+      const auto &polyline = thePolylines[i];
+      if (polyline.empty())
+        continue;
+      for (auto it = polyline.begin(), next = std::next(it); next != polyline.end(); it = next++)
+        segments.push_back(SimplifyDetail::Segment<Point>{*it, *next, i});
+    }
+
+    auto restore = SimplifyDetail::crossings(segments, candidates);
+
+    // Without intersections the rings may only have moved over other rings
+
+    if (std::find(restore.begin(), restore.end(), 1) == restore.end())
+      restore = SimplifyDetail::moved(thePolylines, originals, modified);
+
+    bool restored = false;
+    std::fill(candidates.begin(), candidates.end(), 0);
+    for (std::size_t i = 0; i < n; i++)
+      if (restore[i] && modified[i])
+      {
+        thePolylines[i] = std::move(originals[i]);
+        modified[i] = 0;
+        candidates[i] = 1;
+        restored = true;
+      }
+
+    if (!restored)
+      break;
+  }
+
+  return std::count(modified.begin(), modified.end(), 1);
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test whether a polyline or a closed ring is free of self intersections
+ *
+ * The segments are sorted by their minimum x coordinate and only
+ * segments with overlapping x-ranges are compared.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+bool Simplifier<Traits>::is_simple(const Points &thePoints, bool closed)
+{
+  if (thePoints.size() < 3)
+    return true;
+
+  const std::size_t nsegments = thePoints.size() - 1;
+
+  std::vector<std::size_t> order(nsegments);
+  std::iota(order.begin(), order.end(), 0);
+
+  auto xmin = [&](std::size_t i)
+  { return std::min(thePoints[i].first, thePoints[i + 1].first); };
+  auto xmax = [&](std::size_t i)
+  { return std::max(thePoints[i].first, thePoints[i + 1].first); };
+
+  std::sort(
+      order.begin(), order.end(), [&](std::size_t i, std::size_t j) { return xmin(i) < xmin(j); });
+
+  for (std::size_t a = 0; a < nsegments; a++)
+  {
+    const std::size_t i = order[a];
+    const auto limit = xmax(i);
+
+    for (std::size_t b = a + 1; b < nsegments && xmin(order[b]) <= limit; b++)
+    {
+      const std::size_t j = order[b];
+      const std::size_t lo = std::min(i, j);
+      const std::size_t hi = std::max(i, j);
+
+      const Point &p1 = thePoints[i];
+      const Point &p2 = thePoints[i + 1];
+      const Point &p3 = thePoints[j];
+      const Point &p4 = thePoints[j + 1];
+
+      const bool adjacent = (hi == lo + 1 || (closed && lo == 0 && hi == nsegments - 1));
+
+      if (!adjacent)
+      {
+        if (SimplifyDetail::intersects(p1, p2, p3, p4))
+          return false;
+      }
+      else
+      {
+        // Adjacent segments share a vertex and may only overlap by doubling back
+        const Point &shared = (hi == lo + 1 ? thePoints[hi] : thePoints[0]);
+        const Point &u = (p1 == shared ? p2 : p1);
+        const Point &v = (p3 == shared ? p4 : p3);
+        if (SimplifyDetail::orientation(shared, u, v) == 0 && SimplifyDetail::dot(shared, u, v) > 0)
+          return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace Tron
+
+// ======================================================================
@@ -0,0 +1,231 @@
+// ======================================================================
+/*!
+ * \brief Grid adapter which smoothens the values on demand
+ *
+ * Smoothing the full grid before contouring is wasted work when only a
+ * small area is contoured, for example when rendering zoomed in map
+ * tiles. The adapter computes the Savitzky-Golay smoothed values one
+ * tile at a time when they are first needed, and keeps the most
+ * recently used tiles in a small cache:
+ *
+ *   Tron::SmoothedGridView<MyGrid> smoothed(grid, length, degree);
+ *   MyCoordinateHints hints(smoothed);
+ *   MyContourer::fill(builder, smoothed, lo, hi, hints, xmin, ymin, xmax, ymax);
+ *
+ * The values are identical to those produced by SavitzkyGolay2D::smooth.
+ * The coordinates and the cell validity are those of the original grid.
+ * Value based Hints must look at every value, and thus smooth the full
+ * grid, hence only CoordinateHints should be used to select the area.
+ *
+ * The cache is updated from const accessors, the adapter must not be
+ * shared by several threads.
+ */
+// ======================================================================
+
+#pragma once
+
+#include "SavitzkyGolay2D.h"
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace Tron
+{
+template <typename Grid>
+class SmoothedGridView
+{
+ public:
+  typedef typename Grid::value_type value_type;
+  typedef typename Grid::size_type size_type;
+  typedef typename Grid::coord_type coord_type;
+
+  // Tiles are tile_size x tile_size pixels
+  static constexpr long tile_size = 64;
+
+  SmoothedGridView(const Grid& theGrid,
+                   std::size_t theLength,
+                   std::size_t theDegree,
+                   std::size_t theCacheSize = 256)
+      : itsGrid(theGrid),
+        itsWidth(theGrid.width()),
+        itsHeight(theGrid.height()),
+        itsLength(theLength),
+        itsDegree(theDegree),
+        itsCacheSize(std::max<std::size_t>(1, theCacheSize)),
+        itsTilesX((itsWidth + tile_size - 1) / tile_size)
+  {
+    itsSmooth = SavitzkyGolay2D::Detail::normalize(itsLength, itsDegree);
+  }
+
+  SmoothedGridView(const SmoothedGridView& theOther) = delete;
+  SmoothedGridView& operator=(const SmoothedGridView& theOther) = delete;
+
+  size_type width() const { return itsWidth; }
+  size_type height() const { return itsHeight; }
+
+  value_type operator()(size_type i, size_type j) const
+  {
+    const long ti = i / tile_size;
+    const long tj = j / tile_size;
+    const long key = ti + itsTilesX * tj;
+    if (key != itsLastKey)
+    {
+      itsLastTile = &tile(key, ti, tj);
+      itsLastKey = key;
+    }
+    return (*itsLastTile)[(i - ti * tile_size) + tile_size * (j - tj * tile_size)];
+  }
+
+  coord_type x(size_type i, size_type j) const { return itsGrid.x(i, j); }
+  coord_type y(size_type i, size_type j) const { return itsGrid.y(i, j); }
+  bool valid(size_type i, size_type j) const { return itsGrid.valid(i, j); }
+
+  // Number of tiles smoothed so far, including evicted ones
+  std::size_t computed_tiles() const { return itsComputedTiles; }
+
+ private:
+  SmoothedGridView();
+
+  typedef std::vector<value_type> Tile;
+  typedef std::list<std::pair<long, Tile> > TileList;
+
+  // Original values around a tile, addressed with grid coordinates
+  class Patch
+  {
+   public:
+    typedef typename Grid::value_type value_type;
+    typedef long size_type;
+
+    Patch(const Grid& theGrid, long theX1, long theY1, long theX2, long theY2)
+        : itsX1(theX1),
+          itsY1(theY1),
+          itsStride(theX2 - theX1),
+          itsWidth(theGrid.width()),
+          itsHeight(theGrid.height()),
+          itsData(itsStride * (theY2 - theY1))
+    {
+      value_type* out = itsData.data();
+      for (long j = theY1; j < theY2; ++j)
+        for (long i = theX1; i < theX2; ++i)
+          *out++ = theGrid(i, j);
+    }
+
+    size_type width() const { return itsWidth; }
+    size_type height() const { return itsHeight; }
+    const value_type& operator()(long i, long j) const { return *data(i, j); }
+    const value_type* data(long i, long j) const
+    {
+      return &itsData[(i - itsX1) + itsStride * (j - itsY1)];
+    }
+
+   private:
+    long itsX1;
+    long itsY1;
+    long itsStride;
+    long itsWidth;
+    long itsHeight;
+    std::vector<value_type> itsData;
+  };
+
+  // Output of the smoother, addressed with grid coordinates
+  class TileOutput
+  {
+   public:
+    TileOutput(Tile& theTile, long theX1, long theY1) : itsTile(theTile), itsX1(theX1), itsY1(theY1)
+    {
+    }
+
+    value_type& operator()(long i, long j)
+    {
+      return itsTile[(i - itsX1) + tile_size * (j - itsY1)];
+    }
+
+   private:
+    Tile& itsTile;
+    long itsX1;
+    long itsY1;
+  };
+
+  const Tile& tile(long theKey, long theTileX, long theTileY) const
+  {
+    auto pos = itsIndex.find(theKey);
+    if (pos != itsIndex.end())
+    {
+      // Move to the front of the LRU list
+      itsTiles.splice(itsTiles.begin(), itsTiles, pos->second);
+      return pos->second->second;
+    }
+
+    if (itsTiles.size() >= itsCacheSize)
+    {
+      itsIndex.erase(itsTiles.back().first);
+      itsTiles.pop_back();
+    }
+
+    itsTiles.emplace_front(theKey, compute(theTileX, theTileY));
+    itsIndex[theKey] = itsTiles.begin();
+    ++itsComputedTiles;
+    return itsTiles.front().second;
+  }
+
+  Tile compute(long theTileX, long theTileY) const
+  {
+    const long x1 = theTileX * tile_size;
+    const long y1 = theTileY * tile_size;
+    const long x2 = std::min<long>(x1 + tile_size, itsWidth);
+    const long y2 = std::min<long>(y1 + tile_size, itsHeight);
+
+    // The mirrored border values need no data beyond the kernel radius
+    const long length = (itsSmooth ? itsLength : 0);
+    const Patch patch(itsGrid,
+                      std::max<long>(0, x1 - length),
+                      std::max<long>(0, y1 - length),
+                      std::min<long>(itsWidth, x2 + length),
+                      std::min<long>(itsHeight, y2 + length));
+
+    // Pixels with a NaN sum keep the original value
+
+    Tile values(tile_size * tile_size);
+    TileOutput output(values, x1, y1);
+    for (long j = y1; j < y2; ++j)
+      for (long i = x1; i < x2; ++i)
+        output(i, j) = patch(i, j);
+
+    if (itsSmooth)
+    {
+      SavitzkyGolay2D::Detail::dispatch(
+          itsLength,
+          itsDegree,
+          [&](auto l, auto d)
+          {
+            constexpr int L = decltype(l)::value;
+            constexpr int D = decltype(d)::value;
+            SavitzkyGolay2D::Detail::smooth_interior<L, D>(output, patch, x1, y1, x2, y2);
+            SavitzkyGolay2D::Detail::smooth_border<L, D>(output, patch, x1, y1, x2, y2);
+          });
+    }
+
+    return values;
+  }
+
+  const Grid& itsGrid;
+  long itsWidth;
+  long itsHeight;
+  std::size_t itsLength;
+  std::size_t itsDegree;
+  bool itsSmooth = false;
+  std::size_t itsCacheSize;
+  long itsTilesX;
+
+  mutable TileList itsTiles;
+  mutable std::unordered_map<long, typename TileList::iterator> itsIndex;
+  mutable long itsLastKey = -1;
+  mutable const Tile* itsLastTile = nullptr;
+  mutable std::size_t itsComputedTiles = 0;
+
+};  // class SmoothedGridView
+
+}  // namespace Tron
+
+// ======================================================================
@@ -0,0 +1,159 @@
+// ======================================================================
+/*!
+ * \brief Optional per-stage timing and counters for contouring
+ *
+ * A Stats object may be passed to Contourer::fill and Contourer::line
+ * to find out where the time went: the cell pass, FlipGrid::copy,
+ * FlipSet::prepare, polygon stepping in the builder, assigning holes
+ * to shells, simplification, GEOS construction and normalization.
+ *
+ * Passing a null pointer (the default) disables the bookkeeping. The
+ * only remaining cost is a pointer test per stage, nothing is done
+ * per cell or per edge.
+ *
+ * The values are accumulated, so the same object may be used for all
+ * the contours calculated for a single request. Use clear() to reset.
+ */
+// ======================================================================
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace Tron
+{
+struct Stats
+{
+  enum Stage
+  {
+    CellPass,        // Contouring the grid cells
+    FlipGridCopy,    // FlipGrid::copy
+    FlipSetPrepare,  // FlipSet::prepare (mostly sorting)
+    BuildRings,      // Stepping through the edges to build rings and polylines
+    FindShell,       // Assigning holes to shells
+    Simplify,        // Simplifying the rings and polylines
+    GeosConversion,  // Creating the GEOS geometries or other output
+    Normalize,       // Normalizing the GEOS geometry
+    NumStages
+  };
+
+  using duration_type = std::chrono::nanoseconds;
+
+  std::array<duration_type, NumStages> durations{};
+
+  std::size_t cells = 0;    // valid grid cells processed
+  std::size_t flips = 0;    // edges flipped into the flipset
+  std::size_t edges = 0;    // final number of edges passed to the builder
+  std::size_t rings = 0;    // rings and polylines built
+  std::size_t shells = 0;   // exterior rings in the output
+  std::size_t holes = 0;    // holes assigned to shells
+  std::size_t dropped = 0;  // rings dropped as too small
+  std::size_t calls = 0;    // number of contouring calls
+
+  // Maximum flipset hash table load factor encountered
+  float load_factor = 0;
+
+  void clear() { *this = Stats(); }
+
+  duration_type total() const
+  {
+    duration_type sum{};
+    for (const auto& d : durations)
+      sum += d;
+    return sum;
+  }
+
+  static const char* name(Stage theStage)
+  {
+    switch (theStage)
+    {
+      case CellPass:
+        return "cellpass";
+      case FlipGridCopy:
+        return "flipgridcopy";
+      case FlipSetPrepare:
+        return "flipsetprepare";
+      case BuildRings:
+        return "buildrings";
+      case FindShell:
+        return "findshell";
+      case Simplify:
+        return "simplify";
+      case GeosConversion:
+        return "geos";
+      case Normalize:
+        return "normalize";
+      case NumStages:
+        break;
+    }
+    return "unknown";
+  }
+
+  // Single line key=value summary for request logs. Durations are in microseconds.
+
+  std::string asText() const
+  {
+    std::string out;
+    for (int i = 0; i < NumStages; i++)
+    {
+      out += name(static_cast<Stage>(i));
+      out += '=';
+      out += std::to_string(
+          std::chrono::duration_cast<std::chrono::microseconds>(durations[i]).count());
+      out += ' ';
+    }
+    out += "cells=" + std::to_string(cells);
+    out += " flips=" + std::to_string(flips);
+    out += " edges=" + std::to_string(edges);
+    out += " rings=" + std::to_string(rings);
+    out += " shells=" + std::to_string(shells);
+    out += " holes=" + std::to_string(holes);
+    out += " dropped=" + std::to_string(dropped);
+    out += " calls=" + std::to_string(calls);
+    out += " loadfactor=" + std::to_string(load_factor);
+    return out;
+  }
+};
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Scoped timer for a single stage, does nothing if stats is null
+ */
+// ----------------------------------------------------------------------
+
+class StageTimer
+{
+ public:
+  StageTimer(Stats* theStats, Stats::Stage theStage) : itsStats(theStats), itsStage(theStage)
+  {
+    if (itsStats)
+      itsStart = std::chrono::steady_clock::now();
+  }
+
+  ~StageTimer() { stop(); }
+
+  // Record the elapsed time now instead of at the end of the scope
+  void stop()
+  {
+    if (itsStats)
+      itsStats->durations[itsStage] += std::chrono::duration_cast<Stats::duration_type>(
+          std::chrono::steady_clock::now() - itsStart);
+    itsStats = nullptr;
+  }
+
+  StageTimer() = delete;
+  StageTimer(const StageTimer& other) = delete;
+  StageTimer& operator=(const StageTimer& other) = delete;
+
+ private:
+  Stats* itsStats;
+  Stats::Stage itsStage;
+  std::chrono::steady_clock::time_point itsStart;
+};
+
+}  // namespace Tron
+
+// ======================================================================
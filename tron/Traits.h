@@ -1,6 +1,13 @@
 // ======================================================================
 /*
  * Type traits for contouring
+ *
+ * Traits<float, float> is a supported configuration which halves the
+ * size of the edges and ring points compared to double coordinates.
+ * Edges are hashed and compared exactly using the float values, and
+ * geometric predicates such as ring orientation are evaluated in double
+ * precision. The coordinates are widened to double only when the
+ * builders produce their output.
  */
 // ======================================================================
 
@@ -0,0 +1,160 @@
+#include "WkbBuilder.h"
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace Tron
+{
+// ----------------------------------------------------------------------
+/*!
+ * \brief Constructor
+ *
+ * The precision is the number of decimals kept in TWKB output, it is
+ * not used for WKB.
+ */
+// ----------------------------------------------------------------------
+
+WkbBuilder::WkbBuilder(Format theFormat, int thePrecision)
+    : itsFormat(theFormat), itsPrecision(thePrecision), itsScale(std::pow(10.0, thePrecision))
+{
+  if (itsFormat == Format::TWKB && (thePrecision < -7 || thePrecision > 7))
+    throw std::runtime_error("TWKB precision must be in the range -7...7");
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Return the final result
+ */
+// ----------------------------------------------------------------------
+
+std::string WkbBuilder::result()
+{
+  return std::move(itsResult);
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Start the top level geometry
+ */
+// ----------------------------------------------------------------------
+
+void WkbBuilder::begin_geometry(GeometryType theType, bool theEmptyFlag)
+{
+  if (itsFormat == Format::WKB)
+  {
+    begin_part(theType);
+    return;
+  }
+
+  // Type and zigzag encoded precision, then the metadata flags
+  const auto precision = static_cast<std::uint8_t>(itsPrecision < 0 ? -2 * itsPrecision - 1
+                                                                    : 2 * itsPrecision);
+  put_byte(static_cast<std::uint8_t>(theType) | static_cast<std::uint8_t>(precision << 4));
+  put_byte(theEmptyFlag ? 0x10 : 0);
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Start a part of a multigeometry
+ *
+ * TWKB parts do not have a header.
+ */
+// ----------------------------------------------------------------------
+
+void WkbBuilder::begin_part(GeometryType theType)
+{
+  if (itsFormat == Format::WKB)
+  {
+    put_byte(1);  // NDR
+    put_uint32(theType);
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Write the number of parts, rings or points
+ */
+// ----------------------------------------------------------------------
+
+void WkbBuilder::put_count(std::size_t theCount)
+{
+  if (itsFormat == Format::WKB)
+    put_uint32(static_cast<std::uint32_t>(theCount));
+  else
+    put_varint(theCount);
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Write a coordinate
+ */
+// ----------------------------------------------------------------------
+
+void WkbBuilder::put_point(double theX, double theY)
+{
+  if (itsFormat == Format::WKB)
+  {
+    put_double(theX);
+    put_double(theY);
+    return;
+  }
+
+  const auto x = static_cast<std::int64_t>(std::llround(theX * itsScale));
+  const auto y = static_cast<std::int64_t>(std::llround(theY * itsScale));
+  const std::int64_t dx = x - itsLastX;
+  const std::int64_t dy = y - itsLastY;
+  itsLastX = x;
+  itsLastY = y;
+
+  // Zigzag encoding
+  put_varint((static_cast<std::uint64_t>(dx) << 1) ^ static_cast<std::uint64_t>(dx >> 63));
+  put_varint((static_cast<std::uint64_t>(dy) << 1) ^ static_cast<std::uint64_t>(dy >> 63));
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Low level output
+ */
+// ----------------------------------------------------------------------
+
+void WkbBuilder::put_byte(std::uint8_t theValue)
+{
+  itsResult.push_back(static_cast<char>(theValue));
+}
+
+void WkbBuilder::put_uint32(std::uint32_t theValue)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  itsResult.append(reinterpret_cast<const char *>(&theValue), sizeof(theValue));
+#else
+  for (int i = 0; i < 4; i++)
+    put_byte(static_cast<std::uint8_t>(theValue >> (8 * i)));
+#endif
+}
+
+void WkbBuilder::put_double(double theValue)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  itsResult.append(reinterpret_cast<const char *>(&theValue), sizeof(theValue));
+#else
+  std::uint64_t bits;
+  std::memcpy(&bits, &theValue, sizeof(bits));
+  for (int i = 0; i < 8; i++)
+    put_byte(static_cast<std::uint8_t>(bits >> (8 * i)));
+#endif
+}
+
+void WkbBuilder::put_varint(std::uint64_t theValue)
+{
+  char buffer[10];
+  std::size_t n = 0;
+  while (theValue >= 0x80)
+  {
+    buffer[n++] = static_cast<char>(theValue | 0x80);
+    theValue >>= 7;
+  }
+  buffer[n++] = static_cast<char>(theValue);
+  itsResult.append(buffer, n);
+}
+
+}  // namespace Tron
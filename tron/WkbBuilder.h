@@ -0,0 +1,231 @@
+// ======================================================================
+/*!
+ * \brief Builder producing WKB or TWKB directly from the rings
+ *
+ * Serializing the result of FmiBuilder allocates a GEOS geometry which
+ * is discarded immediately. This builder writes the rings built by
+ * RingBuilder.h straight into a byte buffer instead.
+ *
+ * The output is the same geometry FmiBuilder would produce, but it is
+ * not normalized: shells are clockwise and holes counter-clockwise as
+ * produced by the contourer, but the start points of the rings and
+ * the order of the polygons may differ.
+ *
+ * WKB is always written in little endian (NDR) byte order. TWKB
+ * coordinates are rounded to the given number of decimals.
+ *
+ * Empty results are written as an empty GEOMETRYCOLLECTION.
+ */
+// ======================================================================
+
+#pragma once
+
+#include "RingBuilder.h"
+#include "Stats.h"
+#include <boost/utility.hpp>
+#include <cstdint>
+#include <string>
+
+namespace Tron
+{
+class WkbBuilder : private boost::noncopyable
+{
+ public:
+  enum class Format
+  {
+    WKB,
+    TWKB
+  };
+
+  ~WkbBuilder() = default;
+  WkbBuilder(const WkbBuilder &other) = delete;
+  WkbBuilder &operator=(const WkbBuilder &other) = delete;
+  WkbBuilder(WkbBuilder &&other) = delete;
+  WkbBuilder &operator=(WkbBuilder &&other) = delete;
+
+  WkbBuilder(Format theFormat = Format::WKB, int thePrecision = 6);
+
+  // The serialized geometry, can be called only once
+  std::string result();
+
+  template <typename Traits, typename Edges>
+  void build(const Edges &theEdges, bool fillmode, Stats *theStats = nullptr);
+
+ private:
+  enum GeometryType
+  {
+    LineStringType = 2,
+    PolygonType = 3,
+    MultiLineStringType = 5,
+    MultiPolygonType = 6,
+    GeometryCollectionType = 7
+  };
+
+  void begin_geometry(GeometryType theType, bool theEmptyFlag = false);
+  void begin_part(GeometryType theType);
+  void put_count(std::size_t theCount);
+  void put_point(double theX, double theY);
+
+  void put_byte(std::uint8_t theValue);
+  void put_uint32(std::uint32_t theValue);
+  void put_double(double theValue);
+  void put_varint(std::uint64_t theValue);
+
+  template <typename Traits>
+  void put_ring(const Ring<Traits> &theRing);
+
+  // The final result
+  std::string itsResult;
+
+  const Format itsFormat;
+  const int itsPrecision;
+  const double itsScale;
+
+  // TWKB coordinates are deltas from the previous point
+  std::int64_t itsLastX = 0;
+  std::int64_t itsLastY = 0;
+
+};  // class WkbBuilder
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Write a ring or polyline
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits>
+inline void WkbBuilder::put_ring(const Ring<Traits> &theRing)
+{
+  put_count(theRing.size());
+  for (const auto &point : theRing)
+    put_point(point.first, point.second);
+}
+
+// ----------------------------------------------------------------------
+/*
+ * \brief Build polygons or polylines from the given edges
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits, typename Edges>
+inline void WkbBuilder::build(const Edges &edges, bool fillmode, Stats *stats)
+{
+  RingAssembly<Traits> assembly;
+  const auto &polylines = assembly.polylines;
+
+  StageTimer buildtimer(stats, Stats::BuildRings);
+  build_rings(edges, assembly);
+  buildtimer.stop();
+
+  if (stats)
+    stats->rings += polylines.size();
+
+  itsResult.clear();
+  itsLastX = 0;
+  itsLastY = 0;
+
+  // Each edge adds roughly one point to the output
+  const std::size_t pointsize = (itsFormat == Format::WKB ? 16 : 4);
+  itsResult.reserve(64 + pointsize * (edges.size() + polylines.size()));
+
+  if (polylines.empty())
+  {
+    begin_geometry(GeometryCollectionType, true);
+    if (itsFormat == Format::WKB)
+      put_count(0);
+    return;
+  }
+
+  if (!fillmode)
+  {
+    StageTimer outputtimer(stats, Stats::GeosConversion);
+
+    if (polylines.size() == 1)
+    {
+      begin_geometry(LineStringType);
+      put_ring(polylines.front());
+    }
+    else
+    {
+      begin_geometry(MultiLineStringType);
+      put_count(polylines.size());
+      for (const auto &polyline : polylines)
+      {
+        begin_part(LineStringType);
+        put_ring(polyline);
+      }
+    }
+    return;
+  }
+
+  StageTimer findtimer(stats, Stats::FindShell);
+  const HoleShells holeshells = assign_holes(edges, assembly);
+  findtimer.stop();
+
+  StageTimer outputtimer(stats, Stats::GeosConversion);
+
+  const PolygonList parts = collect_polygons(polylines, holeshells);
+
+  if (stats)
+  {
+    stats->shells += parts.size();
+    stats->holes += holeshells.size();
+  }
+
+  if (parts.empty())
+  {
+    begin_geometry(GeometryCollectionType, true);
+    if (itsFormat == Format::WKB)
+      put_count(0);
+    return;
+  }
+
+  if (parts.size() == 1)
+    begin_geometry(PolygonType);
+  else
+  {
+    begin_geometry(MultiPolygonType);
+    put_count(parts.size());
+  }
+
+  for (const auto &part : parts)
+  {
+    if (parts.size() > 1)
+      begin_part(PolygonType);
+    put_count(1 + part.holes.size());
+    put_ring(polylines[part.shell]);
+    for (auto hole : part.holes)
+      put_ring(polylines[hole]);
+  }
+}
+
+namespace Builder
+{
+// ----------------------------------------------------------------------
+/*
+ * \brief WKB builder for polygons
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits, typename Edges>
+void fill(const Edges &theEdges, WkbBuilder &theAdapter, Stats *theStats = nullptr)
+{
+  theAdapter.build<Traits>(theEdges, true, theStats);
+}
+
+// ----------------------------------------------------------------------
+/*
+ * \brief WKB builder for lines
+ */
+// ----------------------------------------------------------------------
+
+template <typename Traits, typename Edges>
+void line(const Edges &theEdges, WkbBuilder &theAdapter, Stats *theStats = nullptr)
+{
+  theAdapter.build<Traits>(theEdges, false, theStats);
+}
+}  // namespace Builder
+
+}  // namespace Tron
+
+// ======================================================================